@@ -0,0 +1,245 @@
+#include <pch.h>
+#include "LZ4Block.h"
+#include <cstring>
+#include <vector>
+
+using namespace asset_assembler;
+
+namespace
+{
+    static constexpr size_t s_MinMatch = 4;
+    static constexpr size_t s_LastLiterals = 5;     // The block always ends with at least this many literals
+    static constexpr size_t s_MatchFindLimit = 12;  // No match starts in the last bytes of the block
+    static constexpr size_t s_MaxOffset = 65535;
+    static constexpr uint32_t s_HashBits = 14;
+    static constexpr uint32_t s_SkipTrigger = 6;    // Probing speeds up after 2^6 failed searches
+
+    inline uint32_t Read32(const uint8_t *pData)
+    {
+        uint32_t value;
+        memcpy(&value, pData, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t HashSequence(uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - s_HashBits);
+    }
+
+    // Writes a length that didn't fit in its token nibble
+    inline bool WriteLengthExtension(size_t length, uint8_t *&io_pDst, const uint8_t *pDstEnd)
+    {
+        for (; length >= 255; length -= 255)
+        {
+            if (io_pDst >= pDstEnd)
+            {
+                return false;
+            }
+
+            *io_pDst++ = 255;
+        }
+
+        if (io_pDst >= pDstEnd)
+        {
+            return false;
+        }
+
+        *io_pDst++ = static_cast<uint8_t>(length);
+        return true;
+    }
+
+    bool WriteSequence(
+        const uint8_t *pLiterals, size_t literalCount, size_t offset, size_t matchLength,
+        uint8_t *&io_pDst, const uint8_t *pDstEnd)
+    {
+        if (io_pDst >= pDstEnd)
+        {
+            return false;
+        }
+
+        uint8_t *pToken = io_pDst++;
+        *pToken = static_cast<uint8_t>((literalCount >= 15 ? 15 : literalCount) << 4);
+
+        if (literalCount >= 15 && !WriteLengthExtension(literalCount - 15, io_pDst, pDstEnd))
+        {
+            return false;
+        }
+
+        if (static_cast<size_t>(pDstEnd - io_pDst) < literalCount)
+        {
+            return false;
+        }
+
+        memcpy(io_pDst, pLiterals, literalCount);
+        io_pDst += literalCount;
+
+        // The last sequence only holds literals
+        if (matchLength == 0)
+        {
+            return true;
+        }
+
+        if (pDstEnd - io_pDst < 2)
+        {
+            return false;
+        }
+
+        *io_pDst++ = static_cast<uint8_t>(offset);
+        *io_pDst++ = static_cast<uint8_t>(offset >> 8);
+
+        size_t matchCode = matchLength - s_MinMatch;
+        *pToken |= static_cast<uint8_t>(matchCode >= 15 ? 15 : matchCode);
+
+        return matchCode < 15 || WriteLengthExtension(matchCode - 15, io_pDst, pDstEnd);
+    }
+
+    inline bool ReadLengthExtension(size_t &io_Length, const uint8_t *&io_pSrc, const uint8_t *pSrcEnd)
+    {
+        uint8_t byte;
+
+        do
+        {
+            if (io_pSrc >= pSrcEnd)
+            {
+                return false;
+            }
+
+            byte = *io_pSrc++;
+            io_Length += byte;
+        }
+        while (byte == 255);
+
+        return true;
+    }
+}
+
+size_t compression::LZ4CompressBlock(const uint8_t *pSrc, size_t srcByteSize, uint8_t *pDst, size_t dstCapacity)
+{
+    uint8_t *pOut = pDst;
+    const uint8_t *pDstEnd = pDst + dstCapacity;
+    size_t anchor = 0;
+
+    if (srcByteSize > s_MatchFindLimit)
+    {
+        std::vector<uint32_t> table(size_t(1) << s_HashBits, 0);
+
+        size_t matchFindEnd = srcByteSize - s_MatchFindLimit;
+        size_t matchEnd = srcByteSize - s_LastLiterals;
+        size_t position = 0;
+        uint32_t searchCount = 1u << s_SkipTrigger;
+
+        while (position <= matchFindEnd)
+        {
+            uint32_t sequence = Read32(pSrc + position);
+            uint32_t hash = HashSequence(sequence);
+            size_t candidate = table[hash];
+            table[hash] = static_cast<uint32_t>(position);
+
+            if (candidate >= position || position - candidate > s_MaxOffset || Read32(pSrc + candidate) != sequence)
+            {
+                // Incompressible data is skipped faster and faster
+                position += searchCount++ >> s_SkipTrigger;
+                continue;
+            }
+
+            searchCount = 1u << s_SkipTrigger;
+
+            while (position > anchor && candidate > 0 && pSrc[position - 1] == pSrc[candidate - 1])
+            {
+                --position;
+                --candidate;
+            }
+
+            size_t matchLength = s_MinMatch;
+            while (position + matchLength < matchEnd && pSrc[candidate + matchLength] == pSrc[position + matchLength])
+            {
+                ++matchLength;
+            }
+
+            if (!WriteSequence(pSrc + anchor, position - anchor, position - candidate, matchLength, pOut, pDstEnd))
+            {
+                return 0;
+            }
+
+            position += matchLength;
+            anchor = position;
+
+            // The bytes right before the next search are the likeliest to repeat
+            if (position - 2 <= matchFindEnd)
+            {
+                table[HashSequence(Read32(pSrc + position - 2))] = static_cast<uint32_t>(position - 2);
+            }
+        }
+    }
+
+    if (!WriteSequence(pSrc + anchor, srcByteSize - anchor, 0, 0, pOut, pDstEnd))
+    {
+        return 0;
+    }
+
+    return static_cast<size_t>(pOut - pDst);
+}
+
+bool compression::LZ4DecompressBlock(const uint8_t *pSrc, size_t srcByteSize, uint8_t *pDst, size_t dstByteSize)
+{
+    const uint8_t *pSrcEnd = pSrc + srcByteSize;
+    uint8_t *pOut = pDst;
+    uint8_t *pDstEnd = pDst + dstByteSize;
+
+    while (pSrc < pSrcEnd)
+    {
+        uint8_t token = *pSrc++;
+
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !ReadLengthExtension(literalCount, pSrc, pSrcEnd))
+        {
+            return false;
+        }
+
+        if (static_cast<size_t>(pSrcEnd - pSrc) < literalCount || static_cast<size_t>(pDstEnd - pOut) < literalCount)
+        {
+            return false;
+        }
+
+        memcpy(pOut, pSrc, literalCount);
+        pOut += literalCount;
+        pSrc += literalCount;
+
+        if (pSrc == pSrcEnd)
+        {
+            break;
+        }
+
+        if (pSrcEnd - pSrc < 2)
+        {
+            return false;
+        }
+
+        size_t offset = pSrc[0] | (static_cast<size_t>(pSrc[1]) << 8);
+        pSrc += 2;
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !ReadLengthExtension(matchLength, pSrc, pSrcEnd))
+        {
+            return false;
+        }
+
+        matchLength += s_MinMatch;
+
+        if (offset == 0 || offset > static_cast<size_t>(pOut - pDst) || static_cast<size_t>(pDstEnd - pOut) < matchLength)
+        {
+            return false;
+        }
+
+        // Matches can overlap the bytes they produce, copied forward byte by byte
+        const uint8_t *pMatch = pOut - offset;
+        for (size_t i = 0; i < matchLength; ++i)
+        {
+            pOut[i] = pMatch[i];
+        }
+
+        pOut += matchLength;
+    }
+
+    return pOut == pDstEnd;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace asset_assembler
+{
+    namespace compression
+    {
+        // Largest compressed size of srcByteSize bytes, reached when nothing matches
+        inline size_t LZ4CompressBound(size_t srcByteSize)
+        {
+            return srcByteSize + srcByteSize / 255 + 16;
+        }
+
+        // Compresses a block in the LZ4 block format (no frame header), readable by any LZ4 decoder such as
+        // LZ4_decompress_safe. Greedy single-probe hash matching, in the spirit of LZ4's fast mode.
+        // Returns the compressed size, or 0 when it doesn't fit in dstCapacity.
+        size_t LZ4CompressBlock(const uint8_t *pSrc, size_t srcByteSize, uint8_t *pDst, size_t dstCapacity);
+
+        // Decodes a block produced by LZ4CompressBlock, or any LZ4 block, into exactly dstByteSize bytes.
+        // Malformed input is rejected without reading or writing out of bounds.
+        bool LZ4DecompressBlock(const uint8_t *pSrc, size_t srcByteSize, uint8_t *pDst, size_t dstByteSize);
+    }
+}
@@ -7,12 +7,36 @@
 #include "Salvation_Common/sqlite/sqlite3.h"
 #include "rapidjson/document.h"
 #include "3rd/Compressonator/Compressonator/CMP_Framework/CMP_Framework.h"
-
+#include "threading/OrderedParallelFor.h"
+#include "io/MappedFile.h"
+#include "io/FileCopy.h"
+#include "io/FileStamp.h"
+#include "io/GltfJsonStream.h"
+#include "io/JsonArena.h"
+#include "io/PackedFileWriter.h"
+#include "gltf/GltfScene.h"
+#include "gltf/GlbContainer.h"
+#include "profiling/Profiler.h"
+#include "hashing/Hash.h"
+#include "textures/TextureCache.h"
+#include "textures/TextureFormatSelection.h"
+#include "meshes/MeshPrimitives.h"
+#include "meshes/MeshSimplifier.h"
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace asset_assembler;
 using namespace asset_assembler::database;
 using namespace salvation;
 using namespace salvation::asset;
+using namespace rapidjson;
 using namespace salvation::memory;
 
+namespace fs = std::filesystem;
+
 
 AssetDatabaseBuilder::StatementRAII::~StatementRAII() 
 { 
@@ -26,38 +50,124 @@ void AssetDatabaseBuilder::ReleaseResources()
 
     if (m_pDb)
     {
+        RollbackTransaction();
         sqlite3_close(m_pDb);
+        m_pDb = nullptr;
+    }
+}
+
+bool AssetDatabaseBuilder::ExecuteSql(const char *pSql)
+{
+    return sqlite3_exec(m_pDb, pSql, nullptr, nullptr, nullptr) == SQLITE_OK;
+}
+
+bool AssetDatabaseBuilder::BeginTransaction()
+{
+    m_PendingRowCount = 0;
+    m_TransactionOpen = ExecuteSql("BEGIN TRANSACTION;");
+
+    return m_TransactionOpen;
+}
+
+bool AssetDatabaseBuilder::CommitTransaction()
+{
+    if (!m_TransactionOpen)
+    {
+        return false;
+    }
+
+    m_TransactionOpen = !ExecuteSql("COMMIT TRANSACTION;");
+
+    return !m_TransactionOpen;
+}
+
+void AssetDatabaseBuilder::RollbackTransaction()
+{
+    if (m_TransactionOpen)
+    {
+        ExecuteSql("ROLLBACK TRANSACTION;");
+        m_TransactionOpen = false;
+    }
+}
+
+bool AssetDatabaseBuilder::StepStatement(sqlite3_stmt *pStmt)
+{
+    if (sqlite3_step(pStmt) != SQLITE_DONE)
+    {
+        return false;
+    }
+
+    // Statements are reset before every use, resetting here as well only releases them before a batch commit
+    sqlite3_reset(pStmt);
+    ++m_InsertedRowCount;
+
+    uint32_t batchSize = m_Settings.m_TransactionBatchSize;
+    if (batchSize > 0 && ++m_PendingRowCount >= batchSize)
+    {
+        return CommitTransaction() && BeginTransaction();
     }
+
+    return true;
 }
 
 bool AssetDatabaseBuilder::CreateInsertStatements()
 {
     static constexpr char s_PackedDataStr[] = "INSERT INTO PackedData(FilePath, DataType) VALUES (?1, ?2);";
     static constexpr char s_TextureStr[] = "INSERT INTO Texture(ByteSize, ByteOffset, Format, PackedDataID) VALUES(?1, ?2, ?3, ?4);";
+    static constexpr char s_TextureMipStr[] = "INSERT INTO TextureMip(TextureID, Level, Width, Height, ByteOffset, ByteSize) VALUES(?1, ?2, ?3, ?4, ?5, ?6);";
+    static constexpr char s_TextureMipCopyStr[] =
+        "INSERT INTO TextureMip(TextureID, Level, Width, Height, ByteOffset, ByteSize) "
+        "SELECT ?1, Level, Width, Height, ByteOffset, ByteSize FROM TextureMip WHERE TextureID = ?2;";
     static constexpr char s_BufferStr[] = "INSERT INTO Buffer(ByteSize, ByteOffset, PackedDataID) VALUES(?1, ?2, ?3);";
     static constexpr char s_MaterialStr[] = "INSERT INTO Material(DiffuseTextureID) VALUES(?1);";
     static constexpr char s_BufferViewStr[] = "INSERT INTO BufferView(BufferID, ByteSize, ByteOffset, Stride) VALUES(?1, ?2, ?3, ?4);";
+    static constexpr char s_BufferViewEncodingStr[] =
+        "INSERT INTO BufferViewEncoding(BufferViewID, Encoding, ComponentType, ComponentCount, ScaleX, ScaleY, ScaleZ, OffsetX, OffsetY, OffsetZ) "
+        "VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10);";
     static constexpr char s_MeshStr[] = "INSERT INTO Mesh(Name) VALUES(?1);";
     static constexpr char s_SubMeshStr[] = "INSERT INTO SubMesh(MeshID, IndexBufferID, MaterialID) VALUES(?1, ?2, ?3);";
     static constexpr char s_VertexStreamStr[] = "INSERT INTO SubMeshVertexStreams(SubMeshID, BufferViewID, Attribute) VALUES(?1, ?2, ?3);";
+    static constexpr char s_MeshletStr[] =
+        "INSERT INTO Meshlet(SubMeshID, BufferID, MeshletCount, MeshletByteOffset, VertexIndexByteOffset, VertexIndexCount, TriangleByteOffset, TriangleByteSize) "
+        "VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8);";
+    static constexpr char s_SubMeshLODStr[] =
+        "INSERT INTO SubMeshLOD(SubMeshID, Level, BufferID, ByteOffset, IndexCount, IndexByteSize, Error) VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7);";
+    static constexpr char s_PackedDataChunkStr[] =
+        "INSERT INTO PackedDataChunk(PackedDataID, ChunkIndex, ByteOffset, ByteSize, FileByteOffset, FileByteSize, Codec) VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7);";
+    static constexpr char s_SourceFileStr[] = "INSERT OR REPLACE INTO SourceFile(Kind, ResourceIndex, Path, ByteSize, ModifiedTime, Hash, ResourceID) VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7);";
 
     return
         sqlite3_prepare_v2(m_pDb, s_PackedDataStr, -1, &m_InsertStmts.m_pPackedDataStmt, nullptr) == SQLITE_OK &&
         sqlite3_prepare_v2(m_pDb, s_TextureStr, -1, &m_InsertStmts.m_pTextureStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_pDb, s_TextureMipStr, -1, &m_InsertStmts.m_pTextureMipStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_pDb, s_TextureMipCopyStr, -1, &m_InsertStmts.m_pTextureMipCopyStmt, nullptr) == SQLITE_OK &&
         sqlite3_prepare_v2(m_pDb, s_BufferStr, -1, &m_InsertStmts.m_pBufferStmt, nullptr) == SQLITE_OK &&
         sqlite3_prepare_v2(m_pDb, s_MaterialStr, -1, &m_InsertStmts.m_pMaterialStmt, nullptr) == SQLITE_OK &&
         sqlite3_prepare_v2(m_pDb, s_BufferViewStr, -1, &m_InsertStmts.m_pBufferViewStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_pDb, s_BufferViewEncodingStr, -1, &m_InsertStmts.m_pBufferViewEncodingStmt, nullptr) == SQLITE_OK &&
         sqlite3_prepare_v2(m_pDb, s_MeshStr, -1, &m_InsertStmts.m_pMeshStmt, nullptr) == SQLITE_OK &&
         sqlite3_prepare_v2(m_pDb, s_SubMeshStr, -1, &m_InsertStmts.m_pSubMeshStmt, nullptr) == SQLITE_OK && 
-        sqlite3_prepare_v2(m_pDb, s_VertexStreamStr, -1, &m_InsertStmts.m_pVertexStreamStmt, nullptr) == SQLITE_OK;
+        sqlite3_prepare_v2(m_pDb, s_VertexStreamStr, -1, &m_InsertStmts.m_pVertexStreamStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_pDb, s_MeshletStr, -1, &m_InsertStmts.m_pMeshletStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_pDb, s_SubMeshLODStr, -1, &m_InsertStmts.m_pSubMeshLODStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_pDb, s_PackedDataChunkStr, -1, &m_InsertStmts.m_pPackedDataChunkStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_pDb, s_SourceFileStr, -1, &m_InsertStmts.m_pSourceFileStmt, nullptr) == SQLITE_OK;
 }
 
 bool AssetDatabaseBuilder::CreateUpdateStatements()
 {
     static constexpr char s_PackedDataStr[] = "UPDATE PackedData SET ByteSize = ?2 WHERE ID = ?1;";
+    static constexpr char s_TextureStr[] = "UPDATE Texture SET ByteSize = ?2, ByteOffset = ?3, Format = ?4 WHERE ID = ?1;";
+    static constexpr char s_BufferStr[] = "UPDATE Buffer SET ByteSize = ?2, ByteOffset = ?3 WHERE ID = ?1;";
+    static constexpr char s_TextureMipDeleteStr[] = "DELETE FROM TextureMip WHERE TextureID = ?1;";
+    static constexpr char s_PackedDataChunkDeleteStr[] = "DELETE FROM PackedDataChunk WHERE PackedDataID = ?1;";
 
     return
-        sqlite3_prepare_v2(m_pDb, s_PackedDataStr, -1, &m_UpdateStmts.m_pPackedDataStmt, nullptr) == SQLITE_OK;
+        sqlite3_prepare_v2(m_pDb, s_PackedDataStr, -1, &m_UpdateStmts.m_pPackedDataStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_pDb, s_TextureStr, -1, &m_UpdateStmts.m_pTextureStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_pDb, s_BufferStr, -1, &m_UpdateStmts.m_pBufferStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_pDb, s_TextureMipDeleteStr, -1, &m_UpdateStmts.m_pTextureMipDeleteStmt, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_pDb, s_PackedDataChunkDeleteStr, -1, &m_UpdateStmts.m_pPackedDataChunkDeleteStmt, nullptr) == SQLITE_OK;
 }
 
 
@@ -65,17 +175,32 @@ void AssetDatabaseBuilder::ReleaseInsertStatements()
 {
     if (m_InsertStmts.m_pPackedDataStmt) sqlite3_finalize(m_InsertStmts.m_pPackedDataStmt);
     if (m_InsertStmts.m_pTextureStmt) sqlite3_finalize(m_InsertStmts.m_pTextureStmt);
+    if (m_InsertStmts.m_pTextureMipStmt) sqlite3_finalize(m_InsertStmts.m_pTextureMipStmt);
+    if (m_InsertStmts.m_pTextureMipCopyStmt) sqlite3_finalize(m_InsertStmts.m_pTextureMipCopyStmt);
     if (m_InsertStmts.m_pBufferStmt) sqlite3_finalize(m_InsertStmts.m_pBufferStmt);
     if (m_InsertStmts.m_pMaterialStmt) sqlite3_finalize(m_InsertStmts.m_pMaterialStmt);
     if (m_InsertStmts.m_pBufferViewStmt) sqlite3_finalize(m_InsertStmts.m_pBufferViewStmt);
+    if (m_InsertStmts.m_pBufferViewEncodingStmt) sqlite3_finalize(m_InsertStmts.m_pBufferViewEncodingStmt);
     if (m_InsertStmts.m_pMeshStmt) sqlite3_finalize(m_InsertStmts.m_pMeshStmt);
     if (m_InsertStmts.m_pSubMeshStmt) sqlite3_finalize(m_InsertStmts.m_pSubMeshStmt);
     if (m_InsertStmts.m_pVertexStreamStmt) sqlite3_finalize(m_InsertStmts.m_pVertexStreamStmt);
+    if (m_InsertStmts.m_pMeshletStmt) sqlite3_finalize(m_InsertStmts.m_pMeshletStmt);
+    if (m_InsertStmts.m_pSubMeshLODStmt) sqlite3_finalize(m_InsertStmts.m_pSubMeshLODStmt);
+    if (m_InsertStmts.m_pPackedDataChunkStmt) sqlite3_finalize(m_InsertStmts.m_pPackedDataChunkStmt);
+    if (m_InsertStmts.m_pSourceFileStmt) sqlite3_finalize(m_InsertStmts.m_pSourceFileStmt);
+
+    m_InsertStmts = {};
 }
 
 void AssetDatabaseBuilder::ReleaseUpdateStatements()
 {
     if (m_UpdateStmts.m_pPackedDataStmt) sqlite3_finalize(m_UpdateStmts.m_pPackedDataStmt);
+    if (m_UpdateStmts.m_pTextureStmt) sqlite3_finalize(m_UpdateStmts.m_pTextureStmt);
+    if (m_UpdateStmts.m_pBufferStmt) sqlite3_finalize(m_UpdateStmts.m_pBufferStmt);
+    if (m_UpdateStmts.m_pTextureMipDeleteStmt) sqlite3_finalize(m_UpdateStmts.m_pTextureMipDeleteStmt);
+    if (m_UpdateStmts.m_pPackedDataChunkDeleteStmt) sqlite3_finalize(m_UpdateStmts.m_pPackedDataChunkDeleteStmt);
+
+    m_UpdateStmts = {};
 }
 
 bool AssetDatabaseBuilder::CreateTables()
@@ -96,6 +221,23 @@ bool AssetDatabaseBuilder::CreateTables()
         ByteSize INTEGER
     );)";
 
+    // Chunks of a compressed packed file, in file order. ByteOffset and ByteSize are in the uncompressed content that
+    // Texture and Buffer offsets refer to, so the chunks overlapping [ByteOffset, ByteOffset + ByteSize) of a resource
+    // are the only ones to read. Codec 0 chunks are stored as is, codec 1 chunks are raw LZ4 blocks.
+    static constexpr char pCreatePackedDataChunkTable[] = R"(
+    CREATE TABLE IF NOT EXISTS PackedDataChunk
+    (
+        PackedDataID INTEGER NOT NULL,
+        ChunkIndex INTEGER NOT NULL,
+        ByteOffset INTEGER NOT NULL,
+        ByteSize INTEGER NOT NULL,
+        FileByteOffset INTEGER NOT NULL,
+        FileByteSize INTEGER NOT NULL,
+        Codec INTEGER NOT NULL,
+        PRIMARY KEY(PackedDataID, ChunkIndex),
+        FOREIGN KEY(PackedDataID) REFERENCES PackedData(ID)
+    );)";
+
     static constexpr char pCreateTextureTable[] = R"(
     CREATE TABLE IF NOT EXISTS Texture
     (
@@ -107,6 +249,19 @@ bool AssetDatabaseBuilder::CreateTables()
         FOREIGN KEY(PackedDataID) REFERENCES PackedData(ID)
     );)";
 
+    static constexpr char pCreateTextureMipTable[] = R"(
+    CREATE TABLE IF NOT EXISTS TextureMip
+    (
+        TextureID INTEGER NOT NULL,
+        Level INTEGER NOT NULL,
+        Width INTEGER NOT NULL,
+        Height INTEGER NOT NULL,
+        ByteOffset INTEGER NOT NULL,
+        ByteSize INTEGER NOT NULL,
+        PRIMARY KEY(TextureID, Level),
+        FOREIGN KEY(TextureID) REFERENCES Texture(ID)
+    );)";
+
     static constexpr char pCreateBufferTable[] = R"(
     CREATE TABLE IF NOT EXISTS Buffer
     (
@@ -128,6 +283,22 @@ bool AssetDatabaseBuilder::CreateTables()
         FOREIGN KEY(BufferID) REFERENCES Buffer(ID)
     );)";
 
+    static constexpr char pCreateBufferViewEncodingTable[] = R"(
+    CREATE TABLE IF NOT EXISTS BufferViewEncoding
+    (
+        BufferViewID INTEGER PRIMARY KEY,
+        Encoding INTEGER NOT NULL,
+        ComponentType INTEGER NOT NULL,
+        ComponentCount INTEGER NOT NULL,
+        ScaleX REAL NOT NULL,
+        ScaleY REAL NOT NULL,
+        ScaleZ REAL NOT NULL,
+        OffsetX REAL NOT NULL,
+        OffsetY REAL NOT NULL,
+        OffsetZ REAL NOT NULL,
+        FOREIGN KEY(BufferViewID) REFERENCES BufferView(ID)
+    );)";
+
     static constexpr char pCreateMaterialTable[] = R"(
     CREATE TABLE IF NOT EXISTS Material
     (
@@ -159,16 +330,71 @@ bool AssetDatabaseBuilder::CreateTables()
         FOREIGN KEY(BufferViewID) REFERENCES BufferView(ID)
     );)";
 
+    // One row per submesh split into meshlets, the meshlet descriptors with their bounds,
+    // vertex indices and triangles are packed after the content of the buffer
+    static constexpr char pCreateMeshletTable[] = R"(
+    CREATE TABLE IF NOT EXISTS Meshlet
+    (
+        SubMeshID INTEGER PRIMARY KEY,
+        BufferID INTEGER NOT NULL,
+        MeshletCount INTEGER NOT NULL,
+        MeshletByteOffset INTEGER NOT NULL,
+        VertexIndexByteOffset INTEGER NOT NULL,
+        VertexIndexCount INTEGER NOT NULL,
+        TriangleByteOffset INTEGER NOT NULL,
+        TriangleByteSize INTEGER NOT NULL,
+        FOREIGN KEY(SubMeshID) REFERENCES SubMesh(ID),
+        FOREIGN KEY(BufferID) REFERENCES Buffer(ID)
+    );)";
+
+    // Lower levels of detail of a submesh, level 0 being the submesh itself. Their indices reference the submesh's
+    // vertex streams and are packed after the content of the buffer. Error is the largest distance from a vertex the
+    // level removed to the level's surface, in mesh units: projected with the camera, error * viewportHeight / (2 * distance * tan(fovY / 2))
+    // gives the screen-space error in pixels, and the runtime picks the coarsest level that stays under its pixel threshold.
+    static constexpr char pCreateSubMeshLODTable[] = R"(
+    CREATE TABLE IF NOT EXISTS SubMeshLOD
+    (
+        SubMeshID INTEGER NOT NULL,
+        Level INTEGER NOT NULL,
+        BufferID INTEGER NOT NULL,
+        ByteOffset INTEGER NOT NULL,
+        IndexCount INTEGER NOT NULL,
+        IndexByteSize INTEGER NOT NULL,
+        Error REAL NOT NULL,
+        PRIMARY KEY(SubMeshID, Level),
+        FOREIGN KEY(SubMeshID) REFERENCES SubMesh(ID),
+        FOREIGN KEY(BufferID) REFERENCES Buffer(ID)
+    );)";
+
+    static constexpr char pCreateSourceFileTable[] = R"(
+    CREATE TABLE IF NOT EXISTS SourceFile
+    (
+        Kind INTEGER NOT NULL,
+        ResourceIndex INTEGER NOT NULL,
+        Path TEXT NOT NULL,
+        ByteSize INTEGER NOT NULL,
+        ModifiedTime INTEGER NOT NULL,
+        Hash INTEGER NOT NULL,
+        ResourceID INTEGER,
+        PRIMARY KEY(Kind, ResourceIndex)
+    );)";
+
     static constexpr const char* ppCreateTableStmt[] =
     {
         pCreateMeshTable,
         pCreatePackedDataTable,
+        pCreatePackedDataChunkTable,
         pCreateTextureTable,
+        pCreateTextureMipTable,
         pCreateBufferTable,
         pCreateBufferViewTable,
+        pCreateBufferViewEncodingTable,
         pCreateMaterialTable,
         pCreateSubMeshTable,
-        pCreateSubMeshVertexStreamsTable
+        pCreateSubMeshVertexStreamsTable,
+        pCreateMeshletTable,
+        pCreateSubMeshLODTable,
+        pCreateSourceFileTable
     };
 
     int result = SQLITE_OK;
@@ -203,566 +429,2128 @@ bool AssetDatabaseBuilder::CreateDatabase(const char *pDstPath)
     int dbResult = sqlite3_open(pDstPath, &m_pDb);
     if (dbResult == SQLITE_OK)
     {
-        return CreateTables();
+        return BeginTransaction() && CreateTables();
     }
 
     return false;
 }
 
-uint8_t* AssetDatabaseBuilder::ReadFileContent(const char *pSrcPath, size_t &o_FileSize)
+// Everything besides the glTF content that changes what is written to Buffers.bin, part of the scene hash
+struct MeshBuildSettings
 {
-    uint8_t *pContent = nullptr;
-    FILE *pFile;
-    errno_t err = fopen_s(&pFile, pSrcPath, "r");
-    o_FileSize = 0;
+    uint32_t    m_OptimizeMeshes;
+    uint32_t    m_VertexCacheSize;
+    float       m_OverdrawThreshold;
+    uint32_t    m_QuantizeVertices;
+    uint32_t    m_OctahedralBits;
+    uint32_t    m_NarrowIndices;
+    uint32_t    m_StripUnreferencedBufferData;
+    uint32_t    m_VertexLayout;
+    uint32_t    m_BuildMeshlets;
+    uint32_t    m_MeshletMaxVertexCount;
+    uint32_t    m_MeshletMaxTriangleCount;
+    uint32_t    m_LodLevelCount;
+    float       m_LodTriangleRatios[s_MaxLodLevelCount];
+    float       m_LodMaxErrors[s_MaxLodLevelCount];
+};
+
+static uint64_t HashMeshBuildSettings(const BuildSettings &settings)
+{
+    MeshBuildSettings meshSettings =
+    {
+        settings.m_OptimizeMeshes ? 1u : 0u,
+        settings.m_VertexCacheSize,
+        settings.m_OverdrawThreshold,
+        settings.m_QuantizeVertices ? 1u : 0u,
+        settings.m_OctahedralBits,
+        settings.m_NarrowIndices ? 1u : 0u,
+        settings.m_StripUnreferencedBufferData ? 1u : 0u,
+        static_cast<uint32_t>(settings.m_VertexLayout),
+        settings.m_BuildMeshlets ? 1u : 0u,
+        settings.m_MeshletMaxVertexCount,
+        settings.m_MeshletMaxTriangleCount,
+        std::min(settings.m_LodLevelCount, s_MaxLodLevelCount)
+    };
 
-    if (err == 0 && pFile)
+    for (uint32_t i = 0; i < meshSettings.m_LodLevelCount; ++i)
     {
-        fseek(pFile, 0, SEEK_END);
-        size_t fileSize = ftell(pFile);
-        fseek(pFile, 0, SEEK_SET);
+        meshSettings.m_LodTriangleRatios[i] = settings.m_LodLevels[i].m_TriangleRatio;
+        meshSettings.m_LodMaxErrors[i] = settings.m_LodLevels[i].m_MaxError;
+    }
 
-        pContent = static_cast<uint8_t*>(ThreadHeapAllocator::Allocate(fileSize));
+    return hashing::Hash64(&meshSettings, sizeof(meshSettings));
+}
 
-        fread(pContent, sizeof(uint8_t), fileSize, pFile);
-        fclose(pFile);
+bool AssetDatabaseBuilder::ClearTables(const char *const *ppTables, size_t tableCount)
+{
+    char sql[128];
 
-        o_FileSize = fileSize;
+    for (size_t i = 0; i < tableCount; ++i)
+    {
+        snprintf(sql, sizeof(sql), "DELETE FROM %s;", ppTables[i]);
+        if (!ExecuteSql(sql))
+        {
+            return false;
+        }
     }
 
-    return pContent;
+    return true;
 }
 
-/// CMP_Feedback_Proc
-/// Feedback function for conversion.
-/// \param[in] fProgress The percentage progress of the texture compression.
-/// \return non-NULL(true) value to abort conversion
-static bool CMP_Feedback(CMP_FLOAT fProgress, CMP_DWORD_PTR pUser1, CMP_DWORD_PTR pUser2)
+bool AssetDatabaseBuilder::ClearMetadataTables()
 {
-    return false;
+    // Children first so foreign keys never point to deleted rows.
+    // Emptied tables restart their IDs at 1, which the glTF index to ID mapping relies on.
+    static constexpr const char* s_ppMetadataTables[] =
+    {
+        "SubMeshLOD",
+        "Meshlet",
+        "SubMeshVertexStreams",
+        "SubMesh",
+        "Mesh",
+        "BufferViewEncoding",
+        "BufferView",
+        "Material"
+    };
+
+    return ClearTables(s_ppMetadataTables, ARRAY_SIZE(s_ppMetadataTables));
 }
 
-int64_t AssetDatabaseBuilder::CompressTexture(const char *pSrcFilePath, FILE *pDestFile, int64_t packedDataId)
+bool AssetDatabaseBuilder::ClearBuildTables()
 {
-    int64_t byteSize = 0;
-
-    CMP_MipSet mipSetIn = {};
-    CMP_MipSet mipSetOut = {};
-
-    CMP_ERROR result = CMP_LoadTexture(pSrcFilePath, &mipSetIn);
-
-    if (result == CMP_OK)
+    static constexpr const char* s_ppResourceTables[] =
     {
-        // Generate MIP chain if not already generated
-        if (mipSetIn.m_nMipLevels <= 1)
-        {
-            static constexpr CMP_INT s_MinMipSize = 4; // 4x4
-            CMP_GenerateMIPLevels(&mipSetIn, s_MinMipSize);
-        }
+        "TextureMip",
+        "Texture",
+        "Buffer",
+        "PackedDataChunk",
+        "PackedData",
+        "SourceFile"
+    };
 
-        // Compress texture into BC3 for now #todo provide format as argument
-        {
-            KernelOptions kernelOptions = {};
-            kernelOptions.format = CMP_FORMAT_BC3;
-            kernelOptions.fquality = 1.0f;
-            kernelOptions.threads = 0; // Auto setting
-            
-            result = CMP_ProcessTexture(&mipSetIn, &mipSetOut, kernelOptions, &CMP_Feedback);
+    return
+        ClearMetadataTables() &&
+        ClearTables(s_ppResourceTables, ARRAY_SIZE(s_ppResourceTables));
+}
 
-            if (result == CMP_OK)
-            {
-                // #todo Properly save the whole mip chain
-                for (int i = 0; i < 1/*mipSetOut.m_nMipLevels*/; ++i)
-                {
-                    CMP_MipLevel *pMipData;
-                    CMP_GetMipLevel(&pMipData, &mipSetOut, i, 0);
-                    int64_t mipByteSize = pMipData->m_dwLinearSize;
+bool AssetDatabaseBuilder::QueryInt64(const char *pSql, int64_t bindValue, int64_t &o_Value)
+{
+    sqlite3_stmt *pStmt = nullptr;
 
-                    if (fwrite(pMipData->m_pbData, sizeof(uint8_t), mipByteSize, pDestFile) != mipByteSize)
-                    {
-                        byteSize = -1;
-                        break;
-                    }
+    int result = sqlite3_prepare_v2(m_pDb, pSql, -1, &pStmt, nullptr);
+    StatementRAII stmtRAII(pStmt);
 
-                    byteSize += mipByteSize;
-                }
-            }
-        }
+    if (result != SQLITE_OK || sqlite3_bind_int64(pStmt, 1, bindValue) != SQLITE_OK)
+    {
+        return false;
     }
 
-    CMP_FreeMipSet(&mipSetIn);
-    CMP_FreeMipSet(&mipSetOut);
+    // o_Value is left untouched when the query returns no row
+    result = sqlite3_step(pStmt);
+    if (result == SQLITE_ROW)
+    {
+        o_Value = sqlite3_column_int64(pStmt, 0);
+        return true;
+    }
 
-    return byteSize;
+    return result == SQLITE_DONE;
 }
 
-int64_t AssetDatabaseBuilder::InsertPackagedDataEntry(const char *pFilePath, salvation::asset::PackedDataType dataType)
+bool AssetDatabaseBuilder::LoadSourceRecords(SourceRecord &o_Scene, std::vector<SourceRecord> &o_Images, std::vector<SourceRecord> &o_Buffers)
 {
-    int64_t packageID = -1;
-    sqlite3_stmt *pStmt = m_InsertStmts.m_pPackedDataStmt;
+    static constexpr char s_SelectStr[] = "SELECT Kind, ResourceIndex, Path, ByteSize, ModifiedTime, Hash, ResourceID FROM SourceFile;";
 
-    if (
-        sqlite3_reset(pStmt) == SQLITE_OK && 
-        sqlite3_bind_text(pStmt, 1, pFilePath, -1, SQLITE_STATIC) == SQLITE_OK &&
-        sqlite3_bind_int(pStmt, 2, static_cast<int>(dataType)) == SQLITE_OK &&
-        sqlite3_step(pStmt) == SQLITE_DONE)
+    sqlite3_stmt *pStmt = nullptr;
+
+    int result = sqlite3_prepare_v2(m_pDb, s_SelectStr, -1, &pStmt, nullptr);
+    StatementRAII stmtRAII(pStmt);
+
+    if (result != SQLITE_OK)
     {
-        packageID = sqlite3_last_insert_rowid(m_pDb);
+        return false;
     }
 
-    return packageID;
-}
-
-bool AssetDatabaseBuilder::InsertTextureDataEntry(int64_t byteSize, int64_t byteOffset, int32_t format, int64_t packedDataId)
-{
-    sqlite3_stmt *pStmt = m_InsertStmts.m_pTextureStmt;
+    while ((result = sqlite3_step(pStmt)) == SQLITE_ROW)
+    {
+        SourceKind kind = static_cast<SourceKind>(sqlite3_column_int(pStmt, 0));
+        int64_t resourceIndex = sqlite3_column_int64(pStmt, 1);
 
-    return 
-        sqlite3_reset(pStmt) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 1, byteSize) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 2, byteOffset) == SQLITE_OK &&
-        sqlite3_bind_int(pStmt, 3, format) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 4, packedDataId) == SQLITE_OK &&
-        sqlite3_step(pStmt) == SQLITE_DONE;
+        std::vector<SourceRecord> *pSources =
+            kind == SourceKind::Image ? &o_Images :
+            kind == SourceKind::Buffer ? &o_Buffers :
+            nullptr;
 
-}
+        SourceRecord *pRecord = &o_Scene;
 
-bool AssetDatabaseBuilder::InsertBufferDataEntry(int64_t byteSize, int64_t byteOffset, int64_t packedDataId)
-{
-    sqlite3_stmt *pStmt = m_InsertStmts.m_pBufferStmt;
+        if (pSources)
+        {
+            if (resourceIndex < 0)
+            {
+                continue;
+            }
 
-    return
-        sqlite3_reset(pStmt) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 1, byteSize) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 2, byteOffset) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 3, packedDataId) == SQLITE_OK &&
-        sqlite3_step(pStmt) == SQLITE_DONE;
-}
+            if (static_cast<size_t>(resourceIndex) >= pSources->size())
+            {
+                pSources->resize(static_cast<size_t>(resourceIndex) + 1);
+            }
 
-bool AssetDatabaseBuilder::InsertMaterialDataEntry(int64_t textureId)
-{
-    sqlite3_stmt *pStmt = m_InsertStmts.m_pMaterialStmt;
+            pRecord = &(*pSources)[static_cast<size_t>(resourceIndex)];
+        }
 
-    return
-        sqlite3_reset(pStmt) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 1, textureId) == SQLITE_OK &&
-        sqlite3_step(pStmt) == SQLITE_DONE;
-}
+        const unsigned char *pPath = sqlite3_column_text(pStmt, 2);
 
-bool AssetDatabaseBuilder::InsertBufferViewDataEntry(int64_t bufferId, int64_t byteSize, int64_t byteOffset, int32_t stride)
-{
-    sqlite3_stmt *pStmt = m_InsertStmts.m_pBufferViewStmt;
+        pRecord->m_Path = pPath ? reinterpret_cast<const char*>(pPath) : "";
+        pRecord->m_Stamp.m_ByteSize = sqlite3_column_int64(pStmt, 3);
+        pRecord->m_Stamp.m_ModifiedTime = sqlite3_column_int64(pStmt, 4);
+        pRecord->m_Hash = static_cast<uint64_t>(sqlite3_column_int64(pStmt, 5));
+        pRecord->m_ResourceId = sqlite3_column_type(pStmt, 6) == SQLITE_NULL ? -1 : sqlite3_column_int64(pStmt, 6);
+        pRecord->m_Hashed = true;
+    }
 
-    return
-        sqlite3_reset(pStmt) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 1, bufferId) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 2, byteSize) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 3, byteOffset) == SQLITE_OK &&
-        sqlite3_bind_int(pStmt, 4, stride) == SQLITE_OK &&
-        sqlite3_step(pStmt) == SQLITE_DONE;
+    return result == SQLITE_DONE;
 }
 
-int64_t AssetDatabaseBuilder::InsertMeshDataEntry(const char *pName)
+static constexpr textures::BlockFormat s_BlockFormats[] =
 {
-    int64_t meshId = -1;
-    sqlite3_stmt *pStmt = m_InsertStmts.m_pMeshStmt;
-
-    if (
-        sqlite3_reset(pStmt) == SQLITE_OK &&
-        sqlite3_bind_text(pStmt, 1, pName, -1, SQLITE_STATIC) == SQLITE_OK &&
-        sqlite3_step(pStmt) == SQLITE_DONE)
+    textures::BlockFormat::BC1,
+    textures::BlockFormat::BC3,
+    textures::BlockFormat::BC4,
+    textures::BlockFormat::BC5,
+    textures::BlockFormat::BC7
+};
+
+static constexpr CMP_FORMAT s_CMPFormats[] = { CMP_FORMAT_BC1, CMP_FORMAT_BC3, CMP_FORMAT_BC4, CMP_FORMAT_BC5, CMP_FORMAT_BC7 };
+static constexpr TextureFormat s_TextureFormats[] = { TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC4, TextureFormat::BC5, TextureFormat::BC7 };
+
+// Index of a resolved format in the tables above
+static size_t BlockFormatIndex(textures::BlockFormat format)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(s_BlockFormats); ++i)
     {
-        meshId = sqlite3_last_insert_rowid(m_pDb);
+        if (s_BlockFormats[i] == format)
+        {
+            return i;
+        }
     }
 
-    return meshId;
+    return 1; // BC3
 }
 
-int64_t AssetDatabaseBuilder::InsertSubMeshDataEntry(int64_t meshId, int64_t indexBufferViewId, int64_t materialId)
+static textures::BlockFormat FromTextureFormat(int64_t format)
 {
-    int64_t subMeshId = -1;
-    sqlite3_stmt *pStmt = m_InsertStmts.m_pSubMeshStmt;
-
-    if (
-        sqlite3_reset(pStmt) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 1, meshId) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 2, indexBufferViewId) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 3, materialId) == SQLITE_OK &&
-        sqlite3_step(pStmt) == SQLITE_DONE)
+    for (size_t i = 0; i < ARRAY_SIZE(s_TextureFormats); ++i)
     {
-        subMeshId = sqlite3_last_insert_rowid(m_pDb);
+        if (static_cast<int64_t>(s_TextureFormats[i]) == format)
+        {
+            return s_BlockFormats[i];
+        }
     }
 
-    return subMeshId;
+    return textures::BlockFormat::Auto;
 }
 
-bool AssetDatabaseBuilder::InsertVertexStreamDataEntry(int64_t subMeshId, int64_t bufferViewId, int32_t attribute)
+// Alignments that are not a power of two pack resources back to back
+static uint32_t ResolvePackedDataAlignment(const BuildSettings &settings)
 {
-    sqlite3_stmt *pStmt = m_InsertStmts.m_pVertexStreamStmt;
-
-    return
-        sqlite3_reset(pStmt) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 1, subMeshId) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 2, bufferViewId) == SQLITE_OK &&
-        sqlite3_bind_int(pStmt, 3, attribute) == SQLITE_OK &&
-        sqlite3_step(pStmt) == SQLITE_DONE;
+    uint32_t alignment = settings.m_PackedDataAlignment;
+    return alignment > 1 && (alignment & (alignment - 1)) == 0 ? alignment : 1;
 }
 
-bool AssetDatabaseBuilder::UpdatePackagedDataEntry(int64_t packagedDataId, int64_t byteSize)
+bool AssetDatabaseBuilder::LoadPackedFileState(PackedDataType dataType, const char *pLiveByteSizeSql, const char *pMisalignedCountSql, const char *pFilePath, PackedFileState &o_State)
 {
-    sqlite3_stmt *pStmt = m_UpdateStmts.m_pPackedDataStmt;
+    static constexpr char s_PackedDataIdStr[] = "SELECT ID FROM PackedData WHERE DataType = ?1;";
+    static constexpr char s_PackedDataByteSizeStr[] = "SELECT ByteSize FROM PackedData WHERE ID = ?1;";
+    static constexpr char s_ChunkCountStr[] = "SELECT COUNT(*) FROM PackedDataChunk WHERE PackedDataID = ?1;";
+    static constexpr char s_ChunkFileByteSizeStr[] = "SELECT MAX(FileByteOffset + FileByteSize) FROM PackedDataChunk WHERE PackedDataID = ?1;";
 
-    return
-        sqlite3_reset(pStmt) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 1, packagedDataId) == SQLITE_OK &&
-        sqlite3_bind_int64(pStmt, 2, byteSize) == SQLITE_OK &&
-        sqlite3_step(pStmt) == SQLITE_DONE;
-}
+    o_State = {};
 
-bool AssetDatabaseBuilder::BuildTextures(Document &json, const char *pSrcRootPath, const char *pDestRootPath)
-{
-    static constexpr const char s_pTexturesBinFileName[] = "Textures.bin";
-    static constexpr const char s_pImgProperty[] = "images";
-    static constexpr const char s_pUriProperty[] = "uri";
+    int64_t packedDataId = -1;
+    if (!QueryInt64(s_PackedDataIdStr, static_cast<int64_t>(dataType), packedDataId))
+    {
+        return false;
+    }
 
-    if (json.HasMember(s_pImgProperty) && json[s_pImgProperty].IsArray())
+    if (packedDataId < 0)
     {
-        Value &images = json[s_pImgProperty];
-        SizeType imageCount = images.Size();
+        return true;
+    }
 
-        if (imageCount > 0)
-        {
-            str_smart_ptr pDestFilePath = salvation::filesystem::AppendPaths(pDestRootPath, s_pTexturesBinFileName);
-            FILE *pDestFile = nullptr;
+    int64_t byteSize = 0;
+    int64_t liveByteSize = 0;
+    int64_t misalignedCount = 0;
+    int64_t chunkCount = 0;
+    int64_t chunkFileByteSize = 0;
 
-            if (fopen_s(&pDestFile, pDestFilePath, "wb") != 0)
-            {
-                return false;
-            }
+    if (
+        !QueryInt64(s_PackedDataByteSizeStr, packedDataId, byteSize) ||
+        !QueryInt64(pLiveByteSizeSql, packedDataId, liveByteSize) ||
+        !QueryInt64(pMisalignedCountSql, packedDataId, misalignedCount) ||
+        !QueryInt64(s_ChunkCountStr, packedDataId, chunkCount) ||
+        !QueryInt64(s_ChunkFileByteSizeStr, packedDataId, chunkFileByteSize))
+    {
+        return false;
+    }
 
-            int64_t packedDataId = InsertPackagedDataEntry(s_pTexturesBinFileName, PackedDataType::Textures);
-            if (packedDataId < 0)
-            {
-                return false;
-            }
+    // Anything past the recorded size was left by a failed build, and replaced resources leave their previous
+    // content behind. The file is rewritten from scratch when it can't be trusted or is mostly dead bytes,
+    // and when it was packed with another alignment or compression setting.
+    bool compressed = chunkCount > 0;
+    int64_t fileByteSize = compressed ? chunkFileByteSize : byteSize;
+    io::FileStamp fileStamp {};
+
+    o_State.m_PackedDataId = packedDataId;
+    o_State.m_Rewrite =
+        !io::ReadFileStamp(pFilePath, fileStamp) ||
+        fileStamp.m_ByteSize != fileByteSize ||
+        byteSize - liveByteSize > liveByteSize ||
+        misalignedCount > 0 ||
+        byteSize % ResolvePackedDataAlignment(m_Settings) != 0 ||
+        (byteSize > 0 && compressed != (m_Settings.m_CompressionChunkByteSize > 0));
+    o_State.m_ByteSize = o_State.m_Rewrite ? 0 : byteSize;
+    o_State.m_FileByteSize = o_State.m_Rewrite ? 0 : fileByteSize;
+    o_State.m_ChunkCount = o_State.m_Rewrite ? 0 : chunkCount;
 
-            int64_t currentByteOffset = 0;
+    return true;
+}
 
-            for (SizeType i = 0; i < imageCount; ++i)
-            {
-                Value &img = images[i];
-                if (img.HasMember(s_pUriProperty) && img[s_pUriProperty].IsString())
-                {
-                    Value &uri = img[s_pUriProperty];
-                    const char *pTextureUri = uri.GetString();
+void AssetDatabaseBuilder::ResolveSourcePaths(const gltf::Scene &scene, SourceKind kind, const char *pSrcRootPath, std::vector<SourceRecord> &o_Sources)
+{
+    size_t resourceCount = kind == SourceKind::Image ? scene.m_Images.size() : scene.m_Buffers.size();
 
-                    str_smart_ptr pSrcFilePath = salvation::filesystem::AppendPaths(pSrcRootPath, pTextureUri);
-                    int64_t textureByteSize = CompressTexture(pSrcFilePath, pDestFile, packedDataId);
-                    if (textureByteSize <= 0)
-                    {
-                        return false;
-                    }
+    o_Sources.clear();
+    o_Sources.resize(resourceCount);
 
-                    if (!InsertTextureDataEntry(textureByteSize, currentByteOffset, static_cast<int32_t>(TextureFormat::BC3), packedDataId))
-                    {
-                        return false;
-                    }
+    for (size_t i = 0; i < resourceCount; ++i)
+    {
+        int32_t uri = kind == SourceKind::Image ? scene.m_Images[i].m_Uri : scene.m_Buffers[i].m_Uri;
 
-                    currentByteOffset += textureByteSize;
-                }
-            }
+        if (uri != gltf::s_InvalidIndex)
+        {
+            str_smart_ptr pSrcFilePath = salvation::filesystem::AppendPaths(pSrcRootPath, scene.String(uri));
 
-            if (!UpdatePackagedDataEntry(packedDataId, currentByteOffset))
-            {
-                return false;
-            }
+            // A missing file keeps an invalid stamp and fails the build once it is read
+            SourceRecord &source = o_Sources[i];
+            source.m_Path = static_cast<const char*>(pSrcFilePath);
+            io::ReadFileStamp(source.m_Path.c_str(), source.m_Stamp);
         }
     }
-
-    return true;
 }
 
-bool AssetDatabaseBuilder::BuildMeshes(Document &json, const char *pSrcRootPath, const char *pDestRootPath)
+bool AssetDatabaseBuilder::HashSource(SourceRecord &io_Source)
 {
-    static constexpr const char s_pBuffersBinFileName[] = "Buffers.bin";
-    static constexpr const char s_pBuffersProperty[] = "buffers";
-    static constexpr const char s_pUriProperty[] = "uri";
-
-    if (json.HasMember(s_pBuffersProperty) && json[s_pBuffersProperty].IsArray())
+    if (!io_Source.m_Hashed && io_Source.m_ByteSize < 0)
     {
-        Value &buffers = json[s_pBuffersProperty];
-        SizeType bufferCount = buffers.Size();
-
-        if (bufferCount > 0)
+        io_Source.m_Hashed = hashing::HashFile(io_Source.m_Path.c_str(), io_Source.m_Hash);
+    }
+    else if (!io_Source.m_Hashed)
+    {
+        // Only the bytes of the resource, the rest of the file changes without it
+        io::MappedFile srcFile;
+        if (srcFile.Open(io_Source.m_Path.c_str()) && io_Source.m_ByteOffset + io_Source.m_ByteSize <= static_cast<int64_t>(srcFile.Size()))
         {
-            int64_t packedDataId = InsertPackagedDataEntry(s_pBuffersBinFileName, PackedDataType::Meshes);
-            if (packedDataId < 0)
+            io_Source.m_Hash = hashing::Hash64(srcFile.Data() + io_Source.m_ByteOffset, static_cast<size_t>(io_Source.m_ByteSize));
+            io_Source.m_Hashed = true;
+        }
+    }
+
+    return io_Source.m_Hashed;
+}
+
+bool AssetDatabaseBuilder::DetectSourceChanges(std::vector<SourceRecord> &io_Sources, const std::vector<SourceRecord> &previousSources)
+{
+    for (size_t i = 0; i < io_Sources.size(); ++i)
+    {
+        SourceRecord &source = io_Sources[i];
+        const SourceRecord &previous = previousSources[i];
+
+        // Resources that gained or lost their file need rows inserted or removed, which shifts every ID after them
+        if (source.m_Path.empty() != previous.m_Path.empty())
+        {
+            return false;
+        }
+
+        source.m_ResourceId = previous.m_ResourceId;
+
+        if (source.m_Path.empty())
+        {
+            source.m_Changed = false;
+        }
+        else if (source.m_Path == previous.m_Path && source.m_Stamp == previous.m_Stamp)
+        {
+            source.m_Hash = previous.m_Hash;
+            source.m_Hashed = true;
+            source.m_Changed = false;
+        }
+        else
+        {
+            // Files that were touched or moved without their content changing are not rebuilt
+            source.m_Changed = !HashSource(source) || source.m_Hash != previous.m_Hash;
+        }
+    }
+
+    return true;
+}
+
+bool AssetDatabaseBuilder::PrepareBuild(const gltf::Scene &scene, const char *pSrcRootPath, const char *pDestRootPath)
+{
+    static constexpr const char s_pTexturesBinFileName[] = "Textures.bin";
+    static constexpr const char s_pBuffersBinFileName[] = "Buffers.bin";
+    static constexpr char s_LiveTextureByteSizeStr[] =
+        "SELECT SUM(ByteSize) FROM (SELECT DISTINCT ByteOffset, ByteSize FROM Texture WHERE PackedDataID = ?1);";
+    static constexpr char s_LiveBufferByteSizeStr[] = "SELECT SUM(ByteSize) FROM Buffer WHERE PackedDataID = ?1;";
+    static constexpr char s_TextureFormatStr[] = "SELECT Format FROM Texture WHERE ID = ?1;";
+    static constexpr char s_MisalignedCountFormat[] = "SELECT COUNT(*) FROM %s WHERE PackedDataID = ?1 AND (ByteOffset %% %u != 0 OR ByteSize %% %u != 0);";
+
+    ResolveSourcePaths(scene, SourceKind::Image, pSrcRootPath, m_ImageSources);
+    ResolveSourcePaths(scene, SourceKind::Buffer, pSrcRootPath, m_BufferSources);
+
+    // Textures are loaded from their file, images embedded in a buffer would be left out of the database
+    m_Stats.m_EmbeddedImageCount = static_cast<uint32_t>(std::count_if(scene.m_Images.begin(), scene.m_Images.end(), [](const gltf::Image &image)
+    {
+        return image.m_Uri == gltf::s_InvalidIndex && image.m_BufferView != gltf::s_InvalidIndex;
+    }));
+
+    if (m_Stats.m_EmbeddedImageCount > 0)
+    {
+        return false;
+    }
+
+    // The BIN chunk of a GLB backs the first buffer, which is read in place from the scene file
+    if (scene.m_GlbBinByteOffset >= 0 && !m_BufferSources.empty() && m_BufferSources[0].m_Path.empty())
+    {
+        SourceRecord &source = m_BufferSources[0];
+        source.m_Path = m_SceneSource.m_Path;
+        source.m_Stamp = m_SceneSource.m_Stamp;
+        source.m_ByteOffset = scene.m_GlbBinByteOffset;
+        source.m_ByteSize = scene.m_GlbBinByteSize;
+    }
+
+    std::vector<uint32_t> imageUsages;
+    textures::CollectImageUsages(scene, imageUsages);
+    m_ImageFormats.assign(m_ImageSources.size(), textures::BlockFormat::Auto);
+
+    for (size_t i = 0; i < m_ImageFormats.size() && i < imageUsages.size(); ++i)
+    {
+        m_ImageFormats[i] = textures::SelectBlockFormat(imageUsages[i], m_Settings.m_TextureFormats);
+    }
+
+    m_TexturesFile = {};
+    m_BuffersFile = {};
+    m_FullRebuild = true;
+
+    if (m_Settings.m_Incremental)
+    {
+        SourceRecord previousScene {};
+        std::vector<SourceRecord> previousImages;
+        std::vector<SourceRecord> previousBuffers;
+
+        if (!LoadSourceRecords(previousScene, previousImages, previousBuffers))
+        {
+            return false;
+        }
+
+        // Resources are matched by glTF index, adding or removing any of them invalidates every row ID
+        m_FullRebuild =
+            !previousScene.m_Hashed ||
+            previousImages.size() != m_ImageSources.size() ||
+            previousBuffers.size() != m_BufferSources.size() ||
+            !DetectSourceChanges(m_ImageSources, previousImages) ||
+            !DetectSourceChanges(m_BufferSources, previousBuffers);
+
+        if (!m_FullRebuild)
+        {
+            str_smart_ptr pTexturesFilePath = salvation::filesystem::AppendPaths(pDestRootPath, s_pTexturesBinFileName);
+            str_smart_ptr pBuffersFilePath = salvation::filesystem::AppendPaths(pDestRootPath, s_pBuffersBinFileName);
+
+            uint32_t alignment = ResolvePackedDataAlignment(m_Settings);
+            char misalignedTextureSql[160];
+            char misalignedBufferSql[160];
+
+            snprintf(misalignedTextureSql, sizeof(misalignedTextureSql), s_MisalignedCountFormat, "Texture", alignment, alignment);
+            snprintf(misalignedBufferSql, sizeof(misalignedBufferSql), s_MisalignedCountFormat, "Buffer", alignment, alignment);
+
+            if (
+                !LoadPackedFileState(PackedDataType::Textures, s_LiveTextureByteSizeStr, misalignedTextureSql, pTexturesFilePath, m_TexturesFile) ||
+                !LoadPackedFileState(PackedDataType::Meshes, s_LiveBufferByteSizeStr, misalignedBufferSql, pBuffersFilePath, m_BuffersFile))
+            {
+                return false;
+            }
+
+            m_SceneSource.m_Changed = m_SceneSource.m_Hash != previousScene.m_Hash;
+
+            // Buffers are processed according to the accessors of the glTF, which may have changed along with it
+            for (SourceRecord &source : m_BufferSources)
+            {
+                source.m_Changed = source.m_Changed || (m_SceneSource.m_Changed && !source.m_Path.empty());
+            }
+
+            // A rewritten file needs every resource it contains written again
+            for (SourceRecord &source : m_ImageSources)
+            {
+                source.m_Changed = source.m_Changed || (m_TexturesFile.m_Rewrite && !source.m_Path.empty());
+            }
+
+            // Material edits and format overrides can select another format for an unchanged image
+            for (size_t i = 0; i < m_ImageSources.size(); ++i)
+            {
+                SourceRecord &source = m_ImageSources[i];
+                if (source.m_Changed || source.m_Path.empty() || source.m_ResourceId < 0)
+                {
+                    continue;
+                }
+
+                int64_t format = -1;
+                if (!QueryInt64(s_TextureFormatStr, source.m_ResourceId, format))
+                {
+                    return false;
+                }
+
+                source.m_Changed = !textures::MatchesBlockFormat(m_ImageFormats[i], FromTextureFormat(format));
+            }
+
+            for (SourceRecord &source : m_BufferSources)
+            {
+                source.m_Changed = source.m_Changed || (m_BuffersFile.m_Rewrite && !source.m_Path.empty());
+            }
+
+            // Quantization parameters, narrowed index sizes, packed offsets, meshlet and LOD offsets depend on the buffer content and
+            // are stored with the metadata, which is regenerated as a whole from the streams of every buffer
+            bool anyBufferChanged = std::any_of(m_BufferSources.begin(), m_BufferSources.end(), [](const SourceRecord &source)
+            {
+                return source.m_Changed && !source.m_Path.empty();
+            });
+
+            std::vector<meshes::AccessorView> indexStreams;
+            if (m_Settings.m_NarrowIndices)
+            {
+                meshes::CollectIndexStreams(scene, indexStreams);
+            }
+
+            bool generatesData = m_Settings.m_BuildMeshlets || m_Settings.m_LodLevelCount > 0;
+
+            bool movesData =
+                m_Settings.m_QuantizeVertices || m_Settings.m_StripUnreferencedBufferData ||
+                m_Settings.m_VertexLayout != VertexLayout::Source || !indexStreams.empty();
+
+            if ((movesData || generatesData) && anyBufferChanged)
+            {
+                m_SceneSource.m_Changed = true;
+
+                for (SourceRecord &source : m_BufferSources)
+                {
+                    source.m_Changed = !source.m_Path.empty();
+                }
+            }
+        }
+    }
+
+    m_Stats.m_FullRebuild = m_FullRebuild;
+
+    if (m_FullRebuild)
+    {
+        m_SceneSource.m_Changed = true;
+
+        for (SourceRecord &source : m_ImageSources)
+        {
+            source.m_ResourceId = -1;
+            source.m_Changed = true;
+        }
+
+        for (SourceRecord &source : m_BufferSources)
+        {
+            source.m_ResourceId = -1;
+            source.m_Changed = true;
+        }
+
+        // Rows left by a previous build would otherwise be duplicated
+        return ClearBuildTables();
+    }
+
+    return true;
+}
+
+/// CMP_Feedback_Proc
+/// Feedback function for conversion.
+/// \param[in] fProgress The percentage progress of the texture compression.
+/// \return non-NULL(true) value to abort conversion
+static bool CMP_Feedback(CMP_FLOAT fProgress, CMP_DWORD_PTR pUser1, CMP_DWORD_PTR pUser2)
+{
+    return false;
+}
+
+// Everything that influences the compressed output of an image besides its format, part of the texture cache key
+struct TextureCompressionSettings
+{
+    float       m_Quality;
+    int32_t     m_MinMipSize;
+};
+
+static constexpr TextureCompressionSettings s_TextureCompressionSettings =
+{
+    1.0f,
+    4 // 4x4
+};
+
+// Only 8 bits per channel layouts are inspected, anything else is assumed to need alpha
+static bool HasTranslucentTexels(const CMP_MipSet &mipSet)
+{
+    if (mipSet.m_format == CMP_FORMAT_RGB_888)
+    {
+        return false;
+    }
+
+    CMP_MipLevel *pMipData = nullptr;
+    CMP_GetMipLevel(&pMipData, &mipSet, 0, 0);
+
+    if (!pMipData || !pMipData->m_pbData || (mipSet.m_format != CMP_FORMAT_RGBA_8888 && mipSet.m_format != CMP_FORMAT_BGRA_8888))
+    {
+        return true;
+    }
+
+    const CMP_BYTE *pTexels = pMipData->m_pbData;
+    size_t texelCount = static_cast<size_t>(pMipData->m_nWidth) * pMipData->m_nHeight;
+
+    for (size_t i = 0; i < texelCount; ++i)
+    {
+        if (pTexels[i * 4 + 3] != 0xff)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+struct AssetDatabaseBuilder::CompressedTexture
+{
+    int64_t                 m_TexelByteSize { 0 };
+    textures::MipChain      m_MipChain {};
+    CMP_MipSet              m_MipSet {};
+    std::vector<uint8_t>    m_CachedData {};
+    int64_t                 m_ByteOffset { -1 };        // Range of the texture in Textures.bin once committed
+    int64_t                 m_ByteSize { 0 };
+    int32_t                 m_Format { 0 };
+    double                  m_CompressSeconds { 0.0 };
+    bool                    m_Compressed { false };     // m_MipSet owns Compressonator allocations
+    bool                    m_Valid { false };          // m_MipChain describes the compressed texture
+};
+
+bool AssetDatabaseBuilder::CompressTexture(const char *pSrcFilePath, textures::BlockFormat format, int threadCount, CompressedTexture &o_Texture)
+{
+    CMP_MipSet mipSetIn = {};
+    CMP_ERROR result = CMP_LoadTexture(pSrcFilePath, &mipSetIn);
+    size_t formatIndex = 0;
+
+    if (result == CMP_OK)
+    {
+        o_Texture.m_TexelByteSize = static_cast<int64_t>(mipSetIn.m_nWidth) * mipSetIn.m_nHeight * 4;
+        formatIndex = BlockFormatIndex(textures::ResolveBlockFormat(format, format == textures::BlockFormat::Auto && HasTranslucentTexels(mipSetIn)));
+
+        // Generate MIP chain if not already generated
+        if (mipSetIn.m_nMipLevels <= 1)
+        {
+            CMP_GenerateMIPLevels(&mipSetIn, s_TextureCompressionSettings.m_MinMipSize);
+        }
+
+        {
+            KernelOptions kernelOptions = {};
+            kernelOptions.format = s_CMPFormats[formatIndex];
+            kernelOptions.fquality = s_TextureCompressionSettings.m_Quality;
+            kernelOptions.threads = threadCount; // 0 is auto setting
+
+            result = CMP_ProcessTexture(&mipSetIn, &o_Texture.m_MipSet, kernelOptions, &CMP_Feedback);
+            o_Texture.m_Compressed = true;
+        }
+    }
+
+    CMP_FreeMipSet(&mipSetIn);
+
+    if (result != CMP_OK || o_Texture.m_MipSet.m_nMipLevels > textures::s_MaxMipCount)
+    {
+        return false;
+    }
+
+    textures::MipChain &chain = o_Texture.m_MipChain;
+    chain.m_MipCount = o_Texture.m_MipSet.m_nMipLevels;
+    chain.m_Format = static_cast<int32_t>(s_TextureFormats[formatIndex]);
+
+    for (int i = 0; i < chain.m_MipCount; ++i)
+    {
+        CMP_MipLevel *pMipData;
+        CMP_GetMipLevel(&pMipData, &o_Texture.m_MipSet, i, 0);
+
+        textures::MipData &mip = chain.m_Mips[i];
+        mip.m_Width = pMipData->m_nWidth;
+        mip.m_Height = pMipData->m_nHeight;
+        mip.m_ByteSize = pMipData->m_dwLinearSize;
+        mip.m_pData = pMipData->m_pbData;
+    }
+
+    return true;
+}
+
+bool AssetDatabaseBuilder::LoadOrCompressTexture(textures::TextureCache &cache, textures::BlockFormat format, int threadCount, SourceRecord &io_Source, CompressedTexture &io_Texture)
+{
+    const char *pSrcFilePath = io_Source.m_Path.c_str();
+
+    if (!cache.IsEnabled())
+    {
+        return CompressTexture(pSrcFilePath, format, threadCount, io_Texture);
+    }
+
+    static const uint64_t s_SettingsHash = hashing::Hash64(&s_TextureCompressionSettings, sizeof(s_TextureCompressionSettings));
+
+    // Incremental builds already hashed the source to detect the change
+    if (!HashSource(io_Source))
+    {
+        return false;
+    }
+
+    textures::TextureCacheKey key {};
+    key.m_SourceHash = io_Source.m_Hash;
+    key.m_SettingsHash = hashing::CombineHashes(s_SettingsHash, static_cast<uint64_t>(format));
+
+    if (cache.Load(key, io_Texture.m_MipChain, io_Texture.m_CachedData))
+    {
+        const textures::MipData &topMip = io_Texture.m_MipChain.m_Mips[0];
+        io_Texture.m_TexelByteSize = static_cast<int64_t>(topMip.m_Width) * topMip.m_Height * 4;
+        return true;
+    }
+
+    if (!CompressTexture(pSrcFilePath, format, threadCount, io_Texture))
+    {
+        return false;
+    }
+
+    // Failing to populate the cache only costs a recompression next time
+    cache.Store(key, io_Texture.m_MipChain);
+
+    return true;
+}
+
+int64_t AssetDatabaseBuilder::WriteTexture(const textures::MipChain &chain, io::PackedFileWriter &writer)
+{
+    int64_t byteSize = 0;
+
+    for (int i = 0; i < chain.m_MipCount; ++i)
+    {
+        const textures::MipData &mip = chain.m_Mips[i];
+
+        if (!writer.Write(mip.m_pData, mip.m_ByteSize))
+        {
+            return -1;
+        }
+
+        byteSize += mip.m_ByteSize;
+    }
+
+    return byteSize;
+}
+
+int64_t AssetDatabaseBuilder::PadPackedFile(int64_t byteSize, io::PackedFileWriter &writer)
+{
+    static constexpr uint8_t s_Zeros[4096] = {};
+
+    int64_t alignment = ResolvePackedDataAlignment(m_Settings);
+    int64_t paddedByteSize = (byteSize + alignment - 1) & ~(alignment - 1);
+
+    for (int64_t remaining = paddedByteSize - byteSize; remaining > 0;)
+    {
+        size_t chunkByteSize = static_cast<size_t>(std::min<int64_t>(remaining, sizeof(s_Zeros)));
+        if (!writer.Write(s_Zeros, chunkByteSize))
+        {
+            return -1;
+        }
+
+        remaining -= chunkByteSize;
+    }
+
+    m_Stats.m_AlignmentPaddingByteSize += paddedByteSize - byteSize;
+    return paddedByteSize;
+}
+
+bool AssetDatabaseBuilder::InsertPackedDataChunkMetadata(const io::PackedFileWriter &writer, int64_t packedDataId, const PackedFileState &packedFile)
+{
+    // Chunks of a rewritten file replace every previous one
+    if (packedFile.m_Rewrite && !DeletePackedDataChunkDataEntries(packedDataId))
+    {
+        return false;
+    }
+
+    const std::vector<io::PackedChunk> &chunks = writer.Chunks();
+
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        const io::PackedChunk &chunk = chunks[i];
+
+        if (!InsertPackedDataChunkDataEntry(packedDataId, packedFile.m_ChunkCount + static_cast<int64_t>(i), chunk))
+        {
+            return false;
+        }
+
+        m_Stats.m_ChunkCount++;
+        m_Stats.m_ChunkByteSize += chunk.m_ByteSize;
+        m_Stats.m_ChunkFileByteSize += chunk.m_FileByteSize;
+    }
+
+    return true;
+}
+
+bool AssetDatabaseBuilder::InsertTextureMipMetadata(const textures::MipChain &chain, int64_t textureId, int64_t textureByteOffset)
+{
+    int64_t mipByteOffset = textureByteOffset;
+
+    for (int i = 0; i < chain.m_MipCount; ++i)
+    {
+        const textures::MipData &mip = chain.m_Mips[i];
+
+        if (!InsertTextureMipDataEntry(textureId, i, mip.m_Width, mip.m_Height, mipByteOffset, mip.m_ByteSize))
+        {
+            return false;
+        }
+
+        mipByteOffset += mip.m_ByteSize;
+    }
+
+    return true;
+}
+
+void AssetDatabaseBuilder::ReleaseTexture(CompressedTexture &texture)
+{
+    if (texture.m_Compressed)
+    {
+        CMP_FreeMipSet(&texture.m_MipSet);
+        texture.m_Compressed = false;
+    }
+
+    texture.m_CachedData = {};
+    texture.m_MipChain = {};
+    texture.m_Valid = false;
+}
+
+int64_t AssetDatabaseBuilder::InsertPackagedDataEntry(const char *pFilePath, salvation::asset::PackedDataType dataType)
+{
+    int64_t packageID = -1;
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pPackedDataStmt;
+
+    if (
+        sqlite3_reset(pStmt) == SQLITE_OK && 
+        sqlite3_bind_text(pStmt, 1, pFilePath, -1, SQLITE_STATIC) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 2, static_cast<int>(dataType)) == SQLITE_OK &&
+        StepStatement(pStmt))
+    {
+        packageID = sqlite3_last_insert_rowid(m_pDb);
+    }
+
+    return packageID;
+}
+
+int64_t AssetDatabaseBuilder::InsertTextureDataEntry(int64_t byteSize, int64_t byteOffset, int32_t format, int64_t packedDataId)
+{
+    int64_t textureId = -1;
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pTextureStmt;
+
+    if (
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, byteSize) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 2, byteOffset) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 3, format) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 4, packedDataId) == SQLITE_OK &&
+        StepStatement(pStmt))
+    {
+        textureId = sqlite3_last_insert_rowid(m_pDb);
+    }
+
+    return textureId;
+}
+
+bool AssetDatabaseBuilder::InsertTextureMipDataEntry(int64_t textureId, int32_t level, int32_t width, int32_t height, int64_t byteOffset, int64_t byteSize)
+{
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pTextureMipStmt;
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, textureId) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 2, level) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 3, width) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 4, height) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 5, byteOffset) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 6, byteSize) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+bool AssetDatabaseBuilder::CopyTextureMipDataEntries(int64_t textureId, int64_t srcTextureId)
+{
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pTextureMipCopyStmt;
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, textureId) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 2, srcTextureId) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+int64_t AssetDatabaseBuilder::InsertBufferDataEntry(int64_t byteSize, int64_t byteOffset, int64_t packedDataId)
+{
+    int64_t bufferId = -1;
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pBufferStmt;
+
+    if (
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, byteSize) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 2, byteOffset) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 3, packedDataId) == SQLITE_OK &&
+        StepStatement(pStmt))
+    {
+        bufferId = sqlite3_last_insert_rowid(m_pDb);
+    }
+
+    return bufferId;
+}
+
+bool AssetDatabaseBuilder::InsertMaterialDataEntry(int64_t textureId)
+{
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pMaterialStmt;
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, textureId) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+int64_t AssetDatabaseBuilder::InsertBufferViewDataEntry(int64_t bufferId, int64_t byteSize, int64_t byteOffset, int32_t stride)
+{
+    int64_t bufferViewId = -1;
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pBufferViewStmt;
+
+    if (
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, bufferId) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 2, byteSize) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 3, byteOffset) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 4, stride) == SQLITE_OK &&
+        StepStatement(pStmt))
+    {
+        bufferViewId = sqlite3_last_insert_rowid(m_pDb);
+    }
+
+    return bufferViewId;
+}
+
+bool AssetDatabaseBuilder::InsertBufferViewEncodingDataEntry(int64_t bufferViewId, const meshes::QuantizedStream &encoding)
+{
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pBufferViewEncodingStmt;
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, bufferViewId) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 2, static_cast<int>(encoding.m_Encoding)) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 3, static_cast<int>(encoding.m_ComponentType)) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 4, encoding.m_ComponentCount) == SQLITE_OK &&
+        sqlite3_bind_double(pStmt, 5, encoding.m_Scale[0]) == SQLITE_OK &&
+        sqlite3_bind_double(pStmt, 6, encoding.m_Scale[1]) == SQLITE_OK &&
+        sqlite3_bind_double(pStmt, 7, encoding.m_Scale[2]) == SQLITE_OK &&
+        sqlite3_bind_double(pStmt, 8, encoding.m_Offset[0]) == SQLITE_OK &&
+        sqlite3_bind_double(pStmt, 9, encoding.m_Offset[1]) == SQLITE_OK &&
+        sqlite3_bind_double(pStmt, 10, encoding.m_Offset[2]) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+int64_t AssetDatabaseBuilder::InsertMeshDataEntry(const char *pName)
+{
+    int64_t meshId = -1;
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pMeshStmt;
+
+    if (
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_text(pStmt, 1, pName, -1, SQLITE_STATIC) == SQLITE_OK &&
+        StepStatement(pStmt))
+    {
+        meshId = sqlite3_last_insert_rowid(m_pDb);
+    }
+
+    return meshId;
+}
+
+int64_t AssetDatabaseBuilder::InsertSubMeshDataEntry(int64_t meshId, int64_t indexBufferViewId, int64_t materialId)
+{
+    int64_t subMeshId = -1;
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pSubMeshStmt;
+
+    if (
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, meshId) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 2, indexBufferViewId) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 3, materialId) == SQLITE_OK &&
+        StepStatement(pStmt))
+    {
+        subMeshId = sqlite3_last_insert_rowid(m_pDb);
+    }
+
+    return subMeshId;
+}
+
+bool AssetDatabaseBuilder::InsertVertexStreamDataEntry(int64_t subMeshId, int64_t bufferViewId, int32_t attribute)
+{
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pVertexStreamStmt;
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, subMeshId) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 2, bufferViewId) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 3, attribute) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+bool AssetDatabaseBuilder::InsertMeshletDataEntry(int64_t subMeshId, const MeshletRange &range)
+{
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pMeshletStmt;
+    int64_t bufferId = range.m_BufferIndex + 1; // +1 since sqlite integer primary keys start at 1
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, subMeshId) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 2, bufferId) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 3, static_cast<int>(range.m_MeshletCount)) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 4, range.m_MeshletByteOffset) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 5, range.m_VertexIndexByteOffset) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 6, static_cast<int>(range.m_VertexIndexCount)) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 7, range.m_TriangleByteOffset) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 8, static_cast<int>(range.m_TriangleByteSize)) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+bool AssetDatabaseBuilder::InsertSubMeshLODDataEntry(int64_t subMeshId, const LodRange &range)
+{
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pSubMeshLODStmt;
+    int64_t bufferId = range.m_BufferIndex + 1; // +1 since sqlite integer primary keys start at 1
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, subMeshId) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 2, static_cast<int>(range.m_Level)) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 3, bufferId) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 4, range.m_ByteOffset) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 5, static_cast<int>(range.m_IndexCount)) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 6, static_cast<int>(range.m_IndexByteSize)) == SQLITE_OK &&
+        sqlite3_bind_double(pStmt, 7, range.m_Error) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+bool AssetDatabaseBuilder::InsertPackedDataChunkDataEntry(int64_t packedDataId, int64_t chunkIndex, const io::PackedChunk &chunk)
+{
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pPackedDataChunkStmt;
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, packedDataId) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 2, chunkIndex) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 3, chunk.m_ByteOffset) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 4, chunk.m_ByteSize) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 5, chunk.m_FileByteOffset) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 6, chunk.m_FileByteSize) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 7, static_cast<int>(chunk.m_Codec)) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+bool AssetDatabaseBuilder::InsertSourceFileDataEntry(SourceKind kind, int64_t resourceIndex, const SourceRecord &source)
+{
+    sqlite3_stmt *pStmt = m_InsertStmts.m_pSourceFileStmt;
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 1, static_cast<int>(kind)) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 2, resourceIndex) == SQLITE_OK &&
+        sqlite3_bind_text(pStmt, 3, source.m_Path.c_str(), -1, SQLITE_STATIC) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 4, source.m_Stamp.m_ByteSize) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 5, source.m_Stamp.m_ModifiedTime) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 6, static_cast<int64_t>(source.m_Hash)) == SQLITE_OK &&
+        (source.m_ResourceId < 0 ?
+            sqlite3_bind_null(pStmt, 7) :
+            sqlite3_bind_int64(pStmt, 7, source.m_ResourceId)) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+bool AssetDatabaseBuilder::UpdatePackagedDataEntry(int64_t packagedDataId, int64_t byteSize)
+{
+    sqlite3_stmt *pStmt = m_UpdateStmts.m_pPackedDataStmt;
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, packagedDataId) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 2, byteSize) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+bool AssetDatabaseBuilder::UpdateTextureDataEntry(int64_t textureId, int64_t byteSize, int64_t byteOffset, int32_t format)
+{
+    sqlite3_stmt *pStmt = m_UpdateStmts.m_pTextureStmt;
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, textureId) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 2, byteSize) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 3, byteOffset) == SQLITE_OK &&
+        sqlite3_bind_int(pStmt, 4, format) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+bool AssetDatabaseBuilder::UpdateBufferDataEntry(int64_t bufferId, int64_t byteSize, int64_t byteOffset)
+{
+    sqlite3_stmt *pStmt = m_UpdateStmts.m_pBufferStmt;
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, bufferId) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 2, byteSize) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 3, byteOffset) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+bool AssetDatabaseBuilder::DeleteTextureMipDataEntries(int64_t textureId)
+{
+    sqlite3_stmt *pStmt = m_UpdateStmts.m_pTextureMipDeleteStmt;
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, textureId) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+bool AssetDatabaseBuilder::DeletePackedDataChunkDataEntries(int64_t packedDataId)
+{
+    sqlite3_stmt *pStmt = m_UpdateStmts.m_pPackedDataChunkDeleteStmt;
+
+    return
+        sqlite3_reset(pStmt) == SQLITE_OK &&
+        sqlite3_bind_int64(pStmt, 1, packedDataId) == SQLITE_OK &&
+        StepStatement(pStmt);
+}
+
+bool AssetDatabaseBuilder::BuildTextures(const gltf::Scene &scene, const char *pSrcRootPath, const char *pDestRootPath)
+{
+    static constexpr const char s_pTexturesBinFileName[] = "Textures.bin";
+
+    profiling::ScopedZone zone("BuildTextures", -1, &m_Stats.m_BuildTexturesSeconds);
+
+    SizeType imageCount = static_cast<SizeType>(m_ImageSources.size());
+
+    if (imageCount > 0)
+    {
+        str_smart_ptr pDestFilePath = salvation::filesystem::AppendPaths(pDestRootPath, s_pTexturesBinFileName);
+        PackedFileState &packedFile = m_TexturesFile;
+        FILE *pDestFile = nullptr;
+
+        // Textures rebuilt by an incremental build are appended after the existing content
+        if (fopen_s(&pDestFile, pDestFilePath, packedFile.m_Rewrite ? "wb" : "r+b") != 0)
+        {
+            return false;
+        }
+
+        if (!packedFile.m_Rewrite && fseek(pDestFile, 0, SEEK_END) != 0)
+        {
+            fclose(pDestFile);
+            return false;
+        }
+
+        int64_t packedDataId = packedFile.m_PackedDataId;
+        if (packedDataId < 0)
+        {
+            packedDataId = InsertPackagedDataEntry(s_pTexturesBinFileName, PackedDataType::Textures);
+            if (packedDataId < 0)
+            {
+                fclose(pDestFile);
+                return false;
+            }
+        }
+
+        std::vector<CompressedTexture> compressedTextures(imageCount);
+
+        // Images are compressed concurrently but committed in image order so that offsets stay reproducible.
+        // Each worker runs Compressonator single-threaded to avoid oversubscribing the cores.
+        uint32_t workerCount = threading::ResolveWorkerThreadCount(m_Settings.m_WorkerThreadCount);
+        int cmpThreadCount = workerCount > 1 ? 1 : 0;
+        textures::TextureCache cache(m_Settings.m_pTextureCacheDirectory, m_Settings.m_TextureCacheMaxByteSize);
+        int64_t currentByteOffset = packedFile.m_ByteSize;
+        io::PackedFileWriter writer(
+            pDestFile, packedFile.m_ByteSize, packedFile.m_FileByteSize,
+            m_Settings.m_CompressionChunkByteSize, ResolvePackedDataAlignment(m_Settings), workerCount, m_Settings.m_WriteQueueLength);
+
+        // Images whose content matches an earlier image of the build, under the same or another URI,
+        // are not compressed and their Texture row points to the Textures.bin range of the first one
+        std::vector<int32_t> originalImages(imageCount, -1);
+
+        if (m_Settings.m_DeduplicateTextures)
+        {
+            std::unordered_map<uint64_t, uint32_t> imagesByHash;
+
+            threading::OrderedParallelFor(imageCount, workerCount, workerCount * 2,
+                [&](uint32_t i)
+                {
+                    SourceRecord &source = m_ImageSources[i];
+                    if (!source.m_Path.empty() && source.m_Changed)
+                    {
+                        profiling::ScopedZone hashZone("HashTexture", i);
+                        HashSource(source);
+                    }
+                },
+                [&](uint32_t i)
+                {
+                    const SourceRecord &source = m_ImageSources[i];
+                    if (!source.m_Path.empty() && source.m_Changed && source.m_Hashed)
+                    {
+                        // Identical images selected for different formats are compressed separately
+                        auto result = imagesByHash.emplace(hashing::CombineHashes(source.m_Hash, static_cast<uint64_t>(m_ImageFormats[i])), i);
+                        if (!result.second)
+                        {
+                            originalImages[i] = static_cast<int32_t>(result.first->second);
+                        }
+                    }
+
+                    return true;
+                });
+        }
+
+        bool success = threading::OrderedParallelFor(imageCount, workerCount, workerCount * 2,
+            [&](uint32_t i)
+            {
+                // Each worker only ever touches the source record of its own image
+                SourceRecord &source = m_ImageSources[i];
+                if (!source.m_Path.empty() && source.m_Changed && originalImages[i] < 0)
+                {
+                    CompressedTexture &texture = compressedTextures[i];
+                    profiling::ScopedZone textureZone("CompressTexture", i, &texture.m_CompressSeconds);
+                    texture.m_Valid = LoadOrCompressTexture(cache, m_ImageFormats[i], cmpThreadCount, source, texture);
+                }
+            },
+            [&](uint32_t i)
+            {
+                SourceRecord &source = m_ImageSources[i];
+                if (source.m_Path.empty())
+                {
+                    return true;
+                }
+
+                if (!source.m_Changed)
+                {
+                    m_Stats.m_ReusedTextureCount++;
+                    return true;
+                }
+
+                profiling::ScopedZone textureZone("WriteTexture", i);
+                CompressedTexture &texture = compressedTextures[i];
+                int32_t originalImage = originalImages[i];
+
+                if (originalImage < 0)
+                {
+                    int64_t textureByteSize = texture.m_Valid ? WriteTexture(texture.m_MipChain, writer) : -1;
+                    if (textureByteSize <= 0)
+                    {
+                        return false;
+                    }
+
+                    // The recorded size includes the padding so the next texture starts aligned
+                    m_Stats.m_TextureByteSize += textureByteSize;
+                    textureByteSize = PadPackedFile(textureByteSize, writer);
+                    if (textureByteSize < 0)
+                    {
+                        return false;
+                    }
+
+                    texture.m_ByteOffset = currentByteOffset;
+                    texture.m_ByteSize = textureByteSize;
+                    texture.m_Format = texture.m_MipChain.m_Format;
+                    currentByteOffset += textureByteSize;
+                }
+                else
+                {
+                    // The original image was committed first and kept its range
+                    const CompressedTexture &original = compressedTextures[originalImage];
+
+                    texture.m_ByteOffset = original.m_ByteOffset;
+                    texture.m_ByteSize = original.m_ByteSize;
+                    texture.m_Format = original.m_Format;
+
+                    m_Stats.m_DuplicateTextureCount++;
+                    m_Stats.m_DuplicateTextureByteSize += original.m_ByteSize;
+                    m_Stats.m_DuplicateTextureSeconds += original.m_CompressSeconds;
+                }
+
+                int64_t textureId = source.m_ResourceId;
+
+                if (textureId < 0)
+                {
+                    textureId = InsertTextureDataEntry(texture.m_ByteSize, texture.m_ByteOffset, texture.m_Format, packedDataId);
+                }
+                else if (
+                    !UpdateTextureDataEntry(textureId, texture.m_ByteSize, texture.m_ByteOffset, texture.m_Format) ||
+                    !DeleteTextureMipDataEntries(textureId))
+                {
+                    textureId = -1;
+                }
+
+                bool mipsInserted = textureId >= 0 && (originalImage < 0 ?
+                    InsertTextureMipMetadata(texture.m_MipChain, textureId, texture.m_ByteOffset) :
+                    CopyTextureMipDataEntries(textureId, m_ImageSources[originalImage].m_ResourceId));
+
+                if (!mipsInserted)
+                {
+                    return false;
+                }
+
+                ReleaseTexture(texture);
+                source.m_ResourceId = textureId;
+
+                if (originalImage < 0)
+                {
+                    m_Stats.m_TextureCount++;
+                    m_Stats.m_TextureTexelByteSize += texture.m_TexelByteSize;
+                }
+
+                return true;
+            });
+
+        for (CompressedTexture &texture : compressedTextures)
+        {
+            ReleaseTexture(texture);
+        }
+
+        // Queued writes have to land before the file is closed, even when the build failed
+        success = writer.Finish() && success && InsertPackedDataChunkMetadata(writer, packedDataId, packedFile);
+        m_Stats.m_WriteStallSeconds += writer.WriteStallSeconds();
+        fclose(pDestFile);
+
+        cache.Evict();
+        m_Stats.m_TextureCacheHitCount = cache.HitCount();
+        m_Stats.m_TextureCacheMissCount = cache.MissCount();
+        m_Stats.m_TextureCacheEvictedCount = cache.EvictedCount();
+
+        if (!success || !UpdatePackagedDataEntry(packedDataId, currentByteOffset))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AssetDatabaseBuilder::BuildMeshes(const gltf::Scene &scene, const char *pSrcRootPath, const char *pDestRootPath)
+{
+    static constexpr const char s_pBuffersBinFileName[] = "Buffers.bin";
+
+    profiling::ScopedZone zone("BuildMeshes", -1, &m_Stats.m_BuildMeshesSeconds);
+
+    SizeType bufferCount = static_cast<SizeType>(m_BufferSources.size());
+
+    if (bufferCount > 0)
+    {
+        PackedFileState &packedFile = m_BuffersFile;
+        int64_t packedDataId = packedFile.m_PackedDataId;
+
+        if (packedDataId < 0)
+        {
+            packedDataId = InsertPackagedDataEntry(s_pBuffersBinFileName, PackedDataType::Meshes);
+            if (packedDataId < 0)
+            {
+                return false;
+            }
+        }
+
+        str_smart_ptr destFilePath = salvation::filesystem::AppendPaths(pDestRootPath, s_pBuffersBinFileName);
+
+        // Buffers rebuilt by an incremental build are appended after the existing content
+        FILE *pDestFile = nullptr;
+        if (fopen_s(&pDestFile, destFilePath, packedFile.m_Rewrite ? "wb" : "r+b") != 0)
+        {
+            return false;
+        }
+
+        bool writeSucceeded = packedFile.m_Rewrite || fseek(pDestFile, 0, SEEK_END) == 0;
+        int64_t currentByteOffset = packedFile.m_ByteSize;
+        io::PackedFileWriter writer(
+            pDestFile, packedFile.m_ByteSize, packedFile.m_FileByteSize, m_Settings.m_CompressionChunkByteSize,
+            ResolvePackedDataAlignment(m_Settings), threading::ResolveWorkerThreadCount(m_Settings.m_WorkerThreadCount),
+            m_Settings.m_WriteQueueLength);
+
+        // Grouped by buffer so each buffer is loaded once with all the primitives and streams it holds
+        std::vector<meshes::MeshPrimitive> primitives;
+        bool needsPrimitives =
+            m_Settings.m_OptimizeMeshes || m_Settings.m_BuildMeshlets || m_Settings.m_LodLevelCount > 0 ||
+            m_Settings.m_VertexLayout == VertexLayout::Interleaved;
+
+        if (needsPrimitives)
+        {
+            meshes::CollectMeshPrimitives(scene, primitives);
+            std::stable_sort(primitives.begin(), primitives.end(), [](const meshes::MeshPrimitive &a, const meshes::MeshPrimitive &b)
+            {
+                return a.m_BufferIndex < b.m_BufferIndex;
+            });
+        }
+
+        std::vector<meshes::VertexStream> streams;
+        if (m_Settings.m_QuantizeVertices)
+        {
+            meshes::CollectVertexStreams(scene, streams);
+            std::stable_sort(streams.begin(), streams.end(), [](const meshes::VertexStream &a, const meshes::VertexStream &b)
+            {
+                return a.m_View.m_BufferIndex < b.m_View.m_BufferIndex;
+            });
+        }
+
+        std::vector<meshes::AccessorView> indexStreams;
+        if (m_Settings.m_NarrowIndices)
+        {
+            meshes::CollectIndexStreams(scene, indexStreams);
+            std::stable_sort(indexStreams.begin(), indexStreams.end(), [](const meshes::AccessorView &a, const meshes::AccessorView &b)
+            {
+                return a.m_BufferIndex < b.m_BufferIndex;
+            });
+        }
+
+        std::vector<meshes::ReferencedRange> referencedRanges;
+        if (m_Settings.m_StripUnreferencedBufferData)
+        {
+            meshes::CollectReferencedRanges(scene, referencedRanges);
+            std::stable_sort(referencedRanges.begin(), referencedRanges.end(), [](const meshes::ReferencedRange &a, const meshes::ReferencedRange &b)
+            {
+                return a.m_BufferIndex < b.m_BufferIndex;
+            });
+        }
+
+        std::vector<meshes::AccessorView> interleavedStreams;
+        if (m_Settings.m_VertexLayout == VertexLayout::Deinterleaved)
+        {
+            meshes::CollectInterleavedStreams(scene, interleavedStreams);
+            std::stable_sort(interleavedStreams.begin(), interleavedStreams.end(), [](const meshes::AccessorView &a, const meshes::AccessorView &b)
+            {
+                return a.m_BufferIndex < b.m_BufferIndex;
+            });
+        }
+
+        m_StreamEncodings.assign(scene.m_Accessors.size(), {});
+        m_NarrowedIndices.assign(m_StreamEncodings.size(), 0);
+        m_StreamRelocations.assign(m_StreamEncodings.size(), {});
+        m_MeshletRanges.clear();
+        m_LodRanges.clear();
+        m_BufferSegments.assign(bufferCount, {});
+
+        auto primitiveIt = primitives.begin();
+        auto streamIt = streams.begin();
+        auto indicesIt = indexStreams.begin();
+        auto rangeIt = referencedRanges.begin();
+        auto interleavedIt = interleavedStreams.begin();
+
+        for (SizeType i = 0; i < bufferCount && writeSucceeded; ++i)
+        {
+            SourceRecord &source = m_BufferSources[i];
+
+            auto primitivesBegin = primitiveIt;
+            while (primitiveIt != primitives.end() && primitiveIt->m_BufferIndex == static_cast<int32_t>(i))
+            {
+                ++primitiveIt;
+            }
+
+            auto streamsBegin = streamIt;
+            while (streamIt != streams.end() && streamIt->m_View.m_BufferIndex == static_cast<int32_t>(i))
+            {
+                ++streamIt;
+            }
+
+            auto indicesBegin = indicesIt;
+            while (indicesIt != indexStreams.end() && indicesIt->m_BufferIndex == static_cast<int32_t>(i))
+            {
+                ++indicesIt;
+            }
+
+            auto rangesBegin = rangeIt;
+            while (rangeIt != referencedRanges.end() && rangeIt->m_BufferIndex == static_cast<int32_t>(i))
+            {
+                ++rangeIt;
+            }
+
+            auto interleavedBegin = interleavedIt;
+            while (interleavedIt != interleavedStreams.end() && interleavedIt->m_BufferIndex == static_cast<int32_t>(i))
+            {
+                ++interleavedIt;
+            }
+
+            if (source.m_Path.empty())
+            {
+                continue;
+            }
+
+            if (!source.m_Changed)
+            {
+                m_Stats.m_ReusedBufferCount++;
+                continue;
+            }
+
+            profiling::ScopedZone bufferZone("CopyBuffer", i);
+            MeshBufferJob job {};
+            job.m_BufferIndex = static_cast<int32_t>(i);
+            job.m_PrimitiveCount = static_cast<size_t>(primitiveIt - primitivesBegin);
+            job.m_pPrimitives = job.m_PrimitiveCount > 0 ? &*primitivesBegin : nullptr;
+            job.m_StreamCount = static_cast<size_t>(streamIt - streamsBegin);
+            job.m_pStreams = job.m_StreamCount > 0 ? &*streamsBegin : nullptr;
+            job.m_IndicesCount = static_cast<size_t>(indicesIt - indicesBegin);
+            job.m_pIndices = job.m_IndicesCount > 0 ? &*indicesBegin : nullptr;
+            job.m_RangeCount = static_cast<size_t>(rangeIt - rangesBegin);
+            job.m_pRanges = job.m_RangeCount > 0 ? &*rangesBegin : nullptr;
+            job.m_InterleavedCount = static_cast<size_t>(interleavedIt - interleavedBegin);
+            job.m_pInterleaved = job.m_InterleavedCount > 0 ? &*interleavedBegin : nullptr;
+
+            // Buffers stored in part of a file, the BIN chunk of a GLB, are copied out of its mapping
+            bool processBuffer =
+                m_Settings.m_StripUnreferencedBufferData || source.m_ByteSize >= 0 ||
+                job.m_PrimitiveCount > 0 || job.m_StreamCount > 0 || job.m_IndicesCount > 0 || job.m_InterleavedCount > 0;
+
+            // A buffer no primitive reads is packed empty when stripping
+            int64_t fileSize = processBuffer ?
+                WriteProcessedBuffer(job, source, writer) :
+                writer.AppendFileContent(source.m_Path.c_str());
+            int64_t bufferId = source.m_ResourceId;
+
+            bool written = fileSize > 0 || (fileSize == 0 && m_Settings.m_StripUnreferencedBufferData);
+            if (written)
+            {
+                // The recorded size includes the padding so the next buffer starts aligned
+                m_Stats.m_BufferByteSize += fileSize;
+                fileSize = PadPackedFile(fileSize, writer);
+            }
+
+            if (!written || fileSize < 0)
+            {
+                writeSucceeded = false;
+            }
+            else if (bufferId < 0)
+            {
+                bufferId = InsertBufferDataEntry(fileSize, currentByteOffset, packedDataId);
+                writeSucceeded = bufferId >= 0;
+            }
+            else
+            {
+                writeSucceeded = UpdateBufferDataEntry(bufferId, fileSize, currentByteOffset);
+            }
+
+            source.m_ResourceId = bufferId;
+
+            m_Stats.m_BufferCount++;
+
+            currentByteOffset += fileSize;
+        }
+
+        // Queued writes have to land before the file is closed, even when the build failed
+        writeSucceeded = writer.Finish() && writeSucceeded && InsertPackedDataChunkMetadata(writer, packedDataId, packedFile);
+        m_Stats.m_WriteStallSeconds += writer.WriteStallSeconds();
+        fclose(pDestFile);
+
+        std::sort(m_MeshletRanges.begin(), m_MeshletRanges.end(), [](const MeshletRange &a, const MeshletRange &b)
+        {
+            return a.Precedes(b);
+        });
+
+        // Stable so the levels of a primitive stay in the order they were built
+        std::stable_sort(m_LodRanges.begin(), m_LodRanges.end(), [](const LodRange &a, const LodRange &b)
+        {
+            return a.Precedes(b);
+        });
+
+        if (writeSucceeded && !UpdatePackagedDataEntry(packedDataId, currentByteOffset))
+        {
+            return false;
+        }
+
+        return writeSucceeded;
+    }
+
+    return true;
+}
+
+int64_t AssetDatabaseBuilder::WriteProcessedBuffer(const MeshBufferJob &job, const SourceRecord &source, io::PackedFileWriter &writer)
+{
+    // Kept open until the buffer is written, stages that only read the buffer read the mapping directly
+    io::MappedFile srcFile;
+    if (!srcFile.Open(source.m_Path.c_str()))
+    {
+        return -1;
+    }
+
+    int64_t srcByteOffset = source.m_ByteSize >= 0 ? source.m_ByteOffset : 0;
+    int64_t srcByteSize = source.m_ByteSize >= 0 ? source.m_ByteSize : static_cast<int64_t>(srcFile.Size());
+
+    if (srcByteOffset < 0 || srcByteOffset + srcByteSize > static_cast<int64_t>(srcFile.Size()))
+    {
+        return -1;
+    }
+
+    // Optimization, quantization and narrowing rewrite the buffer in place and work on a copy
+    bool rewritesBuffer =
+        (m_Settings.m_OptimizeMeshes && job.m_PrimitiveCount > 0) || job.m_StreamCount > 0 || job.m_IndicesCount > 0;
+
+    std::vector<uint8_t> bufferCopy;
+    const uint8_t *pBufferData = srcFile.Data() + srcByteOffset;
+    size_t bufferByteSize = static_cast<size_t>(srcByteSize);
+
+    if (rewritesBuffer)
+    {
+        bufferCopy.assign(pBufferData, pBufferData + bufferByteSize);
+        pBufferData = bufferCopy.data();
+    }
+
+    // Data generated from the primitives is appended after the buffer content, 16 bytes aligned.
+    // Its offsets are relative to the generated data until the size of the packed buffer is known.
+    static constexpr size_t s_GeneratedDataAlignment = 16;
+
+    std::vector<uint8_t> generatedData;
+    size_t meshletRangesBegin = m_MeshletRanges.size();
+    size_t lodRangesBegin = m_LodRanges.size();
+
+    auto appendGeneratedData = [&](const void *pData, size_t byteSize)
+    {
+        generatedData.resize((generatedData.size() + s_GeneratedDataAlignment - 1) & ~(s_GeneratedDataAlignment - 1), 0);
+
+        int64_t byteOffset = static_cast<int64_t>(generatedData.size());
+        const uint8_t *pBytes = static_cast<const uint8_t*>(pData);
+        generatedData.insert(generatedData.end(), pBytes, pBytes + byteSize);
+
+        return byteOffset;
+    };
+
+    // Primitives never write to the same bytes, see CollectMeshPrimitives
+    const meshes::MeshPrimitive *pPrimitives = job.m_pPrimitives;
+    size_t primitiveCount = job.m_PrimitiveCount;
+    uint32_t workerCount = threading::ResolveWorkerThreadCount(m_Settings.m_WorkerThreadCount);
+    std::vector<meshes::VertexCacheStats> statsBefore(primitiveCount);
+    std::vector<meshes::VertexCacheStats> statsAfter(primitiveCount);
+    std::vector<uint8_t> optimized(primitiveCount, 0);
+    std::vector<meshes::MeshletSet> meshletSets(primitiveCount);
+    std::vector<uint8_t> meshletsBuilt(primitiveCount, 0);
+    std::vector<std::vector<meshes::LodLevel>> lodLevels(primitiveCount);
+
+    uint32_t lodLevelCount = std::min(m_Settings.m_LodLevelCount, s_MaxLodLevelCount);
+    float lodTriangleRatios[s_MaxLodLevelCount];
+    float lodMaxErrors[s_MaxLodLevelCount];
+
+    for (uint32_t i = 0; i < lodLevelCount; ++i)
+    {
+        lodTriangleRatios[i] = m_Settings.m_LodLevels[i].m_TriangleRatio;
+        lodMaxErrors[i] = m_Settings.m_LodLevels[i].m_MaxError;
+    }
+
+    threading::OrderedParallelFor(static_cast<uint32_t>(primitiveCount), workerCount, workerCount * 2,
+        [&](uint32_t i)
+        {
+            const meshes::MeshPrimitive &primitive = pPrimitives[i];
+
+            if (m_Settings.m_OptimizeMeshes)
+            {
+                profiling::ScopedZone primitiveZone("OptimizeMesh", primitive.m_SceneIndex);
+                optimized[i] = meshes::OptimizeMeshPrimitive(
+                    primitive, bufferCopy.data(), bufferCopy.size(),
+                    m_Settings.m_VertexCacheSize, m_Settings.m_OverdrawThreshold,
+                    statsBefore[i], statsAfter[i]) ? 1 : 0;
+            }
+
+            // Meshlets follow the optimized triangle order
+            if (m_Settings.m_BuildMeshlets)
             {
-                return false;
+                profiling::ScopedZone meshletZone("BuildMeshlets", primitive.m_SceneIndex);
+                meshletsBuilt[i] = meshes::BuildPrimitiveMeshlets(
+                    primitive, pBufferData, bufferByteSize,
+                    m_Settings.m_MeshletMaxVertexCount, m_Settings.m_MeshletMaxTriangleCount,
+                    meshletSets[i]) ? 1 : 0;
+            }
+
+            if (lodLevelCount > 0)
+            {
+                profiling::ScopedZone lodZone("BuildLods", primitive.m_SceneIndex);
+                meshes::BuildPrimitiveLods(
+                    primitive, pBufferData, bufferByteSize,
+                    lodTriangleRatios, lodMaxErrors, lodLevelCount, m_Settings.m_VertexCacheSize,
+                    lodLevels[i]);
+            }
+        },
+        [&](uint32_t i)
+        {
+            if (optimized[i])
+            {
+                m_Stats.m_OptimizedPrimitiveCount++;
+                m_Stats.m_OptimizedTriangleCount += statsBefore[i].m_TriangleCount;
+                m_Stats.m_OptimizedVertexCount += statsBefore[i].m_VertexCount;
+                m_Stats.m_VertexCacheMissCountBefore += statsBefore[i].m_CacheMissCount;
+                m_Stats.m_VertexCacheMissCountAfter += statsAfter[i].m_CacheMissCount;
             }
 
-            str_smart_ptr bufferPaths = ThreadHeapAllocator::Allocate(s_MaxRscFilePathLen * bufferCount);
-            str_smart_ptr destFilePath = salvation::filesystem::AppendPaths(pDestRootPath, s_pBuffersBinFileName);
+            meshes::MeshletSet &meshlets = meshletSets[i];
 
-            FILE *pDestFile = nullptr;
-            if (fopen_s(&pDestFile, destFilePath, "wb") != 0)
+            if (meshletsBuilt[i] && !meshlets.m_Meshlets.empty())
             {
-                return false;
+                MeshletRange range {};
+                range.m_MeshIndex = pPrimitives[i].m_MeshIndex;
+                range.m_PrimitiveIndex = pPrimitives[i].m_PrimitiveIndex;
+                range.m_BufferIndex = pPrimitives[i].m_BufferIndex;
+                range.m_MeshletCount = static_cast<uint32_t>(meshlets.m_Meshlets.size());
+                range.m_VertexIndexCount = static_cast<uint32_t>(meshlets.m_VertexIndices.size());
+                range.m_TriangleByteSize = static_cast<uint32_t>(meshlets.m_Triangles.size());
+
+                range.m_MeshletByteOffset = appendGeneratedData(meshlets.m_Meshlets.data(), meshlets.m_Meshlets.size() * sizeof(meshes::Meshlet));
+                range.m_VertexIndexByteOffset = appendGeneratedData(meshlets.m_VertexIndices.data(), meshlets.m_VertexIndices.size() * sizeof(uint32_t));
+                range.m_TriangleByteOffset = appendGeneratedData(meshlets.m_Triangles.data(), meshlets.m_Triangles.size());
+
+                m_MeshletRanges.push_back(range);
+                m_Stats.m_MeshletPrimitiveCount++;
+                m_Stats.m_MeshletCount += range.m_MeshletCount;
             }
 
-            bool writeSucceeded = true;
-            int64_t currentByteOffset = 0;
+            // Released as soon as packed, the set of every primitive of a large buffer can get big
+            meshlets = {};
 
-            for (SizeType i = 0; i < bufferCount && writeSucceeded; ++i)
+            // Levels are stored with 16 bits indices whenever the primitive's vertices allow it
+            bool narrowLods = pPrimitives[i].m_Positions.m_Count <= 0xffff;
+            std::vector<uint16_t> narrowedLodIndices;
+
+            for (meshes::LodLevel &lod : lodLevels[i])
             {
-                Value &buffer = buffers[i];
-                if (buffer.HasMember(s_pUriProperty) && buffer[s_pUriProperty].IsString())
+                LodRange range {};
+                range.m_MeshIndex = pPrimitives[i].m_MeshIndex;
+                range.m_PrimitiveIndex = pPrimitives[i].m_PrimitiveIndex;
+                range.m_BufferIndex = pPrimitives[i].m_BufferIndex;
+                range.m_Level = lod.m_Level;
+                range.m_IndexCount = static_cast<uint32_t>(lod.m_Indices.size());
+                range.m_Error = lod.m_Error;
+
+                if (narrowLods)
+                {
+                    narrowedLodIndices.assign(lod.m_Indices.begin(), lod.m_Indices.end());
+                    range.m_IndexByteSize = sizeof(uint16_t);
+                    range.m_ByteOffset = appendGeneratedData(narrowedLodIndices.data(), narrowedLodIndices.size() * sizeof(uint16_t));
+                }
+                else
                 {
-                    Value &uri = buffer[s_pUriProperty];
-                    const char *pBufferUri = uri.GetString();
+                    range.m_IndexByteSize = sizeof(uint32_t);
+                    range.m_ByteOffset = appendGeneratedData(lod.m_Indices.data(), lod.m_Indices.size() * sizeof(uint32_t));
+                }
 
-                    size_t fileSize = 0;
-                    str_smart_ptr pSrcFilePath = salvation::filesystem::AppendPaths(pSrcRootPath, pBufferUri);
-                    uint8_t *pData = ReadFileContent(pSrcFilePath, fileSize);
+                m_LodRanges.push_back(range);
+                m_Stats.m_LodLevelCount++;
+                m_Stats.m_LodTriangleCount += range.m_IndexCount / 3;
+            }
 
-                    writeSucceeded =
-                        fileSize > 0 &&
-                        fwrite(pData, sizeof(uint8_t), fileSize, pDestFile) == fileSize &&
-                        InsertBufferDataEntry(static_cast<int64_t>(fileSize), currentByteOffset, packedDataId);
+            if (!lodLevels[i].empty())
+            {
+                m_Stats.m_LodPrimitiveCount++;
+            }
 
-                    currentByteOffset += static_cast<int64_t>(fileSize);
-                }
+            lodLevels[i] = {};
+
+            return true;
+        });
+
+    // Streams are quantized once the primitives are done reordering their vertices.
+    // They never share bytes either, see CollectVertexStreams.
+    const meshes::VertexStream *pStreams = job.m_pStreams;
+    std::vector<meshes::QuantizedStream> encodings(job.m_StreamCount);
+    std::vector<uint8_t> quantized(job.m_StreamCount, 0);
+
+    threading::OrderedParallelFor(static_cast<uint32_t>(job.m_StreamCount), workerCount, workerCount * 2,
+        [&](uint32_t i)
+        {
+            profiling::ScopedZone streamZone("QuantizeStream", pStreams[i].m_View.m_AccessorIndex);
+            quantized[i] = meshes::QuantizeVertexStream(
+                pStreams[i], bufferCopy.data(), bufferCopy.size(), m_Settings.m_OctahedralBits, encodings[i]) ? 1 : 0;
+        },
+        [&](uint32_t i)
+        {
+            if (quantized[i])
+            {
+                const meshes::AccessorView &view = pStreams[i].m_View;
+
+                m_StreamEncodings[view.m_AccessorIndex] = encodings[i];
+                m_Stats.m_QuantizedStreamCount++;
+                m_Stats.m_QuantizedByteSizeBefore += view.m_Count * view.m_ElementByteSize;
+                m_Stats.m_QuantizedByteSizeAfter += view.m_Count * encodings[i].m_ElementByteSize;
             }
 
-            fclose(pDestFile);
+            return true;
+        });
+
+    // Indices are narrowed last, once the primitives are done reordering them
+    for (size_t i = 0; i < job.m_IndicesCount; ++i)
+    {
+        const meshes::AccessorView &indices = job.m_pIndices[i];
+
+        if (meshes::NarrowIndexStream(indices, bufferCopy.data(), bufferCopy.size()))
+        {
+            m_NarrowedIndices[indices.m_AccessorIndex] = 1;
+            m_Stats.m_NarrowedIndexBufferCount++;
+            m_Stats.m_NarrowedIndexCount += indices.m_Count;
+        }
+    }
+
+    // Streams are laid out once their elements are final, moved streams go to the generated data
+    std::vector<int32_t> relocatedAccessors;
+
+    auto streamSource = [&](const meshes::AccessorView &view)
+    {
+        meshes::StreamSource source { view.m_AccessorIndex, view.m_ByteOffset, view.m_Count, view.m_ElementByteSize, view.m_ByteStride };
+        const meshes::QuantizedStream &encoding = m_StreamEncodings[view.m_AccessorIndex];
+
+        if (encoding.m_Encoding != meshes::VertexEncoding::Raw)
+        {
+            source.m_ElementByteSize = encoding.m_ElementByteSize;
+            source.m_ByteStride = encoding.m_ElementByteSize;
+        }
+
+        return source;
+    };
+
+    auto fitsInBuffer = [&](const meshes::AccessorView &view)
+    {
+        return view.m_ByteOffset >= 0 && view.m_ByteOffset + view.ByteSpan() <= static_cast<int64_t>(bufferByteSize);
+    };
+
+    if (m_Settings.m_VertexLayout == VertexLayout::Deinterleaved)
+    {
+        profiling::ScopedZone layoutZone("DeinterleaveStreams", job.m_BufferIndex);
+        std::vector<uint8_t> streamData;
 
-            if (writeSucceeded && !UpdatePackagedDataEntry(packedDataId, currentByteOffset))
+        for (size_t i = 0; i < job.m_InterleavedCount; ++i)
+        {
+            const meshes::AccessorView &view = job.m_pInterleaved[i];
+            if (!fitsInBuffer(view))
             {
-                return false;
+                continue;
             }
 
-            return writeSucceeded;
+            meshes::StreamSource source = streamSource(view);
+            meshes::DeinterleaveStream(source, pBufferData, streamData);
+
+            StreamRelocation &relocation = m_StreamRelocations[view.m_AccessorIndex];
+            relocation.m_ByteOffset = appendGeneratedData(streamData.data(), streamData.size());
+            relocation.m_ByteStride = source.m_ElementByteSize;
+
+            relocatedAccessors.push_back(view.m_AccessorIndex);
+            m_Stats.m_DeinterleavedStreamCount++;
         }
     }
+    else if (m_Settings.m_VertexLayout == VertexLayout::Interleaved)
+    {
+        profiling::ScopedZone layoutZone("InterleaveStreams", job.m_BufferIndex);
+        std::vector<meshes::StreamSource> sources;
+        std::vector<int32_t> attributeByteOffsets;
+        std::vector<uint8_t> vertexData;
 
-    return true;
-}
+        for (size_t i = 0; i < primitiveCount; ++i)
+        {
+            const meshes::MeshPrimitive &primitive = pPrimitives[i];
 
-bool AssetDatabaseBuilder::InsertMaterialMetadata(Document &json)
-{
-    static constexpr const char s_pMaterialsProperty[] = "materials";
-    static constexpr const char s_pPBRProperty[] = "pbrMetallicRoughness";
-    static constexpr const char s_pBaseTextureProperty[] = "baseColorTexture";
-    static constexpr const char s_pIndexProperty[] = "index";
+            // Streams read by other primitives can only live at one place
+            bool canInterleave = primitive.m_CanReorderVertices && primitive.m_VertexStreams.size() > 1;
+            for (const meshes::AccessorView &view : primitive.m_VertexStreams)
+            {
+                canInterleave = canInterleave && fitsInBuffer(view);
+            }
+
+            if (!canInterleave)
+            {
+                continue;
+            }
+
+            sources.clear();
+            for (const meshes::AccessorView &view : primitive.m_VertexStreams)
+            {
+                sources.push_back(streamSource(view));
+            }
+
+            int32_t vertexStride = meshes::InterleaveStreams(sources.data(), sources.size(), pBufferData, attributeByteOffsets, vertexData);
+            int64_t vertexByteOffset = appendGeneratedData(vertexData.data(), vertexData.size());
+
+            for (size_t stream = 0; stream < sources.size(); ++stream)
+            {
+                StreamRelocation &relocation = m_StreamRelocations[sources[stream].m_AccessorIndex];
+                relocation.m_ByteOffset = vertexByteOffset + attributeByteOffsets[stream];
+                relocation.m_ByteStride = vertexStride;
+
+                relocatedAccessors.push_back(sources[stream].m_AccessorIndex);
+            }
+
+            m_Stats.m_InterleavedPrimitiveCount++;
+        }
+    }
 
-    if (json.HasMember(s_pMaterialsProperty) && json[s_pMaterialsProperty].IsArray())
+    // Stripped last, so that the streams shrunk by quantization and narrowing only keep their new size
+    // and the streams moved by the layout stage are left out
+    std::vector<uint8_t> packedData;
+
+    if (m_Settings.m_StripUnreferencedBufferData)
     {
-        Value &materials = json[s_pMaterialsProperty];
-        SizeType materialCount = materials.Size();
+        profiling::ScopedZone stripZone("StripBuffer", job.m_BufferIndex);
+        std::vector<meshes::ReferencedRange> ranges(job.m_pRanges, job.m_pRanges + job.m_RangeCount);
+
+        // Rewritten streams start where they used to and are tightly packed
+        std::vector<int64_t> shrunkByteSizes(m_StreamEncodings.size(), -1);
 
-        for (SizeType i = 0; i < materialCount; ++i)
+        for (size_t i = 0; i < job.m_StreamCount; ++i)
         {
-            Value &material = materials[i];
-            if (material.HasMember(s_pPBRProperty) && material[s_pPBRProperty].IsObject())
+            const meshes::AccessorView &view = job.m_pStreams[i].m_View;
+            const meshes::QuantizedStream &encoding = m_StreamEncodings[view.m_AccessorIndex];
+
+            if (encoding.m_Encoding != meshes::VertexEncoding::Raw)
             {
-                Value &pbr = material[s_pPBRProperty];
-                if (pbr.HasMember(s_pBaseTextureProperty) && pbr[s_pBaseTextureProperty].IsObject())
-                {
-                    Value &baseTexture = pbr[s_pBaseTextureProperty];
-                    if (baseTexture.HasMember(s_pIndexProperty) && baseTexture[s_pIndexProperty].IsInt())
-                    {
-                        Value &indexProperty = baseTexture[s_pIndexProperty];
-                        int index = indexProperty.GetInt() + 1; // +1 since sqlite integer primary keys start at 1
+                shrunkByteSizes[view.m_AccessorIndex] = view.m_Count * encoding.m_ElementByteSize;
+            }
+        }
 
-                        if (!InsertMaterialDataEntry(index))
-                        {
-                            return false;
-                        }
-                    }
-                }
+        for (size_t i = 0; i < job.m_IndicesCount; ++i)
+        {
+            const meshes::AccessorView &view = job.m_pIndices[i];
+
+            if (m_NarrowedIndices[view.m_AccessorIndex])
+            {
+                shrunkByteSizes[view.m_AccessorIndex] = view.m_Count * static_cast<int64_t>(sizeof(uint16_t));
+            }
+        }
+
+        for (meshes::ReferencedRange &range : ranges)
+        {
+            if (range.m_AccessorIndex >= 0 && shrunkByteSizes[range.m_AccessorIndex] >= 0)
+            {
+                range.m_ByteSize = shrunkByteSizes[range.m_AccessorIndex];
             }
         }
+
+        ranges.erase(
+            std::remove_if(ranges.begin(), ranges.end(), [&](const meshes::ReferencedRange &range)
+            {
+                return range.m_AccessorIndex >= 0 && m_StreamRelocations[range.m_AccessorIndex].m_ByteOffset >= 0;
+            }),
+            ranges.end());
+
+        std::vector<meshes::BufferSegment> &segments = m_BufferSegments[job.m_BufferIndex];
+        int64_t packedByteSize = meshes::BuildBufferSegments(
+            ranges.data(), ranges.size(), static_cast<int64_t>(bufferByteSize), s_GeneratedDataAlignment, segments);
+
+        meshes::PackBufferSegments(pBufferData, segments, packedByteSize, packedData);
+
+        m_Stats.m_StrippedBufferByteSize += bufferByteSize - packedData.size();
+        pBufferData = packedData.data();
+        bufferByteSize = packedData.size();
     }
 
-    return true;
-}
+    size_t generatedDataOffset = (bufferByteSize + s_GeneratedDataAlignment - 1) & ~(s_GeneratedDataAlignment - 1);
 
-ComponentType AssetDatabaseBuilder::GetComponentType(const char *pGLTFType, int glTFComponentType)
-{
-    static constexpr uint32_t s_glTFByteCode = 5120;
-    static constexpr uint32_t s_glTFUnsignedByteCode = 5121;
-    static constexpr uint32_t s_glTFShortCode = 5122;
-    static constexpr uint32_t s_glTFUnsignedShortCode = 5123;
-    static constexpr uint32_t s_glTUnsignedIntCode = 5125;
-    static constexpr uint32_t s_glTFFloatCode = 5126;
+    for (size_t i = meshletRangesBegin; i < m_MeshletRanges.size(); ++i)
+    {
+        MeshletRange &range = m_MeshletRanges[i];
+        range.m_MeshletByteOffset += generatedDataOffset;
+        range.m_VertexIndexByteOffset += generatedDataOffset;
+        range.m_TriangleByteOffset += generatedDataOffset;
+    }
 
-    static constexpr const char *s_pGLTFVectorTypes[] =
+    for (size_t i = lodRangesBegin; i < m_LodRanges.size(); ++i)
     {
-        "VEC2",
-        "VEC3",
-        "VEC4",
-        "MAT2",
-        "MAT3",
-        "MAT4"
-    };
+        m_LodRanges[i].m_ByteOffset += generatedDataOffset;
+    }
 
-    static constexpr ComponentType s_VectorTypes[] =
+    for (int32_t accessorIndex : relocatedAccessors)
     {
-        ComponentType::Vec2,
-        ComponentType::Vec3,
-        ComponentType::Vec4,
-        ComponentType::Matrix2x2,
-        ComponentType::Matrix3x3,
-        ComponentType::Matrix4x4
-    };
+        m_StreamRelocations[accessorIndex].m_ByteOffset += generatedDataOffset;
+    }
 
-    if (strcmp(pGLTFType, "SCALAR") == 0)
+    if (!writer.Write(pBufferData, bufferByteSize))
     {
-        switch (glTFComponentType)
-        {
-        case s_glTFByteCode:
-        case s_glTFUnsignedByteCode:
-            return ComponentType::Scalar_Byte;
-        case s_glTFShortCode:
-        case s_glTFUnsignedShortCode:
-            return ComponentType::Scalar_Short;
-        case s_glTUnsignedIntCode:
-            return ComponentType::Scalar_Int;
-        case s_glTFFloatCode:
-            return ComponentType::Scalar_Float;
-        default:
-            return ComponentType::Unknown;
-        }
+        return -1;
+    }
+
+    if (generatedData.empty())
+    {
+        return static_cast<int64_t>(bufferByteSize);
+    }
+
+    static constexpr uint8_t s_Padding[s_GeneratedDataAlignment] = {};
+    size_t paddingByteSize = generatedDataOffset - bufferByteSize;
+
+    if (
+        !writer.Write(s_Padding, paddingByteSize) ||
+        !writer.Write(generatedData.data(), generatedData.size()))
+    {
+        return -1;
     }
 
-    for (size_t i = 0; i < ARRAY_SIZE(s_pGLTFVectorTypes); ++i)
+    return static_cast<int64_t>(generatedDataOffset + generatedData.size());
+}
+
+bool AssetDatabaseBuilder::InsertMaterialMetadata(const gltf::Scene &scene)
+{
+    for (const gltf::Material &material : scene.m_Materials)
     {
-        if (strcmp(pGLTFType, s_pGLTFVectorTypes[i]) == 0)
+        int32_t baseTextureIndex = material.m_Textures[static_cast<uint32_t>(textures::TextureUsage::BaseColor)];
+
+        // +1 since sqlite integer primary keys start at 1
+        if (baseTextureIndex != gltf::s_InvalidIndex && !InsertMaterialDataEntry(baseTextureIndex + 1))
         {
-            return s_VectorTypes[i];
+            return false;
         }
     }
 
-    return ComponentType::Unknown;
+    return true;
 }
 
-bool AssetDatabaseBuilder::InsertBufferViewMetadata(Document &json)
+bool AssetDatabaseBuilder::InsertBufferViewMetadata(const gltf::Scene &scene)
 {
-    static constexpr const char s_pAccessorsProperty[] = "accessors";
-    static constexpr const char s_pBufferViewsProperty[] = "bufferViews";
-    static constexpr const char s_pBufferViewProperty[] = "bufferView";
-    static constexpr const char s_pByteOffsetProperty[] = "byteOffset";
-    static constexpr const char s_pComponentTypeProperty[] = "componentType";
-    static constexpr const char s_pTypeProperty[] = "type";
-    static constexpr const char s_pCountProperty[] = "count";
-    static constexpr const char s_pBufferProperty[] = "buffer";
+    // Accessors a primitive reads were all kept by the strip stage, losing one means the data is unusable
+    std::vector<uint8_t> referenced;
+    if (m_Settings.m_StripUnreferencedBufferData)
+    {
+        meshes::FindReferencedAccessors(scene, referenced);
+    }
 
-    if (
-        json.HasMember(s_pAccessorsProperty) && json[s_pAccessorsProperty].IsArray() &&
-        json.HasMember(s_pBufferViewsProperty) && json[s_pBufferViewsProperty].IsArray())
+    for (size_t i = 0; i < scene.m_Accessors.size(); ++i)
     {
-        Value &bufferViews = json[s_pBufferViewsProperty];
-        Value &accessors = json[s_pAccessorsProperty];
-        SizeType accessorCount = accessors.Size();
+        const gltf::Accessor &accessor = scene.m_Accessors[i];
 
-        for (SizeType i = 0; i < accessorCount; ++i)
+        if (accessor.m_BufferView == gltf::s_InvalidIndex || accessor.m_Count < 0)
         {
-            Value &accessor = accessors[i];
-            if (accessor.HasMember(s_pBufferViewProperty) && accessor[s_pBufferViewProperty].IsInt())
-            {
-                int bufferViewIndex = accessor[s_pBufferViewProperty].GetInt();
-                Value &bufferView = bufferViews[bufferViewIndex];
+            continue;
+        }
 
-                if (
-                    accessor.HasMember(s_pTypeProperty) && accessor[s_pTypeProperty].IsString() &&
-                    accessor.HasMember(s_pCountProperty) && accessor[s_pCountProperty].IsInt() &&
-                    accessor.HasMember(s_pComponentTypeProperty) && accessor[s_pComponentTypeProperty].IsInt() &&
-                    bufferView.HasMember(s_pBufferProperty) && bufferView[s_pBufferProperty].IsInt())
-                {
-                    int64_t bufferId = bufferView[s_pBufferProperty].GetInt() + 1; // +1 since sqlite integer primary keys start at 1
+        const gltf::BufferView &bufferView = scene.m_BufferViews[accessor.m_BufferView];
+        int32_t elementByteSize = gltf::ComponentByteSize(accessor.m_ComponentType) * gltf::ComponentCount(accessor.m_Type);
 
-                    const char *pType = accessor[s_pTypeProperty].GetString();
-                    int glTFComponentType = accessor[s_pComponentTypeProperty].GetInt();
-                    int count = accessor[s_pCountProperty].GetInt();
+        if (bufferView.m_Buffer == gltf::s_InvalidIndex || elementByteSize <= 0)
+        {
+            continue;
+        }
 
-                    ComponentType componentType = GetComponentType(pType, glTFComponentType);
-                    int32_t stride = AssetDatabase::ComponentTypeByteSize(componentType);
-                    int64_t byteSize = stride * static_cast<int64_t>(count);
+        int64_t bufferId = bufferView.m_Buffer + 1; // +1 since sqlite integer primary keys start at 1
+        int64_t count = accessor.m_Count;
+        int64_t byteOffset = accessor.m_ByteOffset + bufferView.m_ByteOffset;
 
-                    int64_t accessorByteOffset = 0;
-                    int64_t bufferViewByteOffset = 0;
+        // Interleaved streams are described by the stride of their bufferView
+        int32_t stride = bufferView.m_ByteStride > 0 ? bufferView.m_ByteStride : elementByteSize;
 
-                    if (accessor.HasMember(s_pByteOffsetProperty) && accessor[s_pByteOffsetProperty].IsInt())
-                    {
-                        accessorByteOffset = accessor[s_pByteOffsetProperty].GetInt();
-                    }
+        // Same layout the strip stage kept the accessor's bytes with, sparse and inconsistent accessors excepted
+        meshes::AccessorView view {};
+        if (meshes::ReadAccessorView(scene, static_cast<int>(i), view))
+        {
+            elementByteSize = view.m_ElementByteSize;
+            stride = view.m_ByteStride;
+        }
 
-                    if (bufferView.HasMember(s_pByteOffsetProperty) && bufferView[s_pByteOffsetProperty].IsInt())
-                    {
-                        bufferViewByteOffset = bufferView[s_pByteOffsetProperty].GetInt();
-                    }
+        // Narrowed indices and quantized streams were packed tightly with their new element size
+        const meshes::QuantizedStream *pEncoding =
+            i < m_StreamEncodings.size() && m_StreamEncodings[i].m_Encoding != meshes::VertexEncoding::Raw ? &m_StreamEncodings[i] : nullptr;
 
-                    int64_t byteOffset = accessorByteOffset + bufferViewByteOffset;
+        if (i < m_NarrowedIndices.size() && m_NarrowedIndices[i])
+        {
+            elementByteSize = sizeof(uint16_t);
+            stride = elementByteSize;
+        }
+        else if (pEncoding)
+        {
+            elementByteSize = pEncoding->m_ElementByteSize;
+            stride = pEncoding->m_ElementByteSize;
+        }
 
-                    if (!InsertBufferViewDataEntry(bufferId, byteSize, byteOffset, stride))
-                    {
-                        return false;
-                    }
-                }
+        const StreamRelocation *pRelocation =
+            i < m_StreamRelocations.size() && m_StreamRelocations[i].m_ByteOffset >= 0 ? &m_StreamRelocations[i] : nullptr;
+
+        if (pRelocation)
+        {
+            byteOffset = pRelocation->m_ByteOffset;
+            stride = pRelocation->m_ByteStride;
+        }
+
+        int64_t byteSize = count > 0 ? stride * (count - 1) + elementByteSize : 0;
+        size_t bufferIndex = static_cast<size_t>(bufferId - 1);
+
+        // Accessors that were not packed keep their row, so IDs still map to glTF indices, but point to no data
+        if (!pRelocation && m_Settings.m_StripUnreferencedBufferData && bufferIndex < m_BufferSegments.size())
+        {
+            const std::vector<meshes::BufferSegment> &segments = m_BufferSegments[bufferIndex];
+            int64_t packedByteOffset = meshes::RemapBufferOffset(segments, byteOffset);
+            int64_t packedLastByteOffset = byteSize > 0 ? meshes::RemapBufferOffset(segments, byteOffset + byteSize - 1) : packedByteOffset;
+
+            bool packed = packedByteOffset >= 0 && packedLastByteOffset == packedByteOffset + std::max<int64_t>(byteSize - 1, 0);
+
+            if (!packed && referenced[i])
+            {
+                return false;
             }
+
+            byteOffset = packed ? packedByteOffset : 0;
+            byteSize = packed ? byteSize : 0;
         }
-    }
 
+        int64_t bufferViewId = InsertBufferViewDataEntry(bufferId, byteSize, byteOffset, stride);
+
+        if (bufferViewId < 0 || (pEncoding && !InsertBufferViewEncodingDataEntry(bufferViewId, *pEncoding)))
+        {
+            return false;
+        }
+    }
 
     return true;
 }
 
-bool AssetDatabaseBuilder::InsertMeshMetadata(Document &json)
+// Entries generated for a primitive, in a vector sorted with Precedes
+template<typename Range>
+static std::pair<typename std::vector<Range>::const_iterator, typename std::vector<Range>::const_iterator> FindPrimitiveRanges(
+    const std::vector<Range> &ranges, int32_t meshIndex, int32_t primitiveIndex)
 {
-    static constexpr const char s_pMeshesProperty[] = "meshes";
-    static constexpr const char s_pPrimitivesProperty[] = "primitives";
-    static constexpr const char s_pIndicesProperty[] = "indices";
-    static constexpr const char s_pMaterialProperty[] = "material";
-    static constexpr const char s_pAttributesProperty[] = "attributes";
+    Range key {};
+    key.m_MeshIndex = meshIndex;
+    key.m_PrimitiveIndex = primitiveIndex;
 
-    if (json.HasMember(s_pMeshesProperty) && json[s_pMeshesProperty].IsArray())
+    return std::equal_range(ranges.begin(), ranges.end(), key, [](const Range &a, const Range &b)
     {
-        Value &meshes = json[s_pMeshesProperty];
-        SizeType meshCount = meshes.Size();
+        return a.Precedes(b);
+    });
+}
 
-        for (SizeType meshIndex = 0; meshIndex < meshCount; ++meshIndex)
-        {
-            Value &mesh = meshes[meshIndex];
+bool AssetDatabaseBuilder::InsertMeshMetadata(const gltf::Scene &scene)
+{
+    for (size_t i = 0; i < scene.m_Primitives.size(); ++i)
+    {
+        const gltf::Primitive &primitive = scene.m_Primitives[i];
+        profiling::ScopedZone primitiveZone("InsertSubMesh", i);
 
-            if (mesh.HasMember(s_pPrimitivesProperty) && mesh[s_pPrimitivesProperty].IsArray())
-            {
-                Value &primitives = mesh[s_pPrimitivesProperty];
-                SizeType primCount = primitives.Size();
+        if (
+            primitive.m_Indices == gltf::s_InvalidIndex ||
+            primitive.m_Material == gltf::s_InvalidIndex ||
+            primitive.m_AttributeCount == 0)
+        {
+            continue;
+        }
 
-                for (SizeType primIndex = 0; primIndex < primCount; ++primIndex)
-                {
-                    Value &primitive = primitives[primIndex];
+        // +1 since sqlite integer primary keys start at 1
+        int64_t indexBufferId = primitive.m_Indices + 1;
+        int64_t materialId = primitive.m_Material + 1;
 
-                    if (
-                        primitive.HasMember(s_pIndicesProperty) && primitive[s_pIndicesProperty].IsInt() &&
-                        primitive.HasMember(s_pMaterialProperty) && primitive[s_pMaterialProperty].IsInt() &&
-                        primitive.HasMember(s_pAttributesProperty) && primitive[s_pAttributesProperty].IsObject())
-                    {
-                        // +1 since sqlite integer primary keys start at 1
-                        int64_t indexBufferId = primitive[s_pIndicesProperty].GetInt() + 1;
-                        int64_t materialId = primitive[s_pMaterialProperty].GetInt() + 1;
+        int64_t meshId = InsertMeshDataEntry("Default Name");
+        int64_t subMeshId = InsertSubMeshDataEntry(meshId, indexBufferId, materialId);
 
-                        int64_t meshId = InsertMeshDataEntry("Default Name");
-                        int64_t subMeshId = InsertSubMeshDataEntry(meshId, indexBufferId, materialId);
+        if (meshId < 0 || subMeshId < 0 || !InsertVertexStreamsMetadata(scene, primitive, subMeshId))
+        {
+            return false;
+        }
 
-                        Value &attributes = primitive[s_pAttributesProperty];
+        auto meshlets = FindPrimitiveRanges(m_MeshletRanges, primitive.m_Mesh, primitive.m_IndexInMesh);
+        for (auto rangeIt = meshlets.first; rangeIt != meshlets.second; ++rangeIt)
+        {
+            if (!InsertMeshletDataEntry(subMeshId, *rangeIt))
+            {
+                return false;
+            }
+        }
 
-                        if (meshId < 0 || subMeshId < 0 || !InsertVertexStreamsMetadata(attributes, subMeshId))
-                        {
-                            return false;
-                        }
-                    }
-                }
+        auto lods = FindPrimitiveRanges(m_LodRanges, primitive.m_Mesh, primitive.m_IndexInMesh);
+        for (auto rangeIt = lods.first; rangeIt != lods.second; ++rangeIt)
+        {
+            if (!InsertSubMeshLODDataEntry(subMeshId, *rangeIt))
+            {
+                return false;
             }
         }
     }
@@ -770,64 +2558,212 @@ bool AssetDatabaseBuilder::InsertMeshMetadata(Document &json)
     return true;
 }
 
-bool AssetDatabaseBuilder::InsertVertexStreamsMetadata(Value &attributes, int64_t subMeshId)
+bool AssetDatabaseBuilder::InsertVertexStreamsMetadata(const gltf::Scene &scene, const gltf::Primitive &primitive, int64_t subMeshId)
 {
-    static constexpr const char *s_ppAttributeSemantics[] =
+    struct StreamAttribute
     {
-        "POSITION",
-        "NORMAL",
-        "TANGENT",
-        "TEXCOORD_0",
-        "TEXCOORD_1",
-        "COLOR_0"
+        gltf::AttributeSemantic     m_Semantic;
+        uint8_t                     m_Set;
     };
 
-    static_assert(ARRAY_SIZE(s_ppAttributeSemantics) == static_cast<size_t>(AttributeSemantic::Count));
+    // Indexed by AttributeSemantic
+    static constexpr StreamAttribute s_StreamAttributes[] =
+    {
+        { gltf::AttributeSemantic::Position, 0 },
+        { gltf::AttributeSemantic::Normal, 0 },
+        { gltf::AttributeSemantic::Tangent, 0 },
+        { gltf::AttributeSemantic::TexCoord, 0 },
+        { gltf::AttributeSemantic::TexCoord, 1 },
+        { gltf::AttributeSemantic::Color, 0 }
+    };
 
-    for (size_t i = 0; i < ARRAY_SIZE(s_ppAttributeSemantics); ++i)
+    static_assert(ARRAY_SIZE(s_StreamAttributes) == static_cast<size_t>(AttributeSemantic::Count));
+
+    for (size_t i = 0; i < ARRAY_SIZE(s_StreamAttributes); ++i)
     {
-        const char *pAttributeSemantic = s_ppAttributeSemantics[i];
-        if (attributes.HasMember(pAttributeSemantic) && attributes[pAttributeSemantic].IsInt())
+        const StreamAttribute &streamAttribute = s_StreamAttributes[i];
+
+        for (const gltf::Attribute *pAttribute = scene.AttributesBegin(primitive); pAttribute != scene.AttributesEnd(primitive); ++pAttribute)
         {
-            int bufferViewId = attributes[pAttributeSemantic].GetInt() + 1; // +1 since sqlite integer primary keys start at 1
-            if (!InsertVertexStreamDataEntry(subMeshId, bufferViewId, static_cast<int32_t>(i)))
+            if (pAttribute->m_Semantic != streamAttribute.m_Semantic || pAttribute->m_Set != streamAttribute.m_Set)
             {
-                return false;
+                continue;
+            }
+
+            if (pAttribute->m_Accessor != gltf::s_InvalidIndex)
+            {
+                int bufferViewId = pAttribute->m_Accessor + 1; // +1 since sqlite integer primary keys start at 1
+                if (!InsertVertexStreamDataEntry(subMeshId, bufferViewId, static_cast<int32_t>(i)))
+                {
+                    return false;
+                }
             }
+
+            break;
         }
     }
 
     return true;
 }
 
-bool AssetDatabaseBuilder::InsertMetadata(Document &json)
+bool AssetDatabaseBuilder::InsertMetadata(const gltf::Scene &scene)
+{
+    profiling::ScopedZone zone("InsertMetadata", -1, &m_Stats.m_InsertMetadataSeconds);
+
+    // Metadata only depends on the glTF content, rows of unchanged resources keep their IDs
+    if (!m_FullRebuild && !m_SceneSource.m_Changed)
+    {
+        return true;
+    }
+
+    uint64_t firstRowCount = m_InsertedRowCount;
+
+    bool success =
+        (m_FullRebuild || ClearMetadataTables()) &&
+        InsertMaterialMetadata(scene) &&
+        InsertBufferViewMetadata(scene) && 
+        InsertMeshMetadata(scene);
+
+    m_Stats.m_MetadataRowCount = m_InsertedRowCount - firstRowCount;
+
+    return success;
+}
+
+bool AssetDatabaseBuilder::InsertSourceMetadata()
 {
-    return 
-        InsertMaterialMetadata(json) &&
-        InsertBufferViewMetadata(json) && 
-        InsertMeshMetadata(json);
+    if (!m_Settings.m_Incremental)
+    {
+        return true;
+    }
+
+    bool success = InsertSourceFileDataEntry(SourceKind::Scene, 0, m_SceneSource);
+
+    for (size_t i = 0; success && i < m_ImageSources.size(); ++i)
+    {
+        SourceRecord &source = m_ImageSources[i];
+        success =
+            (source.m_Path.empty() || HashSource(source)) &&
+            InsertSourceFileDataEntry(SourceKind::Image, static_cast<int64_t>(i), source);
+    }
+
+    for (size_t i = 0; success && i < m_BufferSources.size(); ++i)
+    {
+        SourceRecord &source = m_BufferSources[i];
+        success =
+            (source.m_Path.empty() || HashSource(source)) &&
+            InsertSourceFileDataEntry(SourceKind::Buffer, static_cast<int64_t>(i), source);
+    }
+
+    return success;
 }
 
 bool AssetDatabaseBuilder::BuildDatabase(const char *pSrcPath, const char *pDstPath)
 {
+    // Values and members of glTF documents parsed in-situ take 2 to 3 times the size of the text
+    static constexpr size_t s_JsonPoolByteSizeRatio = 3;
+
+    m_Stats = {};
+    profiling::ScopedZone zone("BuildDatabase", -1, &m_Stats.m_TotalSeconds);
+
     bool success = false;
 
-    if (CreateDatabase(pDstPath))
+    // Batches committed before a failure cannot be rolled back. Batched builds write to a copy of the database,
+    // which replaces it once the last transaction is committed, so a failure leaves the previous database intact.
+    std::string buildPath = pDstPath;
+    bool buildToCopy = m_Settings.m_TransactionBatchSize > 0;
+    bool copied = true;
+
+    if (buildToCopy)
     {
-        size_t jsonContentSize;
-        char *pJsonContent = reinterpret_cast<char*>(ReadFileContent(pSrcPath, jsonContentSize));
+        buildPath += ".tmp";
 
-        if (pJsonContent)
+        // Incremental builds read the previous sources from the database, the copy starts from its content
+        std::error_code error;
+        fs::remove(buildPath, error);
+
+        if (fs::exists(pDstPath, error))
+        {
+            fs::copy_file(pDstPath, buildPath, error);
+            copied = !error;
+        }
+    }
+
+    if (copied && CreateDatabase(buildPath.c_str()))
+    {
+        io::MappedFile jsonFile;
+
+        if (jsonFile.Open(pSrcPath))
         {
-            Document json;
-            json.Parse(pJsonContent);
+            m_Stats.m_JsonByteSize = jsonFile.Size();
+
+            m_SceneSource = {};
+            m_SceneSource.m_Path = pSrcPath;
+            io::ReadFileStamp(pSrcPath, m_SceneSource.m_Stamp);
 
-            ThreadHeapAllocator::Release(pJsonContent);
+            // The JSON of a GLB is its first chunk, read out of the mapping like the text of a .gltf
+            gltf::GlbChunks glbChunks {};
+            bool isGlb = gltf::IsGlb(jsonFile.Data(), jsonFile.Size());
+            bool parsed = !isGlb || gltf::ReadGlbChunks(jsonFile.Data(), jsonFile.Size(), glbChunks);
+
+            const uint8_t *pText = isGlb ? reinterpret_cast<const uint8_t*>(glbChunks.m_pJson) : jsonFile.Data();
+            size_t textByteSize = isGlb ? glbChunks.m_JsonByteSize : jsonFile.Size();
+
+            // Only the JSON is part of the scene hash. The BIN chunk of a GLB is hashed as the first buffer, so a
+            // change to its content only rebuilds the meshes reading it.
+            if (m_Settings.m_Incremental && parsed)
+            {
+                m_SceneSource.m_Hash = hashing::CombineHashes(
+                    hashing::Hash64(pText, textByteSize),
+                    HashMeshBuildSettings(m_Settings));
+                m_SceneSource.m_Hashed = true;
+            }
+
+            gltf::Scene scene;
+            {
+                profiling::ScopedZone parseZone("ParseJson", -1, &m_Stats.m_ParseJsonSeconds);
+
+                if (parsed && m_Settings.m_StreamJson)
+                {
+                    // Read in place from the mapping, the file is read once even when it was hashed above, and no
+                    // document is built
+                    parsed = io::ReadGltfSceneStream(reinterpret_cast<const char*>(pText), textByteSize, scene);
+                }
+                else if (parsed)
+                {
+                    // Strings of the document point into the arena's copy of the text, it is released after the document
+                    io::JsonArena jsonArena;
+                    Document json;
+
+                    parsed = jsonArena.Init(pText, textByteSize, textByteSize * s_JsonPoolByteSizeRatio);
+                    if (parsed)
+                    {
+                        // A partial document would be built as a scene missing resources, failing like the stream parse
+                        Document parsedJson(&jsonArena.Allocator());
+                        parsedJson.ParseInsitu(jsonArena.Text());
+                        parsed = !parsedJson.HasParseError();
+                        json.Swap(parsedJson);
+                    }
+
+                    // Stages only read the scene, the document and its arena are released before they run
+                    if (parsed)
+                    {
+                        gltf::BuildScene(json, scene);
+                    }
+
+                    m_Stats.m_JsonDomByteSize = json.GetAllocator().Size();
+                    m_Stats.m_JsonPeakByteSize = jsonArena.PeakByteSize();
+                }
+
+                scene.m_GlbBinByteOffset = glbChunks.m_BinByteOffset;
+                scene.m_GlbBinByteSize = glbChunks.m_BinByteSize;
+            }
+
+            jsonFile.Close();
 
             const char *pDstRootPathEnd = strrchr(pDstPath, '/');
             const char *pSrcRootPathEnd = strrchr(pSrcPath, '/');
 
-            if (pDstRootPathEnd && pSrcRootPathEnd)
+            if (parsed && pDstRootPathEnd && pSrcRootPathEnd)
             {
                 size_t dstRootFolderStrLen = 
                     static_cast<size_t>(reinterpret_cast<uintptr_t>(pDstRootPathEnd) - reinterpret_cast<uintptr_t>(pDstPath)) + 1;
@@ -846,14 +2782,36 @@ bool AssetDatabaseBuilder::BuildDatabase(const char *pSrcPath, const char *pDstP
                 success = 
                     CreateInsertStatements() && 
                     CreateUpdateStatements() &&
-                    BuildTextures(json, pSrcRootPath, pDstRootPath) &&
-                    BuildMeshes(json, pSrcRootPath, pDstRootPath) &&
-                    InsertMetadata(json);
+                    PrepareBuild(scene, pSrcRootPath, pDstRootPath) &&
+                    BuildTextures(scene, pSrcRootPath, pDstRootPath) &&
+                    BuildMeshes(scene, pSrcRootPath, pDstRootPath) &&
+                    InsertMetadata(scene) &&
+                    InsertSourceMetadata();
             }
         }
     }
 
+    if (success)
+    {
+        success = CommitTransaction();
+    }
+
     ReleaseResources();
 
+    if (buildToCopy)
+    {
+        std::error_code error;
+        if (success)
+        {
+            fs::rename(buildPath, pDstPath, error);
+            success = !error;
+        }
+
+        if (!success)
+        {
+            fs::remove(buildPath, error);
+        }
+    }
+
     return success;
 }
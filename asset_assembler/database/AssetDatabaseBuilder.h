@@ -2,7 +2,16 @@
 
 #include <cstdint>
 #include <stdio.h>
-#include "asset_assembler/rapidjson/fwd.h"
+#include <string>
+#include <vector>
+#include "asset_assembler/io/FileStamp.h"
+#include "asset_assembler/gltf/GltfScene.h"
+#include "asset_assembler/meshes/VertexQuantization.h"
+#include "asset_assembler/meshes/MeshletBuilder.h"
+#include "asset_assembler/meshes/BufferPacking.h"
+#include "asset_assembler/meshes/VertexLayout.h"
+#include "BuildSettings.h"
+#include "BuildStats.h"
 
 struct sqlite3;
 struct sqlite3_stmt;
@@ -10,12 +19,22 @@ struct sqlite3_stmt;
 namespace salvation::asset 
 { 
     enum class PackedDataType; 
-    enum class ComponentType;
     enum class AttributeSemantic;
 }
 
+namespace asset_assembler::textures
+{
+    struct MipChain;
+    class TextureCache;
+}
+
+namespace asset_assembler::io
+{
+    struct PackedChunk;
+    class PackedFileWriter;
+}
+
 using namespace salvation::asset;
-using namespace rapidjson;
 
 namespace asset_assembler
 {
@@ -26,13 +45,14 @@ namespace asset_assembler
         public:
 
             AssetDatabaseBuilder() = default;
+            explicit AssetDatabaseBuilder(const BuildSettings &settings) : m_Settings(settings) {}
             ~AssetDatabaseBuilder() = default;
 
             bool BuildDatabase(const char *pSrcPath, const char *pDstPath);
 
-        private:
+            const BuildStats& GetStats() const { return m_Stats; }
 
-            static constexpr size_t s_MaxRscFilePathLen = 1024;
+        private:
 
             struct StatementRAII
             {
@@ -45,59 +65,215 @@ namespace asset_assembler
             {
                 sqlite3_stmt*   m_pPackedDataStmt;
                 sqlite3_stmt*   m_pTextureStmt;
+                sqlite3_stmt*   m_pTextureMipStmt;
+                sqlite3_stmt*   m_pTextureMipCopyStmt;
                 sqlite3_stmt*   m_pBufferStmt;
                 sqlite3_stmt*   m_pMaterialStmt;
                 sqlite3_stmt*   m_pBufferViewStmt;
+                sqlite3_stmt*   m_pBufferViewEncodingStmt;
                 sqlite3_stmt*   m_pMeshStmt;
                 sqlite3_stmt*   m_pSubMeshStmt;
                 sqlite3_stmt*   m_pVertexStreamStmt;
+                sqlite3_stmt*   m_pMeshletStmt;
+                sqlite3_stmt*   m_pSubMeshLODStmt;
+                sqlite3_stmt*   m_pPackedDataChunkStmt;
+                sqlite3_stmt*   m_pSourceFileStmt;
             };
 
             struct UpdateStatements
             {
                 sqlite3_stmt*   m_pPackedDataStmt;
+                sqlite3_stmt*   m_pTextureStmt;
+                sqlite3_stmt*   m_pBufferStmt;
+                sqlite3_stmt*   m_pTextureMipDeleteStmt;
+                sqlite3_stmt*   m_pPackedDataChunkDeleteStmt;
             };
 
-            static uint8_t*     ReadFileContent(const char *pSrcPath, size_t &o_FileSize);
+            enum class SourceKind : int32_t
+            {
+                Scene,
+                Image,
+                Buffer
+            };
+
+            // Source file of a resource, compared against the one recorded by the previous incremental build
+            struct SourceRecord
+            {
+                std::string     m_Path {};              // Empty for resources embedded in the glTF
+                io::FileStamp   m_Stamp {};
+                int64_t         m_ByteOffset { 0 };     // Part of the file holding the resource, the BIN chunk of a GLB
+                int64_t         m_ByteSize { -1 };      // -1 for the whole file
+                uint64_t        m_Hash { 0 };
+                int64_t         m_ResourceId { -1 };    // Texture or Buffer row built from this file
+                bool            m_Hashed { false };
+                bool            m_Changed { true };
+            };
+
+            // Where new content goes in Textures.bin or Buffers.bin
+            struct PackedFileState
+            {
+                int64_t         m_PackedDataId { -1 };  // -1 inserts a new PackedData row
+                int64_t         m_ByteSize { 0 };       // Content is appended from this offset
+                int64_t         m_FileByteSize { 0 };   // Differs from m_ByteSize when the file is compressed
+                int64_t         m_ChunkCount { 0 };     // Index of the next compressed chunk
+                bool            m_Rewrite { true };     // Truncate the file and rewrite every resource
+            };
+
+            // Mesh data processed in place once a buffer is loaded
+            struct MeshBufferJob
+            {
+                int32_t                         m_BufferIndex { -1 };
+                const meshes::MeshPrimitive*    m_pPrimitives { nullptr };
+                size_t                          m_PrimitiveCount { 0 };
+                const meshes::VertexStream*     m_pStreams { nullptr };
+                size_t                          m_StreamCount { 0 };
+                const meshes::AccessorView*     m_pIndices { nullptr };
+                size_t                          m_IndicesCount { 0 };
+                const meshes::ReferencedRange*  m_pRanges { nullptr };      // Bytes to keep when stripping unreferenced data
+                size_t                          m_RangeCount { 0 };
+                const meshes::AccessorView*     m_pInterleaved { nullptr }; // Streams to deinterleave
+                size_t                          m_InterleavedCount { 0 };
+            };
+
+            // New location of a vertex stream moved by the layout stage, relative to its buffer
+            struct StreamRelocation
+            {
+                int64_t         m_ByteOffset { -1 };    // -1 when the stream was not moved
+                int32_t         m_ByteStride { 0 };
+            };
+
+            // Meshlets of a primitive, appended after the content of its buffer. Offsets are relative to the buffer.
+            struct MeshletRange
+            {
+                int32_t         m_MeshIndex { -1 };
+                int32_t         m_PrimitiveIndex { -1 };
+                int32_t         m_BufferIndex { -1 };
+                uint32_t        m_MeshletCount { 0 };
+                int64_t         m_MeshletByteOffset { 0 };
+                int64_t         m_VertexIndexByteOffset { 0 };
+                uint32_t        m_VertexIndexCount { 0 };
+                int64_t         m_TriangleByteOffset { 0 };
+                uint32_t        m_TriangleByteSize { 0 };
+
+                bool Precedes(const MeshletRange &other) const
+                {
+                    return m_MeshIndex != other.m_MeshIndex ? m_MeshIndex < other.m_MeshIndex : m_PrimitiveIndex < other.m_PrimitiveIndex;
+                }
+            };
+
+            // Index buffer of a level of detail of a primitive, appended after the content of its buffer
+            struct LodRange
+            {
+                int32_t         m_MeshIndex { -1 };
+                int32_t         m_PrimitiveIndex { -1 };
+                int32_t         m_BufferIndex { -1 };
+                uint32_t        m_Level { 0 };
+                int64_t         m_ByteOffset { 0 };
+                uint32_t        m_IndexCount { 0 };
+                uint32_t        m_IndexByteSize { 0 };  // 2 or 4
+                float           m_Error { 0.0f };
+
+                bool Precedes(const LodRange &other) const
+                {
+                    return m_MeshIndex != other.m_MeshIndex ? m_MeshIndex < other.m_MeshIndex : m_PrimitiveIndex < other.m_PrimitiveIndex;
+                }
+            };
+
+            struct CompressedTexture;
 
             void                ReleaseResources();
 
             bool                CreateDatabase(const char *pDstPath);
             bool                CreateTables();
 
+            bool                ExecuteSql(const char *pSql);
+            bool                BeginTransaction();
+            bool                CommitTransaction();
+            void                RollbackTransaction();
+            bool                StepStatement(sqlite3_stmt *pStmt);
+
             bool                CreateInsertStatements();
             bool                CreateUpdateStatements();
             void                ReleaseInsertStatements();
             void                ReleaseUpdateStatements();
+
+            bool                ClearTables(const char *const *ppTables, size_t tableCount);
+            bool                ClearBuildTables();
+            bool                ClearMetadataTables();
+            bool                QueryInt64(const char *pSql, int64_t bindValue, int64_t &o_Value);
+            bool                LoadSourceRecords(SourceRecord &o_Scene, std::vector<SourceRecord> &o_Images, std::vector<SourceRecord> &o_Buffers);
+            bool                LoadPackedFileState(PackedDataType dataType, const char *pLiveByteSizeSql, const char *pMisalignedCountSql, const char *pFilePath, PackedFileState &o_State);
+            static void         ResolveSourcePaths(const gltf::Scene &scene, SourceKind kind, const char *pSrcRootPath, std::vector<SourceRecord> &o_Sources);
+            static bool         DetectSourceChanges(std::vector<SourceRecord> &io_Sources, const std::vector<SourceRecord> &previousSources);
+            static bool         HashSource(SourceRecord &io_Source);
+            bool                PrepareBuild(const gltf::Scene &scene, const char *pSrcRootPath, const char *pDestRootPath);
             
             int64_t             InsertPackagedDataEntry(const char *pFilePath, PackedDataType dataType);
-            bool                InsertTextureDataEntry(int64_t byteSize, int64_t byteOffset, int32_t format, int64_t packedDataId);
-            bool                InsertBufferDataEntry(int64_t byteSize, int64_t byteOffset, int64_t packedDataId);
+            int64_t             InsertTextureDataEntry(int64_t byteSize, int64_t byteOffset, int32_t format, int64_t packedDataId);
+            bool                InsertTextureMipDataEntry(int64_t textureId, int32_t level, int32_t width, int32_t height, int64_t byteOffset, int64_t byteSize);
+            bool                CopyTextureMipDataEntries(int64_t textureId, int64_t srcTextureId);
+            int64_t             InsertBufferDataEntry(int64_t byteSize, int64_t byteOffset, int64_t packedDataId);
             bool                InsertMaterialDataEntry(int64_t textureId);
-            bool                InsertBufferViewDataEntry(int64_t bufferId, int64_t byteSize, int64_t byteOffset, int32_t stride);
+            int64_t             InsertBufferViewDataEntry(int64_t bufferId, int64_t byteSize, int64_t byteOffset, int32_t stride);
+            bool                InsertBufferViewEncodingDataEntry(int64_t bufferViewId, const meshes::QuantizedStream &encoding);
             int64_t             InsertMeshDataEntry(const char *pName);
             int64_t             InsertSubMeshDataEntry(int64_t meshId, int64_t indexBufferViewId, int64_t materialId);
             bool                InsertVertexStreamDataEntry(int64_t subMeshId, int64_t bufferViewId, int32_t attribute);
+            bool                InsertMeshletDataEntry(int64_t subMeshId, const MeshletRange &range);
+            bool                InsertSubMeshLODDataEntry(int64_t subMeshId, const LodRange &range);
+            bool                InsertPackedDataChunkDataEntry(int64_t packedDataId, int64_t chunkIndex, const io::PackedChunk &chunk);
+            bool                InsertSourceFileDataEntry(SourceKind kind, int64_t resourceIndex, const SourceRecord &source);
 
             bool                UpdatePackagedDataEntry(int64_t packagedDataId, int64_t byteSize);
+            bool                UpdateTextureDataEntry(int64_t textureId, int64_t byteSize, int64_t byteOffset, int32_t format);
+            bool                UpdateBufferDataEntry(int64_t bufferId, int64_t byteSize, int64_t byteOffset);
+            bool                DeleteTextureMipDataEntries(int64_t textureId);
+            bool                DeletePackedDataChunkDataEntries(int64_t packedDataId);
 
-            bool                InsertMaterialMetadata(Document &json);
-            bool                InsertBufferViewMetadata(Document &json);
-            bool                InsertMeshMetadata(Document &json);
-            bool                InsertVertexStreamsMetadata(Value &attributes, int64_t subMeshId);
-            bool                InsertMetadata(Document &json);
+            bool                InsertMaterialMetadata(const gltf::Scene &scene);
+            bool                InsertBufferViewMetadata(const gltf::Scene &scene);
+            bool                InsertMeshMetadata(const gltf::Scene &scene);
+            bool                InsertVertexStreamsMetadata(const gltf::Scene &scene, const gltf::Primitive &primitive, int64_t subMeshId);
+            bool                InsertMetadata(const gltf::Scene &scene);
+            bool                InsertSourceMetadata();
 
-            bool                BuildTextures(Document &json, const char *pSrcRootPath, const char *pDestRootPath);
-            int64_t             CompressTexture(const char *pSrcFilePath, FILE *pDestFile, int64_t packedDataId);
-            bool                BuildMeshes(Document &json, const char *pSrcRootPath, const char *pDestRootPath);
+            bool                BuildTextures(const gltf::Scene &scene, const char *pSrcRootPath, const char *pDestRootPath);
+            static bool         CompressTexture(const char *pSrcFilePath, textures::BlockFormat format, int threadCount, CompressedTexture &o_Texture);
+            static bool         LoadOrCompressTexture(textures::TextureCache &cache, textures::BlockFormat format, int threadCount, SourceRecord &io_Source, CompressedTexture &io_Texture);
+            static int64_t      WriteTexture(const textures::MipChain &chain, io::PackedFileWriter &writer);
+            int64_t             PadPackedFile(int64_t byteSize, io::PackedFileWriter &writer);
+            bool                InsertPackedDataChunkMetadata(const io::PackedFileWriter &writer, int64_t packedDataId, const PackedFileState &packedFile);
+            static void         ReleaseTexture(CompressedTexture &texture);
+            bool                InsertTextureMipMetadata(const textures::MipChain &chain, int64_t textureId, int64_t textureByteOffset);
+            bool                BuildMeshes(const gltf::Scene &scene, const char *pSrcRootPath, const char *pDestRootPath);
+            int64_t             WriteProcessedBuffer(const MeshBufferJob &job, const SourceRecord &source, io::PackedFileWriter &writer);
 
-            ComponentType       GetComponentType(const char *pGLTFType, int glTFComponentType);
 
         private:
 
+            BuildSettings       m_Settings {};
+            BuildStats          m_Stats {};
             sqlite3*            m_pDb { nullptr };
             InsertStatements    m_InsertStmts {};
             UpdateStatements    m_UpdateStmts {};
+            uint32_t            m_PendingRowCount { 0 };
+            uint64_t            m_InsertedRowCount { 0 };
+            bool                m_TransactionOpen { false };
+
+            SourceRecord                m_SceneSource {};
+            std::vector<SourceRecord>   m_ImageSources {};
+            std::vector<textures::BlockFormat>  m_ImageFormats {};  // Indexed by image, selected from their material usage
+            std::vector<SourceRecord>   m_BufferSources {};
+            PackedFileState             m_TexturesFile {};
+            PackedFileState             m_BuffersFile {};
+            bool                        m_FullRebuild { true };
+
+            std::vector<meshes::QuantizedStream>    m_StreamEncodings {};   // Indexed by accessor, filled by BuildMeshes
+            std::vector<uint8_t>                    m_NarrowedIndices {};   // Indexed by accessor, filled by BuildMeshes
+            std::vector<StreamRelocation>           m_StreamRelocations {}; // Indexed by accessor, filled by BuildMeshes
+            std::vector<MeshletRange>               m_MeshletRanges {};     // Sorted by mesh and primitive, filled by BuildMeshes
+            std::vector<LodRange>                   m_LodRanges {};         // Sorted by mesh, primitive and level, filled by BuildMeshes
+            std::vector<std::vector<meshes::BufferSegment>> m_BufferSegments {};    // Indexed by buffer, filled by BuildMeshes when stripping
         };
     }
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include "asset_assembler/textures/TextureFormatSelection.h"
+
+namespace asset_assembler
+{
+    namespace database
+    {
+        // Target of one level of detail, relative to the primitive it is simplified from
+        struct LodLevelSettings
+        {
+            // Fraction of the primitive's triangles to keep
+            float       m_TriangleRatio { 0.5f };
+
+            // Root mean square distance to the primitive's original planes a collapse may introduce,
+            // relative to the largest extent of the primitive. Reaching it stops the level above its ratio.
+            float       m_MaxError { 0.01f };
+        };
+
+        static constexpr uint32_t s_MaxLodLevelCount = 8;
+
+        enum class VertexLayout : uint32_t
+        {
+            Source,             // Streams stay laid out as in the glTF
+            Deinterleaved,      // One tightly packed stream per attribute, position-only passes only fetch positions
+            Interleaved         // A single stream holding every attribute of a submesh
+        };
+
+        struct BuildSettings
+        {
+            // Maximum number of threads used to process assets concurrently. 0 uses every available core.
+            uint32_t    m_WorkerThreadCount { 0 };
+
+            // Number of rows written per SQLite transaction. 0 writes the whole build in a single transaction,
+            // which is rolled back on failure. With batching, the build writes to a copy of the database that only
+            // replaces it on success, a failed build leaves the previous database untouched.
+            uint32_t    m_TransactionBatchSize { 0 };
+
+            // Directory of the compressed texture cache, shared between builds. nullptr disables the cache.
+            const char* m_pTextureCacheDirectory { nullptr };
+
+            // Least recently used cache entries are evicted once the cache grows past this size. 0 means unbounded.
+            uint64_t    m_TextureCacheMaxByteSize { 4ull * 1024 * 1024 * 1024 };
+
+            // Images are hashed before compression and the ones with identical content are compressed once.
+            // Each keeps its Texture row, pointing to the same range of Textures.bin.
+            bool        m_DeduplicateTextures { true };
+
+            // Block compression format of the images sampled from each material slot, indexed by textures::TextureUsage.
+            // Auto keeps the default of the slot, see textures::SelectBlockFormat. The format of every texture is
+            // recorded in its Texture row.
+            textures::BlockFormat m_TextureFormats[static_cast<uint32_t>(textures::TextureUsage::Count)] {};
+
+            // Start and size of every texture in Textures.bin and every buffer in Buffers.bin are padded to a multiple
+            // of this power of two, and the padded sizes are recorded in the database. 4096 allows unbuffered reads
+            // of whole resources straight into upload heaps. 1 packs resources back to back.
+            uint32_t    m_PackedDataAlignment { 1 };
+
+            // Textures.bin and Buffers.bin are stored as LZ4 chunks of this many uncompressed bytes when not 0, each
+            // decodable on its own and starting on a m_PackedDataAlignment boundary of the file. Resource offsets stay
+            // in uncompressed bytes and the PackedDataChunk table maps them to the chunks a loader has to read and
+            // decompress. 64 to 256 KiB keeps the ratio close to whole-file compression while decoding in parallel.
+            uint32_t    m_CompressionChunkByteSize { 0 };
+
+            // Number of 4 MiB buffers queued to the thread writing each packed file, so compression and buffer
+            // processing overlap with disk writes. Processing waits when every buffer is queued. 0 writes synchronously.
+            uint32_t    m_WriteQueueLength { 8 };
+
+            // Read the glTF straight into the scene with a streaming reader, instead of copying the text and building
+            // its full DOM. Keeps memory down on scenes with hundreds of MB of JSON.
+            bool        m_StreamJson { false };
+
+            // Reuse the content of an existing database: only images and buffers whose source file changed are
+            // rebuilt and appended to the packed files, and metadata is only regenerated when the glTF changed.
+            // Without it, the existing database content is discarded and everything is rebuilt.
+            bool        m_Incremental { false };
+
+            // Reorder the triangles of every primitive for the post-transform vertex cache and overdraw,
+            // then its vertices for fetch locality, before writing them to Buffers.bin.
+            bool        m_OptimizeMeshes { false };
+
+            // Number of entries of the post-transform cache the triangle order is optimized for
+            uint32_t    m_VertexCacheSize { 16 };
+
+            // Maximum vertex cache efficiency loss accepted to reduce overdraw, 1.05 allows a 5% higher ACMR
+            float       m_OverdrawThreshold { 1.05f };
+
+            // Store vertex attributes with smaller encodings: positions as 16 bits normalized to the bounds of
+            // their stream, normals and tangents as octahedral unit vectors, texture coordinates as half floats and
+            // colors as 8 bits normalized. The encoding of every stream is recorded in the BufferViewEncoding table.
+            bool        m_QuantizeVertices { false };
+
+            // Bits per component of octahedral normals and tangents, 8 or 16
+            uint32_t    m_OctahedralBits { 16 };
+
+            // Only pack the bytes of Buffers.bin read by the accessors of mesh primitives. Animation and skinning data,
+            // unused accessors and padding are stripped, and BufferView offsets point into the packed buffers.
+            // Off by default: packed offsets depend on every buffer, so incremental builds repack all of them
+            // whenever one changes, and whole buffers can't be appended kernel-side.
+            bool        m_StripUnreferencedBufferData { false };
+
+            // Layout of the vertex streams in Buffers.bin. Moved streams are appended to their buffer and their
+            // BufferView rows point to the new location and stride. Interleaving only applies to the triangle list
+            // primitives whose vertex streams are not read by another primitive.
+            VertexLayout    m_VertexLayout { VertexLayout::Source };
+
+            // Rewrite 32 bits index buffers as 16 bits when every index fits. The freed bytes only leave Buffers.bin
+            // with m_StripUnreferencedBufferData, otherwise they are zero-filled in place.
+            // Off by default: narrowed sizes are stored with the metadata, so incremental builds rewrite every buffer
+            // whenever one changes.
+            bool        m_NarrowIndices { false };
+
+            // Split every triangle list primitive into meshlets with bounding spheres and normal cones for GPU culling.
+            // Meshlets are appended to the buffer of their primitive and located by the Meshlet table.
+            bool        m_BuildMeshlets { false };
+
+            // Meshlet size limits, at most 256 vertices and 512 triangles
+            uint32_t    m_MeshletMaxVertexCount { 64 };
+            uint32_t    m_MeshletMaxTriangleCount { 124 };
+
+            // Index buffers of lower levels of detail, built for every triangle list primitive with float3 positions
+            // by simplifying it towards each level's target. They share the primitive's vertices, are appended to its
+            // buffer and are located by the SubMeshLOD table. Levels must be sorted by decreasing triangle ratio.
+            uint32_t            m_LodLevelCount { 0 };
+            LodLevelSettings    m_LodLevels[s_MaxLodLevelCount] {};
+        };
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+namespace asset_assembler
+{
+    namespace database
+    {
+        // Wall-clock time spent in each stage of the last AssetDatabaseBuilder::BuildDatabase call,
+        // along with the amount of work each stage did.
+        struct BuildStats
+        {
+            double      m_ParseJsonSeconds { 0.0 };
+            double      m_BuildTexturesSeconds { 0.0 };
+            double      m_BuildMeshesSeconds { 0.0 };
+            double      m_WriteStallSeconds { 0.0 };    // Time processing waited for the write queue of the packed files
+            double      m_InsertMetadataSeconds { 0.0 };
+            double      m_TotalSeconds { 0.0 };
+
+            uint64_t    m_JsonByteSize { 0 };
+            uint64_t    m_JsonDomByteSize { 0 };        // Memory taken by the parsed JSON document, 0 when streamed
+            uint64_t    m_JsonPeakByteSize { 0 };       // Memory reserved for the JSON text and its document, 0 when streamed
+            uint32_t    m_TextureCount { 0 };
+            uint32_t    m_EmbeddedImageCount { 0 };     // Images stored in a bufferView, which can't be loaded and fail the build
+            uint64_t    m_TextureTexelByteSize { 0 };   // Uncompressed RGBA8 size of every source mip 0
+            uint64_t    m_TextureByteSize { 0 };        // Compressed bytes written to Textures.bin
+            uint32_t    m_DuplicateTextureCount { 0 };  // Images sharing the compressed texture of an identical image
+            uint64_t    m_DuplicateTextureByteSize { 0 };   // Textures.bin bytes they would have taken
+            double      m_DuplicateTextureSeconds { 0.0 };  // Time spent compressing the textures they share
+            uint32_t    m_TextureCacheHitCount { 0 };
+            uint32_t    m_TextureCacheMissCount { 0 };
+            uint32_t    m_TextureCacheEvictedCount { 0 };
+            uint32_t    m_BufferCount { 0 };
+            uint64_t    m_BufferByteSize { 0 };         // Bytes written to Buffers.bin
+            uint64_t    m_StrippedBufferByteSize { 0 }; // Unreferenced buffer bytes left out of Buffers.bin
+            uint64_t    m_AlignmentPaddingByteSize { 0 };   // Zeros written to align resources in both packed files
+            uint32_t    m_ChunkCount { 0 };
+            uint64_t    m_ChunkByteSize { 0 };          // Packed file bytes written as chunks
+            uint64_t    m_ChunkFileByteSize { 0 };      // Size of those chunks once compressed
+            uint64_t    m_MetadataRowCount { 0 };       // Rows inserted by InsertMetadata
+            uint32_t    m_OptimizedPrimitiveCount { 0 };
+            uint64_t    m_OptimizedTriangleCount { 0 };
+            uint64_t    m_OptimizedVertexCount { 0 };
+            uint64_t    m_VertexCacheMissCountBefore { 0 }; // Simulated vertex transforms of the optimized primitives
+            uint64_t    m_VertexCacheMissCountAfter { 0 };
+            uint32_t    m_QuantizedStreamCount { 0 };
+            uint64_t    m_QuantizedByteSizeBefore { 0 };    // Vertex data of the quantized streams, before and after
+            uint64_t    m_QuantizedByteSizeAfter { 0 };
+            uint32_t    m_NarrowedIndexBufferCount { 0 };   // 32 bits index buffers rewritten as 16 bits
+            uint64_t    m_NarrowedIndexCount { 0 };
+            uint32_t    m_DeinterleavedStreamCount { 0 };
+            uint32_t    m_InterleavedPrimitiveCount { 0 };
+            uint32_t    m_MeshletPrimitiveCount { 0 };
+            uint32_t    m_MeshletCount { 0 };
+            uint32_t    m_LodPrimitiveCount { 0 };
+            uint32_t    m_LodLevelCount { 0 };          // Levels written, summed over every primitive
+            uint64_t    m_LodTriangleCount { 0 };       // Triangles of every level written
+            uint32_t    m_ReusedTextureCount { 0 };     // Textures left untouched by an incremental build
+            uint32_t    m_ReusedBufferCount { 0 };      // Buffers left untouched by an incremental build
+            bool        m_FullRebuild { true };         // The incremental build had to rebuild everything
+        };
+    }
+}
@@ -0,0 +1,85 @@
+#include <pch.h>
+#include "GlbContainer.h"
+
+using namespace asset_assembler;
+
+namespace
+{
+    static constexpr uint32_t s_GlbMagic = 0x46546C67;         // "glTF"
+    static constexpr uint32_t s_GlbVersion = 2;
+    static constexpr uint32_t s_JsonChunkType = 0x4E4F534A;    // "JSON"
+    static constexpr uint32_t s_BinChunkType = 0x004E4942;     // "BIN\0"
+
+    static constexpr size_t s_HeaderByteSize = 12;
+    static constexpr size_t s_ChunkHeaderByteSize = 8;
+
+    // GLB integers are little-endian, read one at a time since the content may not be aligned
+    uint32_t ReadUInt32(const uint8_t *pData)
+    {
+        return
+            static_cast<uint32_t>(pData[0]) |
+            (static_cast<uint32_t>(pData[1]) << 8) |
+            (static_cast<uint32_t>(pData[2]) << 16) |
+            (static_cast<uint32_t>(pData[3]) << 24);
+    }
+}
+
+bool gltf::IsGlb(const uint8_t *pData, size_t byteSize)
+{
+    return byteSize >= s_HeaderByteSize && ReadUInt32(pData) == s_GlbMagic;
+}
+
+bool gltf::ReadGlbChunks(const uint8_t *pData, size_t byteSize, GlbChunks &o_Chunks)
+{
+    o_Chunks = {};
+
+    if (!IsGlb(pData, byteSize) || ReadUInt32(pData + 4) != s_GlbVersion)
+    {
+        return false;
+    }
+
+    // Trailing bytes past the declared length are ignored
+    size_t fileByteSize = ReadUInt32(pData + 8);
+    if (fileByteSize > byteSize)
+    {
+        return false;
+    }
+
+    size_t byteOffset = s_HeaderByteSize;
+    bool jsonFound = false;
+
+    while (byteOffset + s_ChunkHeaderByteSize <= fileByteSize)
+    {
+        size_t chunkByteSize = ReadUInt32(pData + byteOffset);
+        uint32_t chunkType = ReadUInt32(pData + byteOffset + 4);
+        size_t chunkByteOffset = byteOffset + s_ChunkHeaderByteSize;
+
+        if (chunkByteSize > fileByteSize - chunkByteOffset)
+        {
+            return false;
+        }
+
+        // The JSON chunk comes first and the BIN chunk, when present, right after it.
+        // Chunks of unknown types are skipped.
+        if (!jsonFound)
+        {
+            if (chunkType != s_JsonChunkType)
+            {
+                return false;
+            }
+
+            o_Chunks.m_pJson = reinterpret_cast<const char*>(pData + chunkByteOffset);
+            o_Chunks.m_JsonByteSize = chunkByteSize;
+            jsonFound = true;
+        }
+        else if (chunkType == s_BinChunkType && o_Chunks.m_BinByteOffset < 0)
+        {
+            o_Chunks.m_BinByteOffset = static_cast<int64_t>(chunkByteOffset);
+            o_Chunks.m_BinByteSize = static_cast<int64_t>(chunkByteSize);
+        }
+
+        byteOffset = chunkByteOffset + chunkByteSize;
+    }
+
+    return jsonFound;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace asset_assembler
+{
+    namespace gltf
+    {
+        // Chunks of a binary glTF file, located inside the file content
+        struct GlbChunks
+        {
+            const char*     m_pJson { nullptr };        // Not null-terminated
+            size_t          m_JsonByteSize { 0 };
+            int64_t         m_BinByteOffset { -1 };     // From the start of the file, -1 without BIN chunk
+            int64_t         m_BinByteSize { 0 };
+        };
+
+        // True when the content starts with the GLB magic
+        bool IsGlb(const uint8_t *pData, size_t byteSize);
+
+        // Locates the JSON chunk and the optional BIN chunk of a GLB file, without copying either.
+        // Fails when the header, the chunk lengths or the order of the chunks don't follow the GLB layout.
+        bool ReadGlbChunks(const uint8_t *pData, size_t byteSize, GlbChunks &o_Chunks);
+    }
+}
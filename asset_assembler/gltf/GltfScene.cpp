@@ -0,0 +1,548 @@
+#include <pch.h>
+#include "GltfScene.h"
+#include "rapidjson/document.h"
+#include <cstdlib>
+#include <cstring>
+
+using namespace asset_assembler;
+using namespace asset_assembler::gltf;
+using namespace rapidjson;
+
+namespace
+{
+    // Stands for the elements that aren't objects, so they keep their slot and indices still match the document
+    static const Value s_EmptyObject(kObjectType);
+
+    inline bool IsName(const Value::ConstMemberIterator &member, const char *pName)
+    {
+        return strcmp(member->name.GetString(), pName) == 0;
+    }
+
+    inline int32_t ReadIndex(const Value &value)
+    {
+        return value.IsInt() && value.GetInt() >= 0 ? value.GetInt() : s_InvalidIndex;
+    }
+
+    inline int64_t ReadInt64(const Value &value, int64_t defaultValue)
+    {
+        return value.IsInt64() ? value.GetInt64() : defaultValue;
+    }
+
+    inline void ValidateIndex(int32_t &io_Index, size_t count)
+    {
+        if (io_Index != s_InvalidIndex && static_cast<size_t>(io_Index) >= count)
+        {
+            io_Index = s_InvalidIndex;
+        }
+    }
+
+    int32_t AddString(const Value &value, std::vector<char> &io_Strings)
+    {
+        if (!value.IsString())
+        {
+            return s_InvalidIndex;
+        }
+
+        int32_t offset = static_cast<int32_t>(io_Strings.size());
+        io_Strings.insert(io_Strings.end(), value.GetString(), value.GetString() + value.GetStringLength());
+        io_Strings.push_back(0);
+
+        return offset;
+    }
+
+    // Index of a textureInfo object
+    int32_t ReadTextureIndex(const Value &textureInfo)
+    {
+        if (textureInfo.IsObject())
+        {
+            for (Value::ConstMemberIterator it = textureInfo.MemberBegin(); it != textureInfo.MemberEnd(); ++it)
+            {
+                if (IsName(it, "index"))
+                {
+                    return ReadIndex(it->value);
+                }
+            }
+        }
+
+        return s_InvalidIndex;
+    }
+
+    void ReadImage(const Value &object, Scene &io_Scene)
+    {
+        Image image {};
+
+        for (Value::ConstMemberIterator it = object.MemberBegin(); it != object.MemberEnd(); ++it)
+        {
+            if (IsName(it, "uri"))
+            {
+                image.m_Uri = AddString(it->value, io_Scene.m_Strings);
+            }
+            else if (IsName(it, "bufferView"))
+            {
+                image.m_BufferView = ReadIndex(it->value);
+            }
+        }
+
+        io_Scene.m_Images.push_back(image);
+    }
+
+    void ReadTexture(const Value &object, Scene &io_Scene)
+    {
+        Texture texture {};
+
+        for (Value::ConstMemberIterator it = object.MemberBegin(); it != object.MemberEnd(); ++it)
+        {
+            if (IsName(it, "source"))
+            {
+                texture.m_Image = ReadIndex(it->value);
+            }
+        }
+
+        io_Scene.m_Textures.push_back(texture);
+    }
+
+    void ReadMaterial(const Value &object, Scene &io_Scene)
+    {
+        Material material {};
+
+        auto setTexture = [&](textures::TextureUsage usage, const Value &textureInfo)
+        {
+            material.m_Textures[static_cast<uint32_t>(usage)] = ReadTextureIndex(textureInfo);
+        };
+
+        for (Value::ConstMemberIterator it = object.MemberBegin(); it != object.MemberEnd(); ++it)
+        {
+            if (IsName(it, "pbrMetallicRoughness") && it->value.IsObject())
+            {
+                for (Value::ConstMemberIterator pbrIt = it->value.MemberBegin(); pbrIt != it->value.MemberEnd(); ++pbrIt)
+                {
+                    if (IsName(pbrIt, "baseColorTexture"))
+                    {
+                        setTexture(textures::TextureUsage::BaseColor, pbrIt->value);
+                    }
+                    else if (IsName(pbrIt, "metallicRoughnessTexture"))
+                    {
+                        setTexture(textures::TextureUsage::MetallicRoughness, pbrIt->value);
+                    }
+                }
+            }
+            else if (IsName(it, "normalTexture"))
+            {
+                setTexture(textures::TextureUsage::Normal, it->value);
+            }
+            else if (IsName(it, "occlusionTexture"))
+            {
+                setTexture(textures::TextureUsage::Occlusion, it->value);
+            }
+            else if (IsName(it, "emissiveTexture"))
+            {
+                setTexture(textures::TextureUsage::Emissive, it->value);
+            }
+        }
+
+        io_Scene.m_Materials.push_back(material);
+    }
+
+    void ReadBuffer(const Value &object, Scene &io_Scene)
+    {
+        Buffer buffer {};
+
+        for (Value::ConstMemberIterator it = object.MemberBegin(); it != object.MemberEnd(); ++it)
+        {
+            if (IsName(it, "uri"))
+            {
+                buffer.m_Uri = AddString(it->value, io_Scene.m_Strings);
+            }
+            else if (IsName(it, "byteLength"))
+            {
+                buffer.m_ByteLength = ReadInt64(it->value, -1);
+            }
+        }
+
+        io_Scene.m_Buffers.push_back(buffer);
+    }
+
+    void ReadBufferView(const Value &object, Scene &io_Scene)
+    {
+        BufferView bufferView {};
+
+        for (Value::ConstMemberIterator it = object.MemberBegin(); it != object.MemberEnd(); ++it)
+        {
+            if (IsName(it, "buffer"))
+            {
+                bufferView.m_Buffer = ReadIndex(it->value);
+            }
+            else if (IsName(it, "byteOffset"))
+            {
+                bufferView.m_ByteOffset = ReadInt64(it->value, 0);
+            }
+            else if (IsName(it, "byteLength"))
+            {
+                bufferView.m_ByteLength = ReadInt64(it->value, -1);
+            }
+            else if (IsName(it, "byteStride"))
+            {
+                bufferView.m_ByteStride = static_cast<int32_t>(ReadInt64(it->value, 0));
+            }
+        }
+
+        io_Scene.m_BufferViews.push_back(bufferView);
+    }
+
+    void ReadSparse(const Value &sparse, Accessor &io_Accessor)
+    {
+        io_Accessor.m_Sparse = true;
+
+        if (!sparse.IsObject())
+        {
+            return;
+        }
+
+        for (Value::ConstMemberIterator it = sparse.MemberBegin(); it != sparse.MemberEnd(); ++it)
+        {
+            int32_t *pBufferView =
+                IsName(it, "indices") ? &io_Accessor.m_SparseIndicesBufferView :
+                IsName(it, "values") ? &io_Accessor.m_SparseValuesBufferView :
+                nullptr;
+
+            if (!pBufferView || !it->value.IsObject())
+            {
+                continue;
+            }
+
+            for (Value::ConstMemberIterator viewIt = it->value.MemberBegin(); viewIt != it->value.MemberEnd(); ++viewIt)
+            {
+                if (IsName(viewIt, "bufferView"))
+                {
+                    *pBufferView = ReadIndex(viewIt->value);
+                }
+            }
+        }
+    }
+
+    void ReadAccessor(const Value &object, Scene &io_Scene)
+    {
+        Accessor accessor {};
+
+        for (Value::ConstMemberIterator it = object.MemberBegin(); it != object.MemberEnd(); ++it)
+        {
+            if (IsName(it, "bufferView"))
+            {
+                accessor.m_BufferView = ReadIndex(it->value);
+            }
+            else if (IsName(it, "byteOffset"))
+            {
+                accessor.m_ByteOffset = ReadInt64(it->value, 0);
+            }
+            else if (IsName(it, "componentType"))
+            {
+                accessor.m_ComponentType = it->value.IsInt() ? it->value.GetInt() : 0;
+            }
+            else if (IsName(it, "count"))
+            {
+                accessor.m_Count = ReadInt64(it->value, -1);
+            }
+            else if (IsName(it, "type"))
+            {
+                accessor.m_Type = it->value.IsString() ? ParseAccessorType(it->value.GetString()) : AccessorType::Unknown;
+            }
+            else if (IsName(it, "normalized"))
+            {
+                accessor.m_Normalized = it->value.IsBool() && it->value.GetBool();
+            }
+            else if (IsName(it, "sparse"))
+            {
+                ReadSparse(it->value, accessor);
+            }
+        }
+
+        io_Scene.m_Accessors.push_back(accessor);
+    }
+
+    void ReadPrimitive(const Value &object, int32_t meshIndex, int32_t indexInMesh, Scene &io_Scene)
+    {
+        Primitive primitive {};
+        primitive.m_Mesh = meshIndex;
+        primitive.m_IndexInMesh = indexInMesh;
+        primitive.m_FirstAttribute = static_cast<uint32_t>(io_Scene.m_Attributes.size());
+        primitive.m_FirstTargetAccessor = static_cast<uint32_t>(io_Scene.m_TargetAccessors.size());
+
+        for (Value::ConstMemberIterator it = object.MemberBegin(); it != object.MemberEnd(); ++it)
+        {
+            if (IsName(it, "attributes") && it->value.IsObject())
+            {
+                for (Value::ConstMemberIterator attributeIt = it->value.MemberBegin(); attributeIt != it->value.MemberEnd(); ++attributeIt)
+                {
+                    Attribute attribute = ParseAttribute(attributeIt->name.GetString(), ReadIndex(attributeIt->value));
+                    io_Scene.m_Attributes.push_back(attribute);
+
+                    if (attribute.m_Semantic == AttributeSemantic::Position)
+                    {
+                        primitive.m_Position = attribute.m_Accessor;
+                    }
+                }
+            }
+            else if (IsName(it, "indices"))
+            {
+                primitive.m_Indices = ReadIndex(it->value);
+            }
+            else if (IsName(it, "material"))
+            {
+                primitive.m_Material = ReadIndex(it->value);
+            }
+            else if (IsName(it, "mode"))
+            {
+                primitive.m_Mode = it->value.IsInt() ? it->value.GetInt() : s_InvalidIndex;
+            }
+            else if (IsName(it, "targets"))
+            {
+                primitive.m_HasTargets = true;
+
+                if (!it->value.IsArray())
+                {
+                    continue;
+                }
+
+                for (const Value &target : it->value.GetArray())
+                {
+                    if (!target.IsObject())
+                    {
+                        continue;
+                    }
+
+                    for (Value::ConstMemberIterator targetIt = target.MemberBegin(); targetIt != target.MemberEnd(); ++targetIt)
+                    {
+                        if (targetIt->value.IsInt())
+                        {
+                            io_Scene.m_TargetAccessors.push_back(ReadIndex(targetIt->value));
+                        }
+                    }
+                }
+            }
+        }
+
+        primitive.m_AttributeCount = static_cast<uint32_t>(io_Scene.m_Attributes.size()) - primitive.m_FirstAttribute;
+        primitive.m_TargetAccessorCount = static_cast<uint32_t>(io_Scene.m_TargetAccessors.size()) - primitive.m_FirstTargetAccessor;
+
+        io_Scene.m_Primitives.push_back(primitive);
+    }
+
+    void ReadMesh(const Value &object, Scene &io_Scene)
+    {
+        Mesh mesh {};
+        mesh.m_FirstPrimitive = static_cast<uint32_t>(io_Scene.m_Primitives.size());
+
+        int32_t meshIndex = static_cast<int32_t>(io_Scene.m_Meshes.size());
+
+        for (Value::ConstMemberIterator it = object.MemberBegin(); it != object.MemberEnd(); ++it)
+        {
+            if (IsName(it, "primitives") && it->value.IsArray())
+            {
+                const Value &primitives = it->value;
+
+                for (SizeType i = 0; i < primitives.Size(); ++i)
+                {
+                    ReadPrimitive(primitives[i].IsObject() ? primitives[i] : s_EmptyObject, meshIndex, static_cast<int32_t>(i), io_Scene);
+                }
+            }
+        }
+
+        mesh.m_PrimitiveCount = static_cast<uint32_t>(io_Scene.m_Primitives.size()) - mesh.m_FirstPrimitive;
+        io_Scene.m_Meshes.push_back(mesh);
+    }
+}
+
+void gltf::BuildScene(const Document &json, Scene &o_Scene)
+{
+    using ReadFunction = void (*)(const Value&, Scene&);
+
+    struct ArrayReader
+    {
+        const char*     m_pName;
+        ReadFunction    m_pRead;
+    };
+
+    static constexpr ArrayReader s_ArrayReaders[] =
+    {
+        { "images", ReadImage },
+        { "textures", ReadTexture },
+        { "materials", ReadMaterial },
+        { "buffers", ReadBuffer },
+        { "bufferViews", ReadBufferView },
+        { "accessors", ReadAccessor },
+        { "meshes", ReadMesh },
+    };
+
+    o_Scene = {};
+
+    if (!json.IsObject())
+    {
+        return;
+    }
+
+    for (Value::ConstMemberIterator it = json.MemberBegin(); it != json.MemberEnd(); ++it)
+    {
+        for (const ArrayReader &reader : s_ArrayReaders)
+        {
+            if (!IsName(it, reader.m_pName))
+            {
+                continue;
+            }
+
+            if (it->value.IsArray())
+            {
+                for (const Value &element : it->value.GetArray())
+                {
+                    reader.m_pRead(element.IsObject() ? element : s_EmptyObject, o_Scene);
+                }
+            }
+
+            break;
+        }
+    }
+
+    ValidateIndices(o_Scene);
+}
+
+void gltf::ValidateIndices(Scene &io_Scene)
+{
+    for (Image &image : io_Scene.m_Images)
+    {
+        ValidateIndex(image.m_BufferView, io_Scene.m_BufferViews.size());
+    }
+
+    for (Texture &texture : io_Scene.m_Textures)
+    {
+        ValidateIndex(texture.m_Image, io_Scene.m_Images.size());
+    }
+
+    for (Material &material : io_Scene.m_Materials)
+    {
+        for (int32_t &textureIndex : material.m_Textures)
+        {
+            ValidateIndex(textureIndex, io_Scene.m_Textures.size());
+        }
+    }
+
+    for (BufferView &bufferView : io_Scene.m_BufferViews)
+    {
+        ValidateIndex(bufferView.m_Buffer, io_Scene.m_Buffers.size());
+    }
+
+    for (Accessor &accessor : io_Scene.m_Accessors)
+    {
+        ValidateIndex(accessor.m_BufferView, io_Scene.m_BufferViews.size());
+        ValidateIndex(accessor.m_SparseIndicesBufferView, io_Scene.m_BufferViews.size());
+        ValidateIndex(accessor.m_SparseValuesBufferView, io_Scene.m_BufferViews.size());
+    }
+
+    for (Primitive &primitive : io_Scene.m_Primitives)
+    {
+        ValidateIndex(primitive.m_Indices, io_Scene.m_Accessors.size());
+        ValidateIndex(primitive.m_Position, io_Scene.m_Accessors.size());
+        ValidateIndex(primitive.m_Material, io_Scene.m_Materials.size());
+    }
+
+    for (Attribute &attribute : io_Scene.m_Attributes)
+    {
+        ValidateIndex(attribute.m_Accessor, io_Scene.m_Accessors.size());
+    }
+
+    for (int32_t &accessorIndex : io_Scene.m_TargetAccessors)
+    {
+        ValidateIndex(accessorIndex, io_Scene.m_Accessors.size());
+    }
+}
+
+AccessorType gltf::ParseAccessorType(const char *pType)
+{
+    static constexpr const char *s_pTypes[] = { "SCALAR", "VEC2", "VEC3", "VEC4", "MAT2", "MAT3", "MAT4" };
+    static constexpr AccessorType s_Types[] =
+    {
+        AccessorType::Scalar, AccessorType::Vec2, AccessorType::Vec3, AccessorType::Vec4,
+        AccessorType::Mat2, AccessorType::Mat3, AccessorType::Mat4
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(s_pTypes); ++i)
+    {
+        if (strcmp(pType, s_pTypes[i]) == 0)
+        {
+            return s_Types[i];
+        }
+    }
+
+    return AccessorType::Unknown;
+}
+
+Attribute gltf::ParseAttribute(const char *pName, int32_t accessorIndex)
+{
+    struct SemanticName
+    {
+        const char*         m_pName;
+        AttributeSemantic   m_Semantic;
+        bool                m_HasSet;
+    };
+
+    static constexpr SemanticName s_SemanticNames[] =
+    {
+        { "POSITION", AttributeSemantic::Position, false },
+        { "NORMAL", AttributeSemantic::Normal, false },
+        { "TANGENT", AttributeSemantic::Tangent, false },
+        { "TEXCOORD_", AttributeSemantic::TexCoord, true },
+        { "COLOR_", AttributeSemantic::Color, true },
+    };
+
+    Attribute attribute {};
+    attribute.m_Accessor = accessorIndex;
+
+    for (const SemanticName &semanticName : s_SemanticNames)
+    {
+        size_t nameLength = strlen(semanticName.m_pName);
+
+        if (!semanticName.m_HasSet && strcmp(pName, semanticName.m_pName) == 0)
+        {
+            attribute.m_Semantic = semanticName.m_Semantic;
+            break;
+        }
+
+        if (semanticName.m_HasSet && strncmp(pName, semanticName.m_pName, nameLength) == 0)
+        {
+            char *pEnd = nullptr;
+            unsigned long set = strtoul(pName + nameLength, &pEnd, 10);
+
+            if (pEnd != pName + nameLength && *pEnd == 0 && set <= UINT8_MAX)
+            {
+                attribute.m_Semantic = semanticName.m_Semantic;
+                attribute.m_Set = static_cast<uint8_t>(set);
+            }
+
+            break;
+        }
+    }
+
+    return attribute;
+}
+
+int32_t gltf::ComponentCount(AccessorType type)
+{
+    static constexpr int32_t s_ComponentCounts[] = { 0, 1, 2, 3, 4, 4, 9, 16 };
+    return s_ComponentCounts[static_cast<uint32_t>(type)];
+}
+
+int32_t gltf::ComponentByteSize(int32_t componentType)
+{
+    switch (componentType)
+    {
+    case s_ByteCode:
+    case s_UnsignedByteCode:
+        return 1;
+    case s_ShortCode:
+    case s_UnsignedShortCode:
+        return 2;
+    case s_UnsignedIntCode:
+    case s_FloatCode:
+        return 4;
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "asset_assembler/rapidjson/fwd.h"
+#include "asset_assembler/textures/TextureFormatSelection.h"
+
+namespace asset_assembler
+{
+    namespace gltf
+    {
+        // Index of no element, used for missing references and references past the end of their array
+        static constexpr int32_t s_InvalidIndex = -1;
+
+        static constexpr int32_t s_TrianglesMode = 4;
+
+        enum class AccessorType : uint8_t
+        {
+            Unknown,    // Missing or not a glTF type
+            Scalar,
+            Vec2,
+            Vec3,
+            Vec4,
+            Mat2,
+            Mat3,
+            Mat4
+        };
+
+        // Attribute names with a set index share a semantic, TEXCOORD_1 is TexCoord of set 1
+        enum class AttributeSemantic : uint8_t
+        {
+            Position,
+            Normal,
+            Tangent,
+            TexCoord,
+            Color,
+            Other
+        };
+
+        struct Buffer
+        {
+            int32_t         m_Uri { s_InvalidIndex };               // Offset in Scene::m_Strings
+            int64_t         m_ByteLength { -1 };
+        };
+
+        struct BufferView
+        {
+            int32_t         m_Buffer { s_InvalidIndex };
+            int32_t         m_ByteStride { 0 };                     // 0 when the elements are tightly packed
+            int64_t         m_ByteOffset { 0 };
+            int64_t         m_ByteLength { -1 };
+        };
+
+        // Accessor componentType codes
+        static constexpr int32_t s_ByteCode = 5120;
+        static constexpr int32_t s_UnsignedByteCode = 5121;
+        static constexpr int32_t s_ShortCode = 5122;
+        static constexpr int32_t s_UnsignedShortCode = 5123;
+        static constexpr int32_t s_UnsignedIntCode = 5125;
+        static constexpr int32_t s_FloatCode = 5126;
+
+        struct Accessor
+        {
+            int32_t         m_BufferView { s_InvalidIndex };
+            int32_t         m_ComponentType { 0 };                  // glTF componentType code
+            int64_t         m_ByteOffset { 0 };                     // From the start of the bufferView
+            int64_t         m_Count { -1 };
+            AccessorType    m_Type { AccessorType::Unknown };
+            bool            m_Normalized { false };
+            bool            m_Sparse { false };
+            int32_t         m_SparseIndicesBufferView { s_InvalidIndex };
+            int32_t         m_SparseValuesBufferView { s_InvalidIndex };
+        };
+
+        struct Image
+        {
+            int32_t         m_Uri { s_InvalidIndex };               // Offset in Scene::m_Strings
+            int32_t         m_BufferView { s_InvalidIndex };        // Images embedded in a buffer, as GLB files store them
+        };
+
+        struct Texture
+        {
+            int32_t         m_Image { s_InvalidIndex };
+        };
+
+        struct Material
+        {
+            // Texture sampled by each slot, indexed by textures::TextureUsage
+            int32_t         m_Textures[static_cast<uint32_t>(textures::TextureUsage::Count)]
+            {
+                s_InvalidIndex, s_InvalidIndex, s_InvalidIndex, s_InvalidIndex, s_InvalidIndex
+            };
+        };
+
+        struct Attribute
+        {
+            int32_t             m_Accessor { s_InvalidIndex };
+            AttributeSemantic   m_Semantic { AttributeSemantic::Other };
+            uint8_t             m_Set { 0 };                        // TEXCOORD_n and COLOR_n index, 0 for the others
+        };
+
+        struct Primitive
+        {
+            int32_t         m_Mesh { s_InvalidIndex };
+            int32_t         m_IndexInMesh { 0 };
+            int32_t         m_Mode { s_TrianglesMode };             // s_InvalidIndex when not an integer
+            int32_t         m_Indices { s_InvalidIndex };
+            int32_t         m_Position { s_InvalidIndex };          // Accessor of the POSITION attribute
+            int32_t         m_Material { s_InvalidIndex };
+            uint32_t        m_FirstAttribute { 0 };                 // In Scene::m_Attributes
+            uint32_t        m_AttributeCount { 0 };
+            uint32_t        m_FirstTargetAccessor { 0 };            // In Scene::m_TargetAccessors, every attribute of every morph target
+            uint32_t        m_TargetAccessorCount { 0 };
+            bool            m_HasTargets { false };
+        };
+
+        struct Mesh
+        {
+            uint32_t        m_FirstPrimitive { 0 };                 // In Scene::m_Primitives
+            uint32_t        m_PrimitiveCount { 0 };
+        };
+
+        // Content of a glTF document the build reads, as flat arrays indexed like the glTF arrays. Every index
+        // between them is validated once: references that are missing, not integers or out of range are
+        // s_InvalidIndex, so stages read the arrays directly without looking up or checking anything.
+        // Primitives of every mesh, and the attributes of every primitive, are stored contiguously.
+        struct Scene
+        {
+            std::vector<Image>          m_Images {};
+            std::vector<Texture>        m_Textures {};
+            std::vector<Material>       m_Materials {};
+            std::vector<Buffer>         m_Buffers {};
+            std::vector<BufferView>     m_BufferViews {};
+            std::vector<Accessor>       m_Accessors {};
+            std::vector<Mesh>           m_Meshes {};
+            std::vector<Primitive>      m_Primitives {};
+            std::vector<Attribute>      m_Attributes {};
+            std::vector<int32_t>        m_TargetAccessors {};
+            std::vector<char>           m_Strings {};               // Null-terminated URIs
+
+            // BIN chunk of a GLB file, in the file, set by the caller once the scene is built. The glTF buffer
+            // without uri that it backs is the first one.
+            int64_t                     m_GlbBinByteOffset { -1 };  // -1 for .gltf files and GLB files without BIN chunk
+            int64_t                     m_GlbBinByteSize { 0 };
+
+            const char* String(int32_t offset) const { return offset != s_InvalidIndex ? m_Strings.data() + offset : nullptr; }
+
+            const Attribute* AttributesBegin(const Primitive &primitive) const { return m_Attributes.data() + primitive.m_FirstAttribute; }
+            const Attribute* AttributesEnd(const Primitive &primitive) const { return AttributesBegin(primitive) + primitive.m_AttributeCount; }
+
+            const int32_t* TargetAccessorsBegin(const Primitive &primitive) const { return m_TargetAccessors.data() + primitive.m_FirstTargetAccessor; }
+            const int32_t* TargetAccessorsEnd(const Primitive &primitive) const { return TargetAccessorsBegin(primitive) + primitive.m_TargetAccessorCount; }
+        };
+
+        // Converts the document in a single pass over its members, the document is not needed afterwards
+        void BuildScene(const rapidjson::Document &json, Scene &o_Scene);
+
+        // Replaces the references that are out of range with s_InvalidIndex. Runs once every array is read,
+        // references can point forward to arrays that come later in the document.
+        void ValidateIndices(Scene &io_Scene);
+
+        // Type of an accessor type name, Unknown for other names
+        AccessorType ParseAccessorType(const char *pType);
+
+        // Semantic and set of an attribute name, Other for unknown names
+        Attribute ParseAttribute(const char *pName, int32_t accessorIndex);
+
+        // Components per element, 0 for Unknown
+        int32_t ComponentCount(AccessorType type);
+
+        // Bytes per component of a componentType code, 0 for unknown codes
+        int32_t ComponentByteSize(int32_t componentType);
+    }
+}
@@ -0,0 +1,125 @@
+#include <pch.h>
+#include "Hash.h"
+#include "io/MappedFile.h"
+#include <cstring>
+
+using namespace asset_assembler;
+
+namespace
+{
+    static constexpr uint64_t s_Prime1 = 0x9E3779B185EBCA87ull;
+    static constexpr uint64_t s_Prime2 = 0xC2B2AE3D27D4EB4Full;
+    static constexpr uint64_t s_Prime3 = 0x165667B19E3779F9ull;
+    static constexpr uint64_t s_Prime4 = 0x85EBCA77C2B2AE63ull;
+    static constexpr uint64_t s_Prime5 = 0x27D4EB2F165667C5ull;
+
+    inline uint64_t RotateLeft(uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    inline uint64_t Read64(const uint8_t *pData)
+    {
+        uint64_t value;
+        memcpy(&value, pData, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t Read32(const uint8_t *pData)
+    {
+        uint32_t value;
+        memcpy(&value, pData, sizeof(value));
+        return value;
+    }
+
+    inline uint64_t Round(uint64_t accumulator, uint64_t input)
+    {
+        accumulator += input * s_Prime2;
+        accumulator = RotateLeft(accumulator, 31);
+        return accumulator * s_Prime1;
+    }
+
+    inline uint64_t MergeRound(uint64_t accumulator, uint64_t value)
+    {
+        accumulator ^= Round(0, value);
+        return accumulator * s_Prime1 + s_Prime4;
+    }
+}
+
+uint64_t hashing::Hash64(const void *pData, size_t byteSize, uint64_t seed)
+{
+    const uint8_t *pBytes = static_cast<const uint8_t*>(pData);
+    const uint8_t *pEnd = pBytes + byteSize;
+    uint64_t hash;
+
+    if (byteSize >= 32)
+    {
+        const uint8_t *pLastStripe = pEnd - 32;
+        uint64_t v1 = seed + s_Prime1 + s_Prime2;
+        uint64_t v2 = seed + s_Prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - s_Prime1;
+
+        do
+        {
+            v1 = Round(v1, Read64(pBytes));
+            v2 = Round(v2, Read64(pBytes + 8));
+            v3 = Round(v3, Read64(pBytes + 16));
+            v4 = Round(v4, Read64(pBytes + 24));
+            pBytes += 32;
+        } while (pBytes <= pLastStripe);
+
+        hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+        hash = MergeRound(hash, v1);
+        hash = MergeRound(hash, v2);
+        hash = MergeRound(hash, v3);
+        hash = MergeRound(hash, v4);
+    }
+    else
+    {
+        hash = seed + s_Prime5;
+    }
+
+    hash += static_cast<uint64_t>(byteSize);
+
+    while (pBytes + 8 <= pEnd)
+    {
+        hash ^= Round(0, Read64(pBytes));
+        hash = RotateLeft(hash, 27) * s_Prime1 + s_Prime4;
+        pBytes += 8;
+    }
+
+    if (pBytes + 4 <= pEnd)
+    {
+        hash ^= static_cast<uint64_t>(Read32(pBytes)) * s_Prime1;
+        hash = RotateLeft(hash, 23) * s_Prime2 + s_Prime3;
+        pBytes += 4;
+    }
+
+    while (pBytes < pEnd)
+    {
+        hash ^= (*pBytes) * s_Prime5;
+        hash = RotateLeft(hash, 11) * s_Prime1;
+        ++pBytes;
+    }
+
+    hash ^= hash >> 33;
+    hash *= s_Prime2;
+    hash ^= hash >> 29;
+    hash *= s_Prime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+bool hashing::HashFile(const char *pFilePath, uint64_t &o_Hash)
+{
+    io::MappedFile file;
+    if (!file.Open(pFilePath))
+    {
+        return false;
+    }
+
+    o_Hash = Hash64(file.Data(), file.Size());
+    return true;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace asset_assembler
+{
+    namespace hashing
+    {
+        // 64-bit XXH64 hash of a memory range. Stable across platforms and builds, suitable for content addressing.
+        uint64_t Hash64(const void *pData, size_t byteSize, uint64_t seed = 0);
+
+        // Hash64 of the whole content of a file, read through a memory mapping
+        bool HashFile(const char *pFilePath, uint64_t &o_Hash);
+
+        // Order-dependent combination of two hashes
+        inline uint64_t CombineHashes(uint64_t hash, uint64_t otherHash)
+        {
+            return hash ^ (otherHash + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2));
+        }
+    }
+}
@@ -0,0 +1,158 @@
+#include <pch.h>
+#include "AsyncFileWriter.h"
+#include "profiling/Profiler.h"
+#include <algorithm>
+
+using namespace asset_assembler;
+
+io::AsyncFileWriter::AsyncFileWriter(FILE *pFile, uint32_t bufferCount, size_t bufferByteSize)
+    : m_pFile(pFile)
+    , m_BufferByteSize(bufferByteSize)
+{
+    if (bufferCount == 0 || bufferByteSize == 0)
+    {
+        return;
+    }
+
+    m_Buffers.resize(bufferCount);
+    m_FreeBuffers.reserve(bufferCount);
+
+    for (uint32_t i = 0; i < bufferCount; ++i)
+    {
+        m_Buffers[i].reserve(bufferByteSize);
+        m_FreeBuffers.push_back(bufferCount - 1 - i);
+    }
+
+    m_Thread = std::thread(&AsyncFileWriter::WriterLoop, this);
+}
+
+io::AsyncFileWriter::~AsyncFileWriter()
+{
+    if (m_Thread.joinable())
+    {
+        Flush();
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stopping = true;
+        }
+
+        m_Condition.notify_all();
+        m_Thread.join();
+    }
+}
+
+bool io::AsyncFileWriter::Write(const void *pData, size_t byteSize)
+{
+    if (m_Buffers.empty())
+    {
+        return fwrite(pData, sizeof(uint8_t), byteSize, m_pFile) == byteSize;
+    }
+
+    const uint8_t *pBytes = static_cast<const uint8_t*>(pData);
+
+    while (byteSize > 0 && !m_Failed)
+    {
+        if (m_CurrentBuffer < 0)
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+
+            if (m_FreeBuffers.empty())
+            {
+                profiling::ScopedZone stallZone("WriteStall", -1, &m_StallSeconds);
+                m_Condition.wait(lock, [&]()
+                {
+                    return !m_FreeBuffers.empty();
+                });
+            }
+
+            m_CurrentBuffer = static_cast<int32_t>(m_FreeBuffers.back());
+            m_FreeBuffers.pop_back();
+        }
+
+        std::vector<uint8_t> &buffer = m_Buffers[m_CurrentBuffer];
+        size_t copyByteSize = std::min(byteSize, m_BufferByteSize - buffer.size());
+
+        buffer.insert(buffer.end(), pBytes, pBytes + copyByteSize);
+        pBytes += copyByteSize;
+        byteSize -= copyByteSize;
+
+        if (buffer.size() == m_BufferByteSize)
+        {
+            SubmitCurrentBuffer();
+        }
+    }
+
+    return !m_Failed;
+}
+
+bool io::AsyncFileWriter::Flush()
+{
+    if (m_Buffers.empty())
+    {
+        return !ferror(m_pFile);
+    }
+
+    if (m_CurrentBuffer >= 0)
+    {
+        SubmitCurrentBuffer();
+    }
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Condition.wait(lock, [&]()
+    {
+        return m_FreeBuffers.size() == m_Buffers.size();
+    });
+
+    return !m_Failed;
+}
+
+void io::AsyncFileWriter::SubmitCurrentBuffer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_QueuedBuffers.push_back(static_cast<uint32_t>(m_CurrentBuffer));
+    }
+
+    m_CurrentBuffer = -1;
+    m_Condition.notify_all();
+}
+
+void io::AsyncFileWriter::WriterLoop()
+{
+    for (;;)
+    {
+        uint32_t bufferIndex;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [&]()
+            {
+                return m_Stopping || !m_QueuedBuffers.empty();
+            });
+
+            if (m_QueuedBuffers.empty())
+            {
+                return;
+            }
+
+            bufferIndex = m_QueuedBuffers.front();
+            m_QueuedBuffers.pop_front();
+        }
+
+        // Buffers queued after a failure are dropped, the file is discarded anyway
+        std::vector<uint8_t> &buffer = m_Buffers[bufferIndex];
+        if (!m_Failed && fwrite(buffer.data(), sizeof(uint8_t), buffer.size(), m_pFile) != buffer.size())
+        {
+            m_Failed = true;
+        }
+
+        buffer.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_FreeBuffers.push_back(bufferIndex);
+        }
+
+        m_Condition.notify_all();
+    }
+}
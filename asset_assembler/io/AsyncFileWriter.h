@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+namespace asset_assembler
+{
+    namespace io
+    {
+        // Write-behind stage of a file: content is copied into a pool of pre-sized buffers and written by a dedicated
+        // thread, so the calling thread goes back to processing the next resource while the previous one reaches the
+        // disk. Write blocks once every buffer is queued, which bounds the memory held by pending writes.
+        // Without buffers, content is written synchronously.
+        class AsyncFileWriter
+        {
+        public:
+
+            static constexpr size_t s_DefaultBufferByteSize = 4 * 1024 * 1024;
+
+            AsyncFileWriter(FILE *pFile, uint32_t bufferCount, size_t bufferByteSize = s_DefaultBufferByteSize);
+            ~AsyncFileWriter();
+
+            AsyncFileWriter(const AsyncFileWriter&) = delete;
+            AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+            // Returns false once any write to the file failed
+            bool                Write(const void *pData, size_t byteSize);
+
+            // Waits for every queued buffer to be written, the file can then be accessed directly
+            bool                Flush();
+
+            // Time Write spent waiting for a free buffer
+            double              StallSeconds() const { return m_StallSeconds; }
+
+        private:
+
+            void                SubmitCurrentBuffer();
+            void                WriterLoop();
+
+            FILE*                               m_pFile { nullptr };
+            size_t                              m_BufferByteSize { 0 };
+            std::vector<std::vector<uint8_t>>   m_Buffers {};
+            std::vector<uint32_t>               m_FreeBuffers {};
+            std::deque<uint32_t>                m_QueuedBuffers {};
+            int32_t                             m_CurrentBuffer { -1 };     // Being filled by the calling thread
+            std::mutex                          m_Mutex {};
+            std::condition_variable             m_Condition {};
+            std::thread                         m_Thread {};
+            std::atomic<bool>                   m_Failed { false };
+            bool                                m_Stopping { false };
+            double                              m_StallSeconds { 0.0 };
+        };
+    }
+}
@@ -0,0 +1,158 @@
+#include <pch.h>
+#include "FileCopy.h"
+#include "Salvation_Common/Memory/ThreadHeapAllocator.h"
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace asset_assembler;
+using namespace salvation::memory;
+
+static constexpr size_t s_StreamingChunkSize = 1024 * 1024;
+
+static int64_t StreamFileContent(FILE *pSrcFile, FILE *pDestFile)
+{
+    uint8_t *pChunk = static_cast<uint8_t*>(ThreadHeapAllocator::Allocate(s_StreamingChunkSize));
+    int64_t copiedByteSize = 0;
+
+    for (;;)
+    {
+        size_t readSize = fread(pChunk, sizeof(uint8_t), s_StreamingChunkSize, pSrcFile);
+        if (readSize == 0)
+        {
+            break;
+        }
+
+        if (fwrite(pChunk, sizeof(uint8_t), readSize, pDestFile) != readSize)
+        {
+            copiedByteSize = -1;
+            break;
+        }
+
+        copiedByteSize += static_cast<int64_t>(readSize);
+    }
+
+    if (ferror(pSrcFile))
+    {
+        copiedByteSize = -1;
+    }
+
+    ThreadHeapAllocator::Release(pChunk);
+
+    return copiedByteSize;
+}
+
+#if defined(__linux__)
+
+// Returns the number of bytes copied kernel-side, which can be less than byteSize if the
+// file systems involved don't support it. Returns -1 on a hard I/O error.
+static int64_t KernelCopy(int srcFd, int destFd, int64_t byteSize)
+{
+    int64_t copiedByteSize = 0;
+    bool useCopyFileRange = true;
+
+    while (copiedByteSize < byteSize)
+    {
+        size_t remaining = static_cast<size_t>(byteSize - copiedByteSize);
+        ssize_t result = useCopyFileRange ?
+            copy_file_range(srcFd, nullptr, destFd, nullptr, remaining, 0) :
+            sendfile(destFd, srcFd, nullptr, remaining);
+
+        if (result > 0)
+        {
+            copiedByteSize += result;
+        }
+        else if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (result < 0 && useCopyFileRange && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP))
+        {
+            useCopyFileRange = false;
+        }
+        else if (result < 0 && (errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+        {
+            break;
+        }
+        else
+        {
+            return result < 0 ? -1 : copiedByteSize;
+        }
+    }
+
+    return copiedByteSize;
+}
+
+int64_t io::AppendFileContent(const char *pSrcFilePath, FILE *pDestFile)
+{
+    int srcFd = open(pSrcFilePath, O_RDONLY);
+    if (srcFd < 0)
+    {
+        return -1;
+    }
+
+    struct stat srcStat;
+    if (fstat(srcFd, &srcStat) != 0 || fflush(pDestFile) != 0)
+    {
+        close(srcFd);
+        return -1;
+    }
+
+    int64_t byteSize = static_cast<int64_t>(srcStat.st_size);
+    int64_t copiedByteSize = KernelCopy(srcFd, fileno(pDestFile), byteSize);
+
+    // Kernel-side copies move the descriptor offset behind stdio's back
+    if (copiedByteSize < 0 || fseek(pDestFile, 0, SEEK_END) != 0)
+    {
+        close(srcFd);
+        return -1;
+    }
+
+    if (copiedByteSize < byteSize)
+    {
+        FILE *pSrcFile = fdopen(srcFd, "rb");
+        if (!pSrcFile)
+        {
+            close(srcFd);
+            return -1;
+        }
+
+        if (fseek(pSrcFile, static_cast<long>(copiedByteSize), SEEK_SET) != 0)
+        {
+            fclose(pSrcFile);
+            return -1;
+        }
+
+        int64_t streamedByteSize = StreamFileContent(pSrcFile, pDestFile);
+        fclose(pSrcFile);
+
+        return streamedByteSize < 0 ? -1 : copiedByteSize + streamedByteSize;
+    }
+
+    close(srcFd);
+
+    return copiedByteSize;
+}
+
+#else
+
+int64_t io::AppendFileContent(const char *pSrcFilePath, FILE *pDestFile)
+{
+    FILE *pSrcFile = nullptr;
+    if (fopen_s(&pSrcFile, pSrcFilePath, "rb") != 0 || !pSrcFile)
+    {
+        return -1;
+    }
+
+    int64_t copiedByteSize = StreamFileContent(pSrcFile, pDestFile);
+    fclose(pSrcFile);
+
+    return copiedByteSize;
+}
+
+#endif
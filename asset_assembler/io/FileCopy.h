@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <stdio.h>
+
+namespace asset_assembler
+{
+    namespace io
+    {
+        // Appends the whole content of pSrcFilePath at the current position of pDestFile and returns the number
+        // of bytes copied, or -1 on failure. On Linux the copy is done kernel-side (copy_file_range, then sendfile)
+        // without going through user-space memory. Other platforms, or file systems that do not support either,
+        // fall back to streaming through a fixed-size buffer so memory usage stays flat regardless of file size.
+        int64_t AppendFileContent(const char *pSrcFilePath, FILE *pDestFile);
+    }
+}
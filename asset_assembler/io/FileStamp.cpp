@@ -0,0 +1,28 @@
+#include <pch.h>
+#include "FileStamp.h"
+#include <filesystem>
+
+using namespace asset_assembler;
+namespace fs = std::filesystem;
+
+bool io::ReadFileStamp(const char *pFilePath, FileStamp &o_Stamp)
+{
+    std::error_code error;
+
+    uintmax_t byteSize = fs::file_size(pFilePath, error);
+    if (error)
+    {
+        return false;
+    }
+
+    fs::file_time_type modifiedTime = fs::last_write_time(pFilePath, error);
+    if (error)
+    {
+        return false;
+    }
+
+    o_Stamp.m_ByteSize = static_cast<int64_t>(byteSize);
+    o_Stamp.m_ModifiedTime = static_cast<int64_t>(modifiedTime.time_since_epoch().count());
+
+    return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+namespace asset_assembler
+{
+    namespace io
+    {
+        // Size and last modification time of a file. Comparing stamps between builds is enough to skip
+        // files that were not touched, without reading their content.
+        struct FileStamp
+        {
+            int64_t     m_ByteSize { -1 };
+            int64_t     m_ModifiedTime { 0 };   // Native file clock ticks, only meaningful for comparisons
+        };
+
+        bool ReadFileStamp(const char *pFilePath, FileStamp &o_Stamp);
+
+        inline bool operator==(const FileStamp &a, const FileStamp &b)
+        {
+            return a.m_ByteSize == b.m_ByteSize && a.m_ModifiedTime == b.m_ModifiedTime;
+        }
+    }
+}
@@ -0,0 +1,508 @@
+#include <pch.h>
+#include "GltfJsonStream.h"
+#include "gltf/GltfScene.h"
+#include "rapidjson/memorystream.h"
+#include "rapidjson/reader.h"
+#include <climits>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace asset_assembler;
+using namespace asset_assembler::gltf;
+using namespace rapidjson;
+
+namespace
+{
+    // What a container holds, decides how its values are read into the scene
+    enum class Frame : uint8_t
+    {
+        Skipped,                // Not read by the build, along with everything it contains
+        Root,
+        Images,                 // Top-level arrays
+        Textures,
+        Materials,
+        Buffers,
+        BufferViews,
+        Accessors,
+        Meshes,
+        Image,                  // Elements of the top-level arrays
+        Texture,
+        Material,
+        Buffer,
+        BufferView,
+        Accessor,
+        Mesh,
+        PbrMetallicRoughness,
+        TextureInfo,
+        Sparse,
+        SparseView,             // indices or values of a sparse accessor
+        Primitives,
+        Primitive,
+        Attributes,
+        Targets,
+        Target
+    };
+
+    struct Scope
+    {
+        Frame       m_Frame { Frame::Skipped };
+        int32_t     m_ElementCount { 0 };       // Values read in an array
+        uint32_t    m_Slot { 0 };               // TextureUsage of a TextureInfo, 0 for indices and 1 for values of a SparseView
+        bool        m_IndexRead { false };      // The first index of a TextureInfo is the one read
+    };
+
+    // A value as BuildScene tests it, containers are values that are neither of these
+    struct ScalarValue
+    {
+        bool            m_IsInt { false };      // Fits int32_t
+        bool            m_IsInt64 { false };
+        bool            m_IsBool { false };
+        bool            m_Bool { false };
+        int64_t         m_Int { 0 };
+        const char*     m_pStr { nullptr };     // Null-terminated by the reader
+        SizeType        m_Length { 0 };
+    };
+
+    inline ScalarValue IntValue(int64_t i)
+    {
+        ScalarValue value {};
+        value.m_IsInt = i >= INT_MIN && i <= INT_MAX;
+        value.m_IsInt64 = true;
+        value.m_Int = i;
+        return value;
+    }
+
+    inline int32_t ReadIndex(const ScalarValue &value)
+    {
+        return value.m_IsInt && value.m_Int >= 0 ? static_cast<int32_t>(value.m_Int) : s_InvalidIndex;
+    }
+
+    inline int64_t ReadInt64(const ScalarValue &value, int64_t defaultValue)
+    {
+        return value.m_IsInt64 ? value.m_Int : defaultValue;
+    }
+
+    int32_t AddString(const ScalarValue &value, std::vector<char> &io_Strings)
+    {
+        if (!value.m_pStr)
+        {
+            return s_InvalidIndex;
+        }
+
+        int32_t offset = static_cast<int32_t>(io_Strings.size());
+        io_Strings.insert(io_Strings.end(), value.m_pStr, value.m_pStr + value.m_Length);
+        io_Strings.push_back(0);
+
+        return offset;
+    }
+
+    // Fills the scene from the SAX events of the reader, reading each value the way BuildScene reads it from a
+    // document. Elements are added to the scene when they start, so the members that follow fill the last one.
+    class SceneHandler
+    {
+    public:
+
+        explicit SceneHandler(Scene &scene) : m_Scene(scene) {}
+
+        bool Null() { return Read(ScalarValue {}); }
+        bool Bool(bool b) { ScalarValue value {}; value.m_IsBool = true; value.m_Bool = b; return Read(value); }
+        bool Int(int i) { return Read(IntValue(i)); }
+        bool Uint(unsigned u) { return Read(IntValue(u)); }
+        bool Int64(int64_t i) { return Read(IntValue(i)); }
+        bool Double(double) { return Read(ScalarValue {}); }
+        bool RawNumber(const char*, SizeType, bool) { return Read(ScalarValue {}); }
+        bool String(const char *pStr, SizeType length, bool) { ScalarValue value {}; value.m_pStr = pStr; value.m_Length = length; return Read(value); }
+
+        bool Uint64(uint64_t u)
+        {
+            ScalarValue value {};
+            if (u <= static_cast<uint64_t>(INT64_MAX))
+            {
+                value = IntValue(static_cast<int64_t>(u));
+            }
+
+            return Read(value);
+        }
+
+        bool StartObject() { return Open(true); }
+        bool StartArray() { return Open(false); }
+        bool EndObject(SizeType) { return Close(); }
+        bool EndArray(SizeType) { return Close(); }
+
+        bool Key(const char *pStr, SizeType length, bool)
+        {
+            // The reader reuses the string once the event returns
+            if (!m_Scopes.empty() && m_Scopes.back().m_Frame != Frame::Skipped)
+            {
+                m_Key.assign(pStr, length);
+            }
+
+            return true;
+        }
+
+    private:
+
+        bool IsKey(const char *pName) const { return m_Key == pName; }
+
+        bool Read(const ScalarValue &value)
+        {
+            if (!m_Scopes.empty() && m_Scopes.back().m_Frame != Frame::Skipped)
+            {
+                ReadValue(value, false, false);
+            }
+
+            return true;
+        }
+
+        bool Open(bool isObject)
+        {
+            Scope scope {};
+
+            if (m_Scopes.empty())
+            {
+                // BuildScene reads nothing from a document that isn't an object
+                scope.m_Frame = isObject ? Frame::Root : Frame::Skipped;
+            }
+            else if (m_Scopes.back().m_Frame != Frame::Skipped)
+            {
+                scope = ReadValue(ScalarValue {}, isObject, !isObject);
+            }
+
+            m_Scopes.push_back(scope);
+            return true;
+        }
+
+        bool Close()
+        {
+            Frame frame = m_Scopes.back().m_Frame;
+
+            if (frame == Frame::Primitive)
+            {
+                Primitive &primitive = m_Scene.m_Primitives.back();
+                primitive.m_AttributeCount = static_cast<uint32_t>(m_Scene.m_Attributes.size()) - primitive.m_FirstAttribute;
+                primitive.m_TargetAccessorCount = static_cast<uint32_t>(m_Scene.m_TargetAccessors.size()) - primitive.m_FirstTargetAccessor;
+            }
+            else if (frame == Frame::Mesh)
+            {
+                Mesh &mesh = m_Scene.m_Meshes.back();
+                mesh.m_PrimitiveCount = static_cast<uint32_t>(m_Scene.m_Primitives.size()) - mesh.m_FirstPrimitive;
+            }
+
+            m_Scopes.pop_back();
+            return true;
+        }
+
+        Scope OpenTextureInfo(textures::TextureUsage usage, bool isObject)
+        {
+            m_Scene.m_Materials.back().m_Textures[static_cast<uint32_t>(usage)] = s_InvalidIndex;
+            return isObject ? Scope { Frame::TextureInfo, 0, static_cast<uint32_t>(usage), false } : Scope {};
+        }
+
+        // Reads a value of the innermost scope, either the member named m_Key or the next element of an array.
+        // Returns the scope of the container the value opens, Skipped for scalar values and containers not read.
+        Scope ReadValue(const ScalarValue &value, bool isObject, bool isArray)
+        {
+            Scope &scope = m_Scopes.back();
+
+            switch (scope.m_Frame)
+            {
+            case Frame::Root:
+            {
+                static constexpr struct { const char *m_pName; Frame m_Frame; } s_Arrays[] =
+                {
+                    { "images", Frame::Images },
+                    { "textures", Frame::Textures },
+                    { "materials", Frame::Materials },
+                    { "buffers", Frame::Buffers },
+                    { "bufferViews", Frame::BufferViews },
+                    { "accessors", Frame::Accessors },
+                    { "meshes", Frame::Meshes },
+                };
+
+                for (const auto &array : s_Arrays)
+                {
+                    if (isArray && IsKey(array.m_pName))
+                    {
+                        return { array.m_Frame };
+                    }
+                }
+
+                break;
+            }
+
+            // Elements that aren't objects keep their slot with default values, so indices still match the document
+            case Frame::Images:
+                m_Scene.m_Images.push_back({});
+                return { isObject ? Frame::Image : Frame::Skipped };
+
+            case Frame::Textures:
+                m_Scene.m_Textures.push_back({});
+                return { isObject ? Frame::Texture : Frame::Skipped };
+
+            case Frame::Materials:
+                m_Scene.m_Materials.push_back({});
+                return { isObject ? Frame::Material : Frame::Skipped };
+
+            case Frame::Buffers:
+                m_Scene.m_Buffers.push_back({});
+                return { isObject ? Frame::Buffer : Frame::Skipped };
+
+            case Frame::BufferViews:
+                m_Scene.m_BufferViews.push_back({});
+                return { isObject ? Frame::BufferView : Frame::Skipped };
+
+            case Frame::Accessors:
+                m_Scene.m_Accessors.push_back({});
+                return { isObject ? Frame::Accessor : Frame::Skipped };
+
+            case Frame::Meshes:
+            {
+                Mesh mesh {};
+                mesh.m_FirstPrimitive = static_cast<uint32_t>(m_Scene.m_Primitives.size());
+                m_Scene.m_Meshes.push_back(mesh);
+                return { isObject ? Frame::Mesh : Frame::Skipped };
+            }
+
+            case Frame::Image:
+                if (IsKey("uri"))
+                {
+                    m_Scene.m_Images.back().m_Uri = AddString(value, m_Scene.m_Strings);
+                }
+                else if (IsKey("bufferView"))
+                {
+                    m_Scene.m_Images.back().m_BufferView = ReadIndex(value);
+                }
+                break;
+
+            case Frame::Texture:
+                if (IsKey("source"))
+                {
+                    m_Scene.m_Textures.back().m_Image = ReadIndex(value);
+                }
+                break;
+
+            case Frame::Material:
+                if (IsKey("pbrMetallicRoughness") && isObject)
+                {
+                    return { Frame::PbrMetallicRoughness };
+                }
+                else if (IsKey("normalTexture"))
+                {
+                    return OpenTextureInfo(textures::TextureUsage::Normal, isObject);
+                }
+                else if (IsKey("occlusionTexture"))
+                {
+                    return OpenTextureInfo(textures::TextureUsage::Occlusion, isObject);
+                }
+                else if (IsKey("emissiveTexture"))
+                {
+                    return OpenTextureInfo(textures::TextureUsage::Emissive, isObject);
+                }
+                break;
+
+            case Frame::PbrMetallicRoughness:
+                if (IsKey("baseColorTexture"))
+                {
+                    return OpenTextureInfo(textures::TextureUsage::BaseColor, isObject);
+                }
+                else if (IsKey("metallicRoughnessTexture"))
+                {
+                    return OpenTextureInfo(textures::TextureUsage::MetallicRoughness, isObject);
+                }
+                break;
+
+            case Frame::TextureInfo:
+                if (IsKey("index") && !scope.m_IndexRead)
+                {
+                    m_Scene.m_Materials.back().m_Textures[scope.m_Slot] = ReadIndex(value);
+                    scope.m_IndexRead = true;
+                }
+                break;
+
+            case Frame::Buffer:
+            {
+                Buffer &buffer = m_Scene.m_Buffers.back();
+
+                if (IsKey("uri"))
+                {
+                    buffer.m_Uri = AddString(value, m_Scene.m_Strings);
+                }
+                else if (IsKey("byteLength"))
+                {
+                    buffer.m_ByteLength = ReadInt64(value, -1);
+                }
+                break;
+            }
+
+            case Frame::BufferView:
+            {
+                BufferView &bufferView = m_Scene.m_BufferViews.back();
+
+                if (IsKey("buffer"))
+                {
+                    bufferView.m_Buffer = ReadIndex(value);
+                }
+                else if (IsKey("byteOffset"))
+                {
+                    bufferView.m_ByteOffset = ReadInt64(value, 0);
+                }
+                else if (IsKey("byteLength"))
+                {
+                    bufferView.m_ByteLength = ReadInt64(value, -1);
+                }
+                else if (IsKey("byteStride"))
+                {
+                    bufferView.m_ByteStride = static_cast<int32_t>(ReadInt64(value, 0));
+                }
+                break;
+            }
+
+            case Frame::Accessor:
+            {
+                Accessor &accessor = m_Scene.m_Accessors.back();
+
+                if (IsKey("bufferView"))
+                {
+                    accessor.m_BufferView = ReadIndex(value);
+                }
+                else if (IsKey("byteOffset"))
+                {
+                    accessor.m_ByteOffset = ReadInt64(value, 0);
+                }
+                else if (IsKey("componentType"))
+                {
+                    accessor.m_ComponentType = value.m_IsInt ? static_cast<int32_t>(value.m_Int) : 0;
+                }
+                else if (IsKey("count"))
+                {
+                    accessor.m_Count = ReadInt64(value, -1);
+                }
+                else if (IsKey("type"))
+                {
+                    accessor.m_Type = value.m_pStr ? ParseAccessorType(value.m_pStr) : AccessorType::Unknown;
+                }
+                else if (IsKey("normalized"))
+                {
+                    accessor.m_Normalized = value.m_IsBool && value.m_Bool;
+                }
+                else if (IsKey("sparse"))
+                {
+                    accessor.m_Sparse = true;
+                    return { isObject ? Frame::Sparse : Frame::Skipped };
+                }
+                break;
+            }
+
+            case Frame::Sparse:
+                if ((IsKey("indices") || IsKey("values")) && isObject)
+                {
+                    return { Frame::SparseView, 0, IsKey("indices") ? 0u : 1u, false };
+                }
+                break;
+
+            case Frame::SparseView:
+                if (IsKey("bufferView"))
+                {
+                    Accessor &accessor = m_Scene.m_Accessors.back();
+                    (scope.m_Slot == 0 ? accessor.m_SparseIndicesBufferView : accessor.m_SparseValuesBufferView) = ReadIndex(value);
+                }
+                break;
+
+            case Frame::Mesh:
+                if (IsKey("primitives") && isArray)
+                {
+                    return { Frame::Primitives };
+                }
+                break;
+
+            case Frame::Primitives:
+            {
+                Primitive primitive {};
+                primitive.m_Mesh = static_cast<int32_t>(m_Scene.m_Meshes.size()) - 1;
+                primitive.m_IndexInMesh = scope.m_ElementCount++;
+                primitive.m_FirstAttribute = static_cast<uint32_t>(m_Scene.m_Attributes.size());
+                primitive.m_FirstTargetAccessor = static_cast<uint32_t>(m_Scene.m_TargetAccessors.size());
+                m_Scene.m_Primitives.push_back(primitive);
+                return { isObject ? Frame::Primitive : Frame::Skipped };
+            }
+
+            case Frame::Primitive:
+            {
+                Primitive &primitive = m_Scene.m_Primitives.back();
+
+                if (IsKey("attributes") && isObject)
+                {
+                    return { Frame::Attributes };
+                }
+                else if (IsKey("indices"))
+                {
+                    primitive.m_Indices = ReadIndex(value);
+                }
+                else if (IsKey("material"))
+                {
+                    primitive.m_Material = ReadIndex(value);
+                }
+                else if (IsKey("mode"))
+                {
+                    primitive.m_Mode = value.m_IsInt ? static_cast<int32_t>(value.m_Int) : s_InvalidIndex;
+                }
+                else if (IsKey("targets"))
+                {
+                    primitive.m_HasTargets = true;
+                    return { isArray ? Frame::Targets : Frame::Skipped };
+                }
+                break;
+            }
+
+            case Frame::Attributes:
+            {
+                Attribute attribute = ParseAttribute(m_Key.c_str(), ReadIndex(value));
+                m_Scene.m_Attributes.push_back(attribute);
+
+                if (attribute.m_Semantic == AttributeSemantic::Position)
+                {
+                    m_Scene.m_Primitives.back().m_Position = attribute.m_Accessor;
+                }
+                break;
+            }
+
+            case Frame::Targets:
+                return { isObject ? Frame::Target : Frame::Skipped };
+
+            case Frame::Target:
+                if (value.m_IsInt)
+                {
+                    m_Scene.m_TargetAccessors.push_back(ReadIndex(value));
+                }
+                break;
+
+            default:
+                break;
+            }
+
+            return {};
+        }
+
+        Scene&              m_Scene;
+        std::vector<Scope>  m_Scopes {};
+        std::string         m_Key {};       // Last member name of the innermost object read
+    };
+}
+
+bool io::ReadGltfSceneStream(const char *pText, size_t textByteSize, Scene &o_Scene)
+{
+    o_Scene = {};
+
+    MemoryStream stream(pText, textByteSize);
+    SceneHandler handler(o_Scene);
+    Reader reader;
+
+    if (reader.Parse(stream, handler).IsError())
+    {
+        return false;
+    }
+
+    ValidateIndices(o_Scene);
+    return true;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+namespace asset_assembler
+{
+    namespace gltf
+    {
+        struct Scene;
+    }
+
+    namespace io
+    {
+        // Reads the glTF JSON text into o_Scene with a SAX reader, without building a document. Only the members
+        // the scene keeps are read (images, textures, buffers, bufferViews, accessors, materials and meshes), every
+        // other value is skipped as it is parsed, so memory doesn't grow with the size of the text.
+        // The text is read in place and doesn't need to be null-terminated, such as a mapped .gltf file or the
+        // JSON chunk of a mapped GLB file. Returns false when the text isn't valid JSON.
+        bool ReadGltfSceneStream(const char *pText, size_t textByteSize, gltf::Scene &o_Scene);
+    }
+}
@@ -0,0 +1,63 @@
+#include <pch.h>
+#include "JsonArena.h"
+#include "Salvation_Common/Memory/ThreadHeapAllocator.h"
+#include <cstring>
+
+using namespace asset_assembler::io;
+using namespace salvation::memory;
+
+namespace
+{
+    // Past the pool, the document grows by chunks of this size
+    static constexpr size_t s_OverflowChunkByteSize = 16 * 1024 * 1024;
+
+    // Room for the header the allocator keeps at the start of the pool
+    static constexpr size_t s_PoolHeaderByteSize = 64;
+}
+
+JsonArena::~JsonArena()
+{
+    Release();
+}
+
+bool JsonArena::Init(const uint8_t *pText, size_t textByteSize, size_t poolByteSize)
+{
+    Release();
+
+    size_t poolByteOffset = RAPIDJSON_ALIGN(textByteSize + 1);
+    poolByteSize = RAPIDJSON_ALIGN(poolByteSize) + s_PoolHeaderByteSize;
+
+    m_pBlock = static_cast<uint8_t*>(ThreadHeapAllocator::Allocate(poolByteOffset + poolByteSize));
+    if (!m_pBlock)
+    {
+        return false;
+    }
+
+    m_pText = reinterpret_cast<char*>(m_pBlock);
+    m_TextByteSize = textByteSize;
+    memcpy(m_pText, pText, textByteSize);
+    m_pText[textByteSize] = 0;
+
+    m_Allocator.emplace(m_pBlock + poolByteOffset, poolByteSize, s_OverflowChunkByteSize);
+    return true;
+}
+
+void JsonArena::Release()
+{
+    // Overflow chunks are freed by the allocator, the pool is part of the block
+    m_Allocator.reset();
+
+    if (m_pBlock)
+    {
+        ThreadHeapAllocator::Release(m_pBlock);
+        m_pBlock = nullptr;
+    }
+
+    m_pText = nullptr;
+    m_TextByteSize = 0;
+}
+
+size_t JsonArena::PeakByteSize() const
+{
+    return m_Allocator ? m_TextByteSize + 1 + m_Allocator->Capacity() : 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include "asset_assembler/rapidjson/allocators.h"
+
+namespace asset_assembler
+{
+    namespace io
+    {
+        // Single ThreadHeapAllocator block holding a writable, null-terminated copy of a JSON text followed by the
+        // memory pool of the document parsed in-situ from it. Strings of the document point into the text and its
+        // values are bumped from the pool, so nothing is allocated per string and the whole document is released
+        // at once with the arena, which must outlive it. Once the pool is full, the allocator falls back to chunks
+        // of the CRT heap.
+        class JsonArena
+        {
+        public:
+
+            JsonArena() = default;
+            ~JsonArena();
+
+            JsonArena(const JsonArena&) = delete;
+            JsonArena& operator=(const JsonArena&) = delete;
+
+            bool                                    Init(const uint8_t *pText, size_t textByteSize, size_t poolByteSize);
+            void                                    Release();
+
+            char*                                   Text() const { return m_pText; }
+            rapidjson::MemoryPoolAllocator<>&       Allocator() { return *m_Allocator; }
+
+            // Bytes reserved for the text and every chunk of the pool
+            size_t                                  PeakByteSize() const;
+
+        private:
+
+            uint8_t*                                m_pBlock { nullptr };
+            char*                                   m_pText { nullptr };
+            size_t                                  m_TextByteSize { 0 };
+            std::optional<rapidjson::MemoryPoolAllocator<>> m_Allocator {};
+        };
+    }
+}
@@ -0,0 +1,150 @@
+#include <pch.h>
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace asset_assembler::io;
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const char *pFilePath)
+{
+    Close();
+
+    HANDLE fileHandle = CreateFileA(
+        pFilePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    m_FileHandle = fileHandle;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize))
+    {
+        Close();
+        return false;
+    }
+
+    m_Size = static_cast<size_t>(fileSize.QuadPart);
+
+    // Empty files cannot be mapped, they are exposed as an empty view
+    if (m_Size > 0)
+    {
+        m_MappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_MappingHandle)
+        {
+            Close();
+            return false;
+        }
+
+        m_pData = static_cast<const uint8_t*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (!m_pData)
+        {
+            Close();
+            return false;
+        }
+    }
+
+    m_IsOpen = true;
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_pData)
+    {
+        UnmapViewOfFile(m_pData);
+    }
+
+    if (m_MappingHandle)
+    {
+        CloseHandle(m_MappingHandle);
+    }
+
+    if (m_FileHandle)
+    {
+        CloseHandle(m_FileHandle);
+    }
+
+    m_FileHandle = nullptr;
+    m_MappingHandle = nullptr;
+    m_pData = nullptr;
+    m_Size = 0;
+    m_IsOpen = false;
+}
+
+#else
+
+bool MappedFile::Open(const char *pFilePath)
+{
+    Close();
+
+    m_FileDescriptor = open(pFilePath, O_RDONLY);
+    if (m_FileDescriptor < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(m_FileDescriptor, &fileStat) != 0)
+    {
+        Close();
+        return false;
+    }
+
+    m_Size = static_cast<size_t>(fileStat.st_size);
+
+    // Empty files cannot be mapped, they are exposed as an empty view
+    if (m_Size > 0)
+    {
+        void *pData = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0);
+        if (pData == MAP_FAILED)
+        {
+            Close();
+            return false;
+        }
+
+        madvise(pData, m_Size, MADV_SEQUENTIAL);
+        m_pData = static_cast<const uint8_t*>(pData);
+    }
+
+    m_IsOpen = true;
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_pData)
+    {
+        munmap(const_cast<uint8_t*>(m_pData), m_Size);
+    }
+
+    if (m_FileDescriptor >= 0)
+    {
+        close(m_FileDescriptor);
+    }
+
+    m_FileDescriptor = -1;
+    m_pData = nullptr;
+    m_Size = 0;
+    m_IsOpen = false;
+}
+
+#endif
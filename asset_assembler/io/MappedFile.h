@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace asset_assembler
+{
+    namespace io
+    {
+        // Read-only view of a whole file mapped in memory. Pages are loaded lazily by the OS
+        // as they are accessed, so large inputs are never copied into the heap.
+        class MappedFile
+        {
+        public:
+
+            MappedFile() = default;
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            bool                Open(const char *pFilePath);
+            void                Close();
+
+            bool                IsOpen() const { return m_IsOpen; }
+            const uint8_t*      Data() const { return m_pData; }
+            size_t              Size() const { return m_Size; }
+
+        private:
+
+#if defined(_WIN32)
+            void*               m_FileHandle { nullptr };
+            void*               m_MappingHandle { nullptr };
+#else
+            int                 m_FileDescriptor { -1 };
+#endif
+            const uint8_t*      m_pData { nullptr };
+            size_t              m_Size { 0 };
+            bool                m_IsOpen { false };
+        };
+    }
+}
@@ -0,0 +1,159 @@
+#include <pch.h>
+#include "PackedFileWriter.h"
+#include "FileCopy.h"
+#include "MappedFile.h"
+#include "compression/LZ4Block.h"
+#include "threading/OrderedParallelFor.h"
+#include <algorithm>
+
+using namespace asset_assembler;
+
+io::PackedFileWriter::PackedFileWriter(
+    FILE *pFile, int64_t byteOffset, int64_t fileByteOffset, uint32_t chunkByteSize, uint32_t fileAlignment,
+    uint32_t workerCount, uint32_t writeQueueLength)
+    : m_pFile(pFile)
+    , m_FileWriter(pFile, writeQueueLength)
+    , m_ByteOffset(byteOffset)
+    , m_FileByteOffset(fileByteOffset)
+    , m_ChunkByteSize(chunkByteSize)
+    , m_FileAlignment(std::max(fileAlignment, 1u))
+    , m_WorkerCount(std::max(workerCount, 1u))
+{
+}
+
+bool io::PackedFileWriter::Write(const void *pData, size_t byteSize)
+{
+    if (!IsChunked())
+    {
+        if (!m_FileWriter.Write(pData, byteSize))
+        {
+            return false;
+        }
+
+        m_ByteOffset += byteSize;
+        m_FileByteOffset += byteSize;
+        return true;
+    }
+
+    const uint8_t *pBytes = static_cast<const uint8_t*>(pData);
+
+    while (byteSize > 0)
+    {
+        if (m_PendingChunks.empty() || m_PendingChunks.back().size() == m_ChunkByteSize)
+        {
+            // Enough full chunks to keep every worker busy
+            if (m_PendingChunks.size() >= m_WorkerCount * 2 && !FlushPendingChunks())
+            {
+                return false;
+            }
+
+            m_PendingChunks.emplace_back();
+            m_PendingChunks.back().reserve(m_ChunkByteSize);
+        }
+
+        std::vector<uint8_t> &chunk = m_PendingChunks.back();
+        size_t copyByteSize = std::min(byteSize, m_ChunkByteSize - chunk.size());
+
+        chunk.insert(chunk.end(), pBytes, pBytes + copyByteSize);
+        pBytes += copyByteSize;
+        byteSize -= copyByteSize;
+        m_ByteOffset += copyByteSize;
+    }
+
+    return true;
+}
+
+int64_t io::PackedFileWriter::AppendFileContent(const char *pSrcFilePath)
+{
+    // Copied kernel-side once the queued content is in the file
+    if (!IsChunked())
+    {
+        int64_t byteSize = m_FileWriter.Flush() ? io::AppendFileContent(pSrcFilePath, m_pFile) : -1;
+        if (byteSize > 0)
+        {
+            m_ByteOffset += byteSize;
+            m_FileByteOffset += byteSize;
+        }
+
+        return byteSize;
+    }
+
+    MappedFile srcFile;
+    if (!srcFile.Open(pSrcFilePath) || !Write(srcFile.Data(), srcFile.Size()))
+    {
+        return -1;
+    }
+
+    return static_cast<int64_t>(srcFile.Size());
+}
+
+bool io::PackedFileWriter::Finish()
+{
+    bool success = !IsChunked() || FlushPendingChunks();
+    return m_FileWriter.Flush() && success;
+}
+
+bool io::PackedFileWriter::FlushPendingChunks()
+{
+    static constexpr uint8_t s_Zeros[4096] = {};
+
+    size_t chunkCount = m_PendingChunks.size();
+    std::vector<std::vector<uint8_t>> compressedChunks(chunkCount);
+    int64_t byteOffset = m_ByteOffset;
+
+    for (const std::vector<uint8_t> &chunk : m_PendingChunks)
+    {
+        byteOffset -= chunk.size();
+    }
+
+    bool success = threading::OrderedParallelFor(static_cast<uint32_t>(chunkCount), m_WorkerCount, m_WorkerCount * 2,
+        [&](uint32_t i)
+        {
+            const std::vector<uint8_t> &chunk = m_PendingChunks[i];
+            std::vector<uint8_t> &compressed = compressedChunks[i];
+
+            compressed.resize(compression::LZ4CompressBound(chunk.size()));
+            compressed.resize(compression::LZ4CompressBlock(chunk.data(), chunk.size(), compressed.data(), compressed.size()));
+        },
+        [&](uint32_t i)
+        {
+            const std::vector<uint8_t> &chunk = m_PendingChunks[i];
+            const std::vector<uint8_t> &compressed = compressedChunks[i];
+            bool stored = compressed.empty() || compressed.size() >= chunk.size();
+
+            int64_t alignedFileByteOffset = (m_FileByteOffset + m_FileAlignment - 1) & ~static_cast<int64_t>(m_FileAlignment - 1);
+            for (int64_t padding = alignedFileByteOffset - m_FileByteOffset; padding > 0;)
+            {
+                size_t paddingByteSize = static_cast<size_t>(std::min<int64_t>(padding, sizeof(s_Zeros)));
+                if (!m_FileWriter.Write(s_Zeros, paddingByteSize))
+                {
+                    return false;
+                }
+
+                padding -= paddingByteSize;
+            }
+
+            PackedChunk entry {};
+            entry.m_ByteOffset = byteOffset;
+            entry.m_ByteSize = static_cast<int64_t>(chunk.size());
+            entry.m_FileByteOffset = alignedFileByteOffset;
+            entry.m_FileByteSize = static_cast<int64_t>(stored ? chunk.size() : compressed.size());
+            entry.m_Codec = stored ? ChunkCodec::Stored : ChunkCodec::LZ4Block;
+
+            const uint8_t *pData = stored ? chunk.data() : compressed.data();
+            if (!m_FileWriter.Write(pData, static_cast<size_t>(entry.m_FileByteSize)))
+            {
+                return false;
+            }
+
+            m_Chunks.push_back(entry);
+            m_FileByteOffset = entry.m_FileByteOffset + entry.m_FileByteSize;
+            byteOffset += entry.m_ByteSize;
+
+            return true;
+        });
+
+    m_PendingChunks.clear();
+
+    return success;
+}
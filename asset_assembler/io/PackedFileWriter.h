@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <stdio.h>
+#include <vector>
+#include "AsyncFileWriter.h"
+
+namespace asset_assembler
+{
+    namespace io
+    {
+        enum class ChunkCodec : int32_t
+        {
+            Stored,     // Chunks that don't shrink are kept as is
+            LZ4Block
+        };
+
+        // Independently decodable part of a compressed packed file
+        struct PackedChunk
+        {
+            int64_t     m_ByteOffset { 0 };         // In the uncompressed content, which resource offsets refer to
+            int64_t     m_ByteSize { 0 };
+            int64_t     m_FileByteOffset { 0 };
+            int64_t     m_FileByteSize { 0 };
+            ChunkCodec  m_Codec { ChunkCodec::Stored };
+        };
+
+        // Appends content at the current position of a packed file. Without chunking, content is written as is.
+        // With chunking, content is split in chunks of chunkByteSize bytes, compressed concurrently in batches
+        // and written in order, each starting on a fileAlignment boundary of the file. The last chunk written
+        // by Finish can be shorter, appending to the file later starts a new chunk.
+        // Content reaches the file through a write-behind queue of writeQueueLength buffers, Finish must be called
+        // before the file is closed.
+        class PackedFileWriter
+        {
+        public:
+
+            PackedFileWriter(
+                FILE *pFile, int64_t byteOffset, int64_t fileByteOffset, uint32_t chunkByteSize, uint32_t fileAlignment,
+                uint32_t workerCount, uint32_t writeQueueLength);
+
+            PackedFileWriter(const PackedFileWriter&) = delete;
+            PackedFileWriter& operator=(const PackedFileWriter&) = delete;
+
+            bool                Write(const void *pData, size_t byteSize);
+
+            // Appends the whole content of a file and returns the number of bytes appended, or -1 on failure
+            int64_t             AppendFileContent(const char *pSrcFilePath);
+
+            // Writes the chunk being filled and every chunk waiting for compression, and waits for the queued writes
+            bool                Finish();
+
+            int64_t             ByteOffset() const { return m_ByteOffset; }
+            int64_t             FileByteOffset() const { return m_FileByteOffset; }
+            bool                IsChunked() const { return m_ChunkByteSize > 0; }
+            const std::vector<PackedChunk>& Chunks() const { return m_Chunks; }
+            double              WriteStallSeconds() const { return m_FileWriter.StallSeconds(); }
+
+        private:
+
+            bool                FlushPendingChunks();
+
+            FILE*                               m_pFile { nullptr };
+            AsyncFileWriter                     m_FileWriter;
+            int64_t                             m_ByteOffset { 0 };
+            int64_t                             m_FileByteOffset { 0 };
+            uint32_t                            m_ChunkByteSize { 0 };
+            uint32_t                            m_FileAlignment { 1 };
+            uint32_t                            m_WorkerCount { 1 };
+            std::vector<std::vector<uint8_t>>   m_PendingChunks {};     // Full chunks waiting for compression, the last one is being filled
+            std::vector<PackedChunk>            m_Chunks {};
+        };
+    }
+}
@@ -0,0 +1,177 @@
+#include <pch.h>
+#include "BufferPacking.h"
+#include "MeshPrimitives.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace asset_assembler;
+
+namespace
+{
+    void AddBufferViewRange(const gltf::Scene &scene, int32_t bufferViewIndex, int32_t accessorIndex, std::vector<meshes::ReferencedRange> &o_Ranges)
+    {
+        if (bufferViewIndex == gltf::s_InvalidIndex)
+        {
+            return;
+        }
+
+        const gltf::BufferView &bufferView = scene.m_BufferViews[bufferViewIndex];
+
+        meshes::ReferencedRange range {};
+        range.m_AccessorIndex = accessorIndex;
+        range.m_BufferIndex = bufferView.m_Buffer;
+        range.m_ByteOffset = bufferView.m_ByteOffset;
+        range.m_ByteSize = bufferView.m_ByteLength;
+
+        if (range.m_BufferIndex != gltf::s_InvalidIndex && range.m_ByteOffset >= 0 && range.m_ByteSize > 0)
+        {
+            o_Ranges.push_back(range);
+        }
+    }
+}
+
+void meshes::FindReferencedAccessors(const gltf::Scene &scene, std::vector<uint8_t> &o_Referenced)
+{
+    o_Referenced.assign(scene.m_Accessors.size(), 0);
+
+    auto reference = [&](int32_t accessorIndex)
+    {
+        if (accessorIndex != gltf::s_InvalidIndex)
+        {
+            o_Referenced[accessorIndex] = 1;
+        }
+    };
+
+    for (const gltf::Primitive &primitive : scene.m_Primitives)
+    {
+        reference(primitive.m_Indices);
+
+        for (const gltf::Attribute *pAttribute = scene.AttributesBegin(primitive); pAttribute != scene.AttributesEnd(primitive); ++pAttribute)
+        {
+            reference(pAttribute->m_Accessor);
+        }
+
+        for (const int32_t *pAccessor = scene.TargetAccessorsBegin(primitive); pAccessor != scene.TargetAccessorsEnd(primitive); ++pAccessor)
+        {
+            reference(*pAccessor);
+        }
+    }
+}
+
+void meshes::CollectReferencedRanges(const gltf::Scene &scene, std::vector<ReferencedRange> &o_Ranges)
+{
+    o_Ranges.clear();
+
+    std::vector<uint8_t> referenced;
+    FindReferencedAccessors(scene, referenced);
+
+    for (size_t i = 0; i < referenced.size(); ++i)
+    {
+        if (!referenced[i])
+        {
+            continue;
+        }
+
+        AccessorView view {};
+        if (ReadAccessorView(scene, static_cast<int>(i), view))
+        {
+            if (view.m_Count > 0)
+            {
+                o_Ranges.push_back({ static_cast<int32_t>(i), view.m_BufferIndex, view.m_ByteOffset, view.ByteSpan() });
+            }
+
+            continue;
+        }
+
+        // Unknown layouts keep every view they may read
+        const gltf::Accessor &accessor = scene.m_Accessors[i];
+
+        AddBufferViewRange(scene, accessor.m_BufferView, static_cast<int32_t>(i), o_Ranges);
+        AddBufferViewRange(scene, accessor.m_SparseIndicesBufferView, -1, o_Ranges);
+        AddBufferViewRange(scene, accessor.m_SparseValuesBufferView, -1, o_Ranges);
+    }
+}
+
+int64_t meshes::BuildBufferSegments(
+    const ReferencedRange *pRanges, size_t rangeCount, int64_t bufferByteSize, uint32_t alignment,
+    std::vector<BufferSegment> &o_Segments)
+{
+    struct Span
+    {
+        int64_t     m_Begin;
+        int64_t     m_End;
+    };
+
+    int64_t alignmentMask = static_cast<int64_t>(alignment) - 1;
+    std::vector<Span> spans;
+    spans.reserve(rangeCount);
+
+    for (size_t i = 0; i < rangeCount; ++i)
+    {
+        int64_t begin = std::min(pRanges[i].m_ByteOffset, bufferByteSize) & ~alignmentMask;
+        int64_t end = std::min(pRanges[i].m_ByteOffset + pRanges[i].m_ByteSize, bufferByteSize);
+
+        if (end > begin)
+        {
+            spans.push_back({ begin, end });
+        }
+    }
+
+    std::sort(spans.begin(), spans.end(), [](const Span &a, const Span &b)
+    {
+        return a.m_Begin < b.m_Begin;
+    });
+
+    o_Segments.clear();
+    int64_t packedByteSize = 0;
+
+    for (size_t i = 0; i < spans.size();)
+    {
+        Span merged = spans[i++];
+
+        // Touching or overlapping spans, and the ones separated by less than the alignment padding, are copied at once
+        while (i < spans.size() && spans[i].m_Begin <= ((merged.m_End + alignmentMask) & ~alignmentMask))
+        {
+            merged.m_End = std::max(merged.m_End, spans[i++].m_End);
+        }
+
+        BufferSegment segment {};
+        segment.m_SourceByteOffset = merged.m_Begin;
+        segment.m_ByteOffset = (packedByteSize + alignmentMask) & ~alignmentMask;
+        segment.m_ByteSize = merged.m_End - merged.m_Begin;
+
+        o_Segments.push_back(segment);
+        packedByteSize = segment.m_ByteOffset + segment.m_ByteSize;
+    }
+
+    return packedByteSize;
+}
+
+void meshes::PackBufferSegments(const uint8_t *pSrcData, const std::vector<BufferSegment> &segments, int64_t packedByteSize, std::vector<uint8_t> &o_Packed)
+{
+    o_Packed.assign(static_cast<size_t>(packedByteSize), 0);
+
+    for (const BufferSegment &segment : segments)
+    {
+        memcpy(o_Packed.data() + segment.m_ByteOffset, pSrcData + segment.m_SourceByteOffset, static_cast<size_t>(segment.m_ByteSize));
+    }
+}
+
+int64_t meshes::RemapBufferOffset(const std::vector<BufferSegment> &segments, int64_t sourceByteOffset)
+{
+    // First segment starting after the offset, the one before it is the only candidate
+    auto it = std::upper_bound(segments.begin(), segments.end(), sourceByteOffset, [](int64_t offset, const BufferSegment &segment)
+    {
+        return offset < segment.m_SourceByteOffset;
+    });
+
+    if (it == segments.begin())
+    {
+        return -1;
+    }
+
+    --it;
+    int64_t delta = sourceByteOffset - it->m_SourceByteOffset;
+
+    return delta < it->m_ByteSize ? it->m_ByteOffset + delta : -1;
+}
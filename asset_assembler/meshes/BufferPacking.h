@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "asset_assembler/gltf/GltfScene.h"
+
+namespace asset_assembler
+{
+    namespace meshes
+    {
+        // Bytes of a buffer read through an accessor of a mesh primitive
+        struct ReferencedRange
+        {
+            int32_t     m_AccessorIndex { -1 };     // -1 for the index and value views of sparse accessors
+            int32_t     m_BufferIndex { -1 };
+            int64_t     m_ByteOffset { 0 };         // From the start of the buffer
+            int64_t     m_ByteSize { 0 };
+        };
+
+        // Part of a source buffer kept in the packed buffer
+        struct BufferSegment
+        {
+            int64_t     m_SourceByteOffset { 0 };
+            int64_t     m_ByteOffset { 0 };         // In the packed buffer
+            int64_t     m_ByteSize { 0 };
+        };
+
+        // Flags the accessors read by a mesh primitive: indices, attributes and morph targets, indexed by accessor
+        void FindReferencedAccessors(const gltf::Scene &scene, std::vector<uint8_t> &o_Referenced);
+
+        // Collects the byte ranges of every accessor reachable from meshes[].primitives[]: indices, attributes
+        // and morph targets. Accessors whose layout can't be read keep their whole bufferView.
+        void CollectReferencedRanges(const gltf::Scene &scene, std::vector<ReferencedRange> &o_Ranges);
+
+        // Merges the ranges of one buffer into the segments to keep, in source order. Segments start and are placed
+        // on alignment boundaries so every accessor keeps the alignment it had in the source buffer.
+        // Ranges past bufferByteSize are clamped. Returns the size of the packed buffer.
+        int64_t BuildBufferSegments(
+            const ReferencedRange *pRanges, size_t rangeCount, int64_t bufferByteSize, uint32_t alignment,
+            std::vector<BufferSegment> &o_Segments);
+
+        // Copies the segments of pSrcData into o_Packed, zeroing the alignment padding between them
+        void PackBufferSegments(const uint8_t *pSrcData, const std::vector<BufferSegment> &segments, int64_t packedByteSize, std::vector<uint8_t> &o_Packed);
+
+        // Offset in the packed buffer of a source offset, -1 when the byte was stripped
+        int64_t RemapBufferOffset(const std::vector<BufferSegment> &segments, int64_t sourceByteOffset);
+    }
+}
@@ -0,0 +1,410 @@
+#include <pch.h>
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+using namespace asset_assembler;
+
+namespace
+{
+    static constexpr uint32_t s_InvalidIndex = ~0u;
+
+    // FIFO cache simulation, a vertex stays in the cache until cacheSize other vertices were transformed.
+    // Flushing the whole cache is done by advancing the timestamp by cacheSize.
+    struct FifoCache
+    {
+        FifoCache(size_t vertexCount, uint32_t cacheSize)
+            : m_Timestamps(vertexCount, 0)
+            , m_CacheSize(cacheSize)
+            , m_Timestamp(cacheSize + 1)
+        {}
+
+        bool Access(uint32_t vertex)
+        {
+            if (m_Timestamp - m_Timestamps[vertex] > m_CacheSize)
+            {
+                m_Timestamps[vertex] = m_Timestamp++;
+                return false;
+            }
+
+            return true;
+        }
+
+        uint32_t TriangleMisses(const uint32_t *pTriangle)
+        {
+            return
+                (Access(pTriangle[0]) ? 0 : 1) +
+                (Access(pTriangle[1]) ? 0 : 1) +
+                (Access(pTriangle[2]) ? 0 : 1);
+        }
+
+        void Flush()
+        {
+            m_Timestamp += m_CacheSize + 1;
+        }
+
+        std::vector<uint32_t>   m_Timestamps;
+        uint32_t                m_CacheSize;
+        uint32_t                m_Timestamp;
+    };
+
+    struct Float3
+    {
+        float x, y, z;
+    };
+
+    inline Float3 ReadPosition(const uint8_t *pPositions, size_t stride, uint32_t vertex)
+    {
+        Float3 position;
+        memcpy(&position, pPositions + stride * vertex, sizeof(position));
+        return position;
+    }
+}
+
+meshes::VertexCacheStats meshes::AnalyzeVertexCache(const uint32_t *pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+    VertexCacheStats stats {};
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<uint8_t> referenced(vertexCount, 0);
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t vertex = pIndices[i];
+
+        if (!referenced[vertex])
+        {
+            referenced[vertex] = 1;
+            ++stats.m_VertexCount;
+        }
+
+        if (!cache.Access(vertex))
+        {
+            ++stats.m_CacheMissCount;
+        }
+    }
+
+    stats.m_TriangleCount = indexCount / 3;
+
+    return stats;
+}
+
+void meshes::OptimizeVertexCache(uint32_t *pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize, std::vector<uint32_t> &o_ClusterStarts)
+{
+    size_t triangleCount = indexCount / 3;
+
+    o_ClusterStarts.clear();
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Triangles adjacent to every vertex, the live count drops as they get emitted
+    std::vector<uint32_t> liveCounts(vertexCount, 0);
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        ++liveCounts[pIndices[i]];
+    }
+
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveCounts[v];
+    }
+
+    {
+        std::vector<uint32_t> fillOffsets(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i)
+        {
+            adjacency[fillOffsets[pIndices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+
+    deadEnds.reserve(triangleCount * 3);
+    output.reserve(triangleCount * 3);
+
+    uint32_t inputCursor = 0;
+    uint32_t fanningVertex = 0;
+
+    o_ClusterStarts.push_back(0);
+
+    while (fanningVertex != s_InvalidIndex)
+    {
+        candidates.clear();
+
+        for (uint32_t a = adjacencyOffsets[fanningVertex]; a < adjacencyOffsets[fanningVertex + 1]; ++a)
+        {
+            uint32_t triangle = adjacency[a];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                uint32_t vertex = pIndices[triangle * 3 + k];
+
+                output.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+
+                --liveCounts[vertex];
+                cache.Access(vertex);
+            }
+
+            emitted[triangle] = 1;
+        }
+
+        // Fan next around the oldest candidate that will still be in the cache once its remaining triangles are emitted
+        uint32_t nextVertex = s_InvalidIndex;
+        int64_t bestPriority = -1;
+
+        for (uint32_t vertex : candidates)
+        {
+            if (liveCounts[vertex] == 0)
+            {
+                continue;
+            }
+
+            int64_t age = cache.m_Timestamp - cache.m_Timestamps[vertex];
+            int64_t priority = age + 2 * static_cast<int64_t>(liveCounts[vertex]) <= cacheSize ? age : 0;
+
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                nextVertex = vertex;
+            }
+        }
+
+        if (nextVertex == s_InvalidIndex)
+        {
+            while (!deadEnds.empty() && nextVertex == s_InvalidIndex)
+            {
+                uint32_t vertex = deadEnds.back();
+                deadEnds.pop_back();
+
+                if (liveCounts[vertex] > 0)
+                {
+                    nextVertex = vertex;
+                }
+            }
+
+            while (inputCursor < vertexCount && nextVertex == s_InvalidIndex)
+            {
+                uint32_t vertex = inputCursor++;
+
+                if (liveCounts[vertex] > 0)
+                {
+                    nextVertex = vertex;
+                }
+            }
+
+            // Dead-ends break the cache locality, the triangles that follow can be moved freely
+            uint32_t clusterStart = static_cast<uint32_t>(output.size() / 3);
+            if (nextVertex != s_InvalidIndex && clusterStart > o_ClusterStarts.back())
+            {
+                o_ClusterStarts.push_back(clusterStart);
+            }
+        }
+
+        fanningVertex = nextVertex;
+    }
+
+    memcpy(pIndices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+void meshes::OptimizeOverdraw(
+    uint32_t *pIndices, size_t indexCount, const std::vector<uint32_t> &clusterStarts,
+    const uint8_t *pPositions, size_t positionStride, size_t vertexCount, uint32_t cacheSize, float threshold)
+{
+    uint32_t triangleCount = static_cast<uint32_t>(indexCount / 3);
+    if (triangleCount == 0 || clusterStarts.empty())
+    {
+        return;
+    }
+
+    // Split clusters wherever the cache efficiency so far is already close to the whole cluster's
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<uint32_t> clusters;
+
+    for (size_t c = 0; c < clusterStarts.size(); ++c)
+    {
+        uint32_t start = clusterStarts[c];
+        uint32_t end = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : triangleCount;
+
+        if (start >= end)
+        {
+            continue;
+        }
+
+        cache.Flush();
+
+        uint32_t clusterMissCount = 0;
+        for (uint32_t t = start; t < end; ++t)
+        {
+            clusterMissCount += cache.TriangleMisses(pIndices + t * 3);
+        }
+
+        float clusterThreshold = threshold * static_cast<float>(clusterMissCount) / static_cast<float>(end - start);
+        uint32_t runningMissCount = 0;
+        uint32_t runningTriangleCount = 0;
+
+        cache.Flush();
+        clusters.push_back(start);
+
+        for (uint32_t t = start; t < end; ++t)
+        {
+            runningMissCount += cache.TriangleMisses(pIndices + t * 3);
+            ++runningTriangleCount;
+
+            if (t + 1 < end && static_cast<float>(runningMissCount) <= clusterThreshold * static_cast<float>(runningTriangleCount))
+            {
+                clusters.push_back(t + 1);
+                cache.Flush();
+
+                runningMissCount = 0;
+                runningTriangleCount = 0;
+            }
+        }
+    }
+
+    Float3 meshCentroid { 0.0f, 0.0f, 0.0f };
+    for (uint32_t v = 0; v < vertexCount; ++v)
+    {
+        Float3 position = ReadPosition(pPositions, positionStride, v);
+        meshCentroid.x += position.x;
+        meshCentroid.y += position.y;
+        meshCentroid.z += position.z;
+    }
+
+    if (vertexCount > 0)
+    {
+        float invVertexCount = 1.0f / static_cast<float>(vertexCount);
+        meshCentroid.x *= invVertexCount;
+        meshCentroid.y *= invVertexCount;
+        meshCentroid.z *= invVertexCount;
+    }
+
+    // Clusters whose area weighted normal points away from the mesh center are likely to occlude the others
+    size_t clusterCount = clusters.size();
+    std::vector<float> sortKeys(clusterCount, 0.0f);
+
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        uint32_t start = clusters[c];
+        uint32_t end = c + 1 < clusterCount ? clusters[c + 1] : triangleCount;
+
+        Float3 centroid { 0.0f, 0.0f, 0.0f };
+        Float3 normal { 0.0f, 0.0f, 0.0f };
+        float totalArea = 0.0f;
+
+        for (uint32_t t = start; t < end; ++t)
+        {
+            Float3 p0 = ReadPosition(pPositions, positionStride, pIndices[t * 3 + 0]);
+            Float3 p1 = ReadPosition(pPositions, positionStride, pIndices[t * 3 + 1]);
+            Float3 p2 = ReadPosition(pPositions, positionStride, pIndices[t * 3 + 2]);
+
+            Float3 e1 { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+            Float3 e2 { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+            Float3 cross { e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x };
+            float area = sqrtf(cross.x * cross.x + cross.y * cross.y + cross.z * cross.z);
+
+            centroid.x += (p0.x + p1.x + p2.x) * (area / 3.0f);
+            centroid.y += (p0.y + p1.y + p2.y) * (area / 3.0f);
+            centroid.z += (p0.z + p1.z + p2.z) * (area / 3.0f);
+
+            normal.x += cross.x;
+            normal.y += cross.y;
+            normal.z += cross.z;
+
+            totalArea += area;
+        }
+
+        if (totalArea > 0.0f)
+        {
+            centroid.x /= totalArea;
+            centroid.y /= totalArea;
+            centroid.z /= totalArea;
+        }
+
+        float normalLength = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+        if (normalLength > 0.0f)
+        {
+            normal.x /= normalLength;
+            normal.y /= normalLength;
+            normal.z /= normalLength;
+        }
+
+        sortKeys[c] =
+            (centroid.x - meshCentroid.x) * normal.x +
+            (centroid.y - meshCentroid.y) * normal.y +
+            (centroid.z - meshCentroid.z) * normal.z;
+    }
+
+    std::vector<uint32_t> clusterOrder(clusterCount);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> sourceIndices(pIndices, pIndices + triangleCount * 3);
+    uint32_t *pOutput = pIndices;
+
+    for (uint32_t c : clusterOrder)
+    {
+        uint32_t start = clusters[c];
+        uint32_t end = c + 1 < clusterCount ? clusters[c + 1] : triangleCount;
+        size_t clusterIndexCount = static_cast<size_t>(end - start) * 3;
+
+        memcpy(pOutput, sourceIndices.data() + start * 3, clusterIndexCount * sizeof(uint32_t));
+        pOutput += clusterIndexCount;
+    }
+}
+
+void meshes::OptimizeVertexFetch(uint32_t *pIndices, size_t indexCount, size_t vertexCount, std::vector<uint32_t> &o_Remap)
+{
+    o_Remap.assign(vertexCount, s_InvalidIndex);
+    uint32_t nextVertex = 0;
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t &index = pIndices[i];
+
+        if (o_Remap[index] == s_InvalidIndex)
+        {
+            o_Remap[index] = nextVertex++;
+        }
+
+        index = o_Remap[index];
+    }
+
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        if (o_Remap[v] == s_InvalidIndex)
+        {
+            o_Remap[v] = nextVertex++;
+        }
+    }
+}
+
+void meshes::RemapVertexStream(uint8_t *pVertices, size_t vertexCount, size_t elementByteSize, size_t stride, const std::vector<uint32_t> &remap)
+{
+    std::vector<uint8_t> vertices(vertexCount * elementByteSize);
+
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        memcpy(vertices.data() + v * elementByteSize, pVertices + v * stride, elementByteSize);
+    }
+
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        memcpy(pVertices + remap[v] * stride, vertices.data() + v * elementByteSize, elementByteSize);
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace asset_assembler
+{
+    namespace meshes
+    {
+        // Post-transform cache efficiency of a triangle list, simulated with a FIFO cache.
+        struct VertexCacheStats
+        {
+            uint64_t    m_TriangleCount { 0 };
+            uint64_t    m_VertexCount { 0 };        // Unique vertices referenced by the triangles
+            uint64_t    m_CacheMissCount { 0 };     // Vertices transformed, one per cache miss
+
+            // Average Cache Miss Ratio, transformed vertices per triangle. 0.5 is the best possible value.
+            double Acmr() const { return m_TriangleCount > 0 ? static_cast<double>(m_CacheMissCount) / m_TriangleCount : 0.0; }
+
+            // Average Transformed to Vertex Ratio, 1.0 means every vertex is transformed exactly once.
+            double Atvr() const { return m_VertexCount > 0 ? static_cast<double>(m_CacheMissCount) / m_VertexCount : 0.0; }
+        };
+
+        VertexCacheStats AnalyzeVertexCache(const uint32_t *pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize);
+
+        // Reorders triangles for post-transform cache locality (Tipsify, Sander et al. 2007).
+        // The start triangle of every cluster that ended on a cache dead-end is written to o_ClusterStarts,
+        // those are the only points where the triangle order can change without hurting the cache.
+        void OptimizeVertexCache(uint32_t *pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize, std::vector<uint32_t> &o_ClusterStarts);
+
+        // Reorders the clusters produced by OptimizeVertexCache so that triangles facing away from the mesh center
+        // are drawn first, which reduces overdraw from any viewpoint. Clusters are first split further wherever
+        // their cache miss ratio stays within threshold times the cluster's, a threshold of 1.05 allows a 5% ACMR loss.
+        // pPositions points to vertexCount float3 positions, positionStride bytes apart.
+        void OptimizeOverdraw(
+            uint32_t *pIndices, size_t indexCount, const std::vector<uint32_t> &clusterStarts,
+            const uint8_t *pPositions, size_t positionStride, size_t vertexCount, uint32_t cacheSize, float threshold);
+
+        // Builds the vertex permutation that stores vertices in the order the indices first reference them,
+        // and rewrites the indices accordingly. Unreferenced vertices keep their relative order at the end.
+        // o_Remap[oldVertex] gives the new position of every vertex.
+        void OptimizeVertexFetch(uint32_t *pIndices, size_t indexCount, size_t vertexCount, std::vector<uint32_t> &o_Remap);
+
+        // Applies a permutation from OptimizeVertexFetch to a vertex stream of vertexCount elements, stride bytes apart.
+        void RemapVertexStream(uint8_t *pVertices, size_t vertexCount, size_t elementByteSize, size_t stride, const std::vector<uint32_t> &remap);
+    }
+}
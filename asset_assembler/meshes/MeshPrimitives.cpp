@@ -0,0 +1,531 @@
+#include <pch.h>
+#include "MeshPrimitives.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace asset_assembler;
+
+namespace
+{
+    struct ByteRange
+    {
+        int32_t     m_BufferIndex;
+        int64_t     m_Begin;
+        int64_t     m_End;
+        uint32_t    m_PrimitiveIndex;
+        bool        m_IsIndexData;
+    };
+
+    void AddByteRange(const meshes::AccessorView &view, uint32_t primitiveIndex, bool isIndexData, std::vector<ByteRange> &o_Ranges)
+    {
+        o_Ranges.push_back({ view.m_BufferIndex, view.m_ByteOffset, view.m_ByteOffset + view.ByteSpan(), primitiveIndex, isIndexData });
+    }
+
+    // Reads every accessor, animation and skinning data included, and flags the ones that share bytes
+    // with another accessor or can't be read. Only the others can be rewritten in place.
+    void FindSharedAccessors(const gltf::Scene &scene, std::vector<meshes::AccessorView> &o_Views, std::vector<uint8_t> &o_Shared)
+    {
+        size_t accessorCount = scene.m_Accessors.size();
+        std::vector<ByteRange> ranges;
+
+        o_Views.assign(accessorCount, {});
+        o_Shared.assign(accessorCount, 0);
+
+        // Ranges are keyed by accessor index
+        for (size_t i = 0; i < accessorCount; ++i)
+        {
+            if (meshes::ReadAccessorView(scene, static_cast<int>(i), o_Views[i]))
+            {
+                AddByteRange(o_Views[i], static_cast<uint32_t>(i), false, ranges);
+            }
+            else
+            {
+                o_Shared[i] = 1;
+            }
+        }
+
+        std::sort(ranges.begin(), ranges.end(), [](const ByteRange &a, const ByteRange &b)
+        {
+            return a.m_BufferIndex != b.m_BufferIndex ? a.m_BufferIndex < b.m_BufferIndex : a.m_Begin < b.m_Begin;
+        });
+
+        // The range reaching the furthest so far overlaps any later range starting before its end
+        const ByteRange *pFurthest = nullptr;
+
+        for (const ByteRange &range : ranges)
+        {
+            if (pFurthest && pFurthest->m_BufferIndex == range.m_BufferIndex && pFurthest->m_End > range.m_Begin)
+            {
+                o_Shared[pFurthest->m_PrimitiveIndex] = 1;
+                o_Shared[range.m_PrimitiveIndex] = 1;
+            }
+
+            if (!pFurthest || pFurthest->m_BufferIndex != range.m_BufferIndex || range.m_End > pFurthest->m_End)
+            {
+                pFurthest = &range;
+            }
+        }
+    }
+}
+
+bool meshes::ReadAccessorView(const gltf::Scene &scene, int accessorIndex, AccessorView &o_View)
+{
+    if (accessorIndex < 0 || static_cast<size_t>(accessorIndex) >= scene.m_Accessors.size())
+    {
+        return false;
+    }
+
+    const gltf::Accessor &accessor = scene.m_Accessors[accessorIndex];
+
+    if (accessor.m_Sparse || accessor.m_BufferView == gltf::s_InvalidIndex)
+    {
+        return false;
+    }
+
+    const gltf::BufferView &bufferView = scene.m_BufferViews[accessor.m_BufferView];
+    if (bufferView.m_Buffer == gltf::s_InvalidIndex)
+    {
+        return false;
+    }
+
+    AccessorView view {};
+    view.m_AccessorIndex = accessorIndex;
+    view.m_BufferIndex = bufferView.m_Buffer;
+    view.m_Count = accessor.m_Count;
+    view.m_ComponentType = accessor.m_ComponentType;
+    view.m_ComponentCount = gltf::ComponentCount(accessor.m_Type);
+    view.m_ElementByteSize = gltf::ComponentByteSize(view.m_ComponentType) * view.m_ComponentCount;
+    view.m_ByteStride = bufferView.m_ByteStride;
+
+    if (view.m_ByteStride == 0)
+    {
+        view.m_ByteStride = view.m_ElementByteSize;
+    }
+
+    view.m_ByteOffset = bufferView.m_ByteOffset + accessor.m_ByteOffset;
+
+    if (
+        view.m_Count < 0 || view.m_ElementByteSize <= 0 ||
+        view.m_ByteStride < view.m_ElementByteSize ||
+        accessor.m_ByteOffset < 0 || bufferView.m_ByteOffset < 0 ||
+        accessor.m_ByteOffset + view.ByteSpan() > bufferView.m_ByteLength)
+    {
+        return false;
+    }
+
+    o_View = view;
+    return true;
+}
+
+void meshes::CollectMeshPrimitives(const gltf::Scene &scene, std::vector<MeshPrimitive> &o_Primitives)
+{
+    o_Primitives.clear();
+
+    std::vector<MeshPrimitive> candidates;
+
+    for (size_t i = 0; i < scene.m_Primitives.size(); ++i)
+    {
+        const gltf::Primitive &primitive = scene.m_Primitives[i];
+
+        if (
+            primitive.m_Mode != gltf::s_TrianglesMode ||
+            primitive.m_Indices == gltf::s_InvalidIndex ||
+            primitive.m_Position == gltf::s_InvalidIndex)
+        {
+            continue;
+        }
+
+        MeshPrimitive candidate {};
+        candidate.m_MeshIndex = primitive.m_Mesh;
+        candidate.m_PrimitiveIndex = primitive.m_IndexInMesh;
+        candidate.m_SceneIndex = static_cast<int32_t>(i);
+
+        // Morph targets are indexed like the base vertices, they would have to be reordered as well
+        candidate.m_CanReorderVertices = !primitive.m_HasTargets;
+
+        bool valid =
+            ReadAccessorView(scene, primitive.m_Indices, candidate.m_Indices) &&
+            ReadAccessorView(scene, primitive.m_Position, candidate.m_Positions);
+
+        for (const gltf::Attribute *pAttribute = scene.AttributesBegin(primitive); valid && pAttribute != scene.AttributesEnd(primitive); ++pAttribute)
+        {
+            AccessorView stream {};
+            valid = ReadAccessorView(scene, pAttribute->m_Accessor, stream);
+
+            bool duplicate = false;
+            for (const AccessorView &other : candidate.m_VertexStreams)
+            {
+                duplicate = duplicate || other.m_AccessorIndex == stream.m_AccessorIndex;
+            }
+
+            if (valid && !duplicate)
+            {
+                candidate.m_VertexStreams.push_back(stream);
+            }
+        }
+
+        const AccessorView &indices = candidate.m_Indices;
+        valid =
+            valid &&
+            indices.m_ComponentCount == 1 &&
+            indices.m_ByteStride == indices.m_ElementByteSize &&
+            indices.m_Count % 3 == 0 &&
+            (indices.m_ComponentType == gltf::s_UnsignedByteCode ||
+             indices.m_ComponentType == gltf::s_UnsignedShortCode ||
+             indices.m_ComponentType == gltf::s_UnsignedIntCode);
+
+        // Every stream must live in the same buffer so the primitive can be processed once that buffer is loaded
+        candidate.m_BufferIndex = indices.m_BufferIndex;
+
+        for (const AccessorView &stream : candidate.m_VertexStreams)
+        {
+            valid =
+                valid &&
+                stream.m_BufferIndex == candidate.m_BufferIndex &&
+                stream.m_Count == candidate.m_Positions.m_Count;
+        }
+
+        if (valid)
+        {
+            candidates.push_back(std::move(candidate));
+        }
+    }
+
+    // Primitives are processed concurrently and in place, the bytes one of them writes must not be touched by any other.
+    // Index data is always rewritten, vertex data only when the vertices are reordered.
+    std::vector<ByteRange> ranges;
+    std::vector<uint8_t> excluded(candidates.size(), 0);
+
+    for (uint32_t i = 0; i < candidates.size(); ++i)
+    {
+        AddByteRange(candidates[i].m_Indices, i, true, ranges);
+
+        for (const AccessorView &stream : candidates[i].m_VertexStreams)
+        {
+            AddByteRange(stream, i, false, ranges);
+        }
+    }
+
+    std::sort(ranges.begin(), ranges.end(), [](const ByteRange &a, const ByteRange &b)
+    {
+        return a.m_BufferIndex != b.m_BufferIndex ? a.m_BufferIndex < b.m_BufferIndex : a.m_Begin < b.m_Begin;
+    });
+
+    std::vector<const ByteRange*> activeRanges;
+
+    for (const ByteRange &range : ranges)
+    {
+        activeRanges.erase(
+            std::remove_if(activeRanges.begin(), activeRanges.end(), [&](const ByteRange *pActive)
+            {
+                return pActive->m_BufferIndex != range.m_BufferIndex || pActive->m_End <= range.m_Begin;
+            }),
+            activeRanges.end());
+
+        for (const ByteRange *pActive : activeRanges)
+        {
+            bool samePrimitive = pActive->m_PrimitiveIndex == range.m_PrimitiveIndex;
+            bool bothVertexData = !pActive->m_IsIndexData && !range.m_IsIndexData;
+
+            if (bothVertexData && !samePrimitive)
+            {
+                candidates[pActive->m_PrimitiveIndex].m_CanReorderVertices = false;
+                candidates[range.m_PrimitiveIndex].m_CanReorderVertices = false;
+            }
+            else if (!bothVertexData)
+            {
+                excluded[pActive->m_PrimitiveIndex] = 1;
+                excluded[range.m_PrimitiveIndex] = 1;
+            }
+        }
+
+        if (range.m_End > range.m_Begin)
+        {
+            activeRanges.push_back(&range);
+        }
+    }
+
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        if (!excluded[i])
+        {
+            o_Primitives.push_back(std::move(candidates[i]));
+        }
+    }
+}
+
+void meshes::CollectVertexStreams(const gltf::Scene &scene, std::vector<VertexStream> &o_Streams)
+{
+    o_Streams.clear();
+
+    std::vector<AccessorView> views;
+    std::vector<uint8_t> excluded;
+    FindSharedAccessors(scene, views, excluded);
+
+    // Accessors referenced with different semantics, as indices or by morph targets are left untouched
+    size_t accessorCount = views.size();
+    std::vector<VertexSemantic> semantics(accessorCount, VertexSemantic::Other);
+    std::vector<uint8_t> referenced(accessorCount, 0);
+
+    auto addAccessor = [&](int32_t accessorIndex, VertexSemantic semantic, bool isStream)
+    {
+        if (accessorIndex == gltf::s_InvalidIndex)
+        {
+            return;
+        }
+
+        if (!referenced[accessorIndex])
+        {
+            referenced[accessorIndex] = 1;
+            semantics[accessorIndex] = semantic;
+            excluded[accessorIndex] |= isStream ? 0 : 1;
+        }
+        else if (!isStream || semantics[accessorIndex] != semantic)
+        {
+            excluded[accessorIndex] = 1;
+        }
+    };
+
+    for (const gltf::Primitive &primitive : scene.m_Primitives)
+    {
+        addAccessor(primitive.m_Indices, VertexSemantic::Other, false);
+
+        for (const gltf::Attribute *pAttribute = scene.AttributesBegin(primitive); pAttribute != scene.AttributesEnd(primitive); ++pAttribute)
+        {
+            addAccessor(pAttribute->m_Accessor, pAttribute->m_Semantic, true);
+        }
+
+        for (const int32_t *pAccessor = scene.TargetAccessorsBegin(primitive); pAccessor != scene.TargetAccessorsEnd(primitive); ++pAccessor)
+        {
+            addAccessor(*pAccessor, VertexSemantic::Other, false);
+        }
+    }
+
+    for (size_t i = 0; i < accessorCount; ++i)
+    {
+        const AccessorView &view = views[i];
+
+        if (
+            !referenced[i] || excluded[i] || semantics[i] == VertexSemantic::Other ||
+            view.m_Count == 0 || view.m_ByteStride != view.m_ElementByteSize)
+        {
+            continue;
+        }
+
+        VertexStream stream {};
+        stream.m_View = view;
+        stream.m_Semantic = semantics[i];
+        stream.m_Normalized = scene.m_Accessors[i].m_Normalized;
+
+        o_Streams.push_back(stream);
+    }
+}
+
+void meshes::CollectIndexStreams(const gltf::Scene &scene, std::vector<AccessorView> &o_Indices)
+{
+    static constexpr uint8_t s_IndexUsage = 1;
+    static constexpr uint8_t s_OtherUsage = 2;
+
+    o_Indices.clear();
+
+    std::vector<AccessorView> views;
+    std::vector<uint8_t> excluded;
+    FindSharedAccessors(scene, views, excluded);
+
+    size_t accessorCount = views.size();
+    std::vector<uint8_t> usages(accessorCount, 0);
+
+    auto addUsage = [&](int32_t accessorIndex, uint8_t usage)
+    {
+        if (accessorIndex != gltf::s_InvalidIndex)
+        {
+            usages[accessorIndex] |= usage;
+        }
+    };
+
+    for (const gltf::Primitive &primitive : scene.m_Primitives)
+    {
+        addUsage(primitive.m_Indices, s_IndexUsage);
+
+        for (const gltf::Attribute *pAttribute = scene.AttributesBegin(primitive); pAttribute != scene.AttributesEnd(primitive); ++pAttribute)
+        {
+            addUsage(pAttribute->m_Accessor, s_OtherUsage);
+        }
+
+        for (const int32_t *pAccessor = scene.TargetAccessorsBegin(primitive); pAccessor != scene.TargetAccessorsEnd(primitive); ++pAccessor)
+        {
+            addUsage(*pAccessor, s_OtherUsage);
+        }
+    }
+
+    for (size_t i = 0; i < accessorCount; ++i)
+    {
+        const AccessorView &view = views[i];
+
+        if (
+            usages[i] == s_IndexUsage && !excluded[i] &&
+            view.m_ComponentType == gltf::s_UnsignedIntCode && view.m_ComponentCount == 1 &&
+            view.m_Count > 0 && view.m_ByteStride == view.m_ElementByteSize)
+        {
+            o_Indices.push_back(view);
+        }
+    }
+}
+
+bool meshes::NarrowIndexStream(const AccessorView &indices, uint8_t *pBufferData, size_t bufferByteSize)
+{
+    // glTF reserves the largest value of the component type for primitive restart
+    static constexpr uint32_t s_MaxUInt16Index = 0xfffe;
+
+    if (
+        indices.m_ComponentType != gltf::s_UnsignedIntCode || indices.m_ComponentCount != 1 ||
+        indices.m_Count <= 0 || indices.m_ByteStride != indices.m_ElementByteSize ||
+        indices.m_ByteOffset < 0 || static_cast<uint64_t>(indices.m_ByteOffset + indices.ByteSpan()) > bufferByteSize)
+    {
+        return false;
+    }
+
+    uint8_t *pIndices = pBufferData + indices.m_ByteOffset;
+    size_t indexCount = static_cast<size_t>(indices.m_Count);
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t index;
+        memcpy(&index, pIndices + i * sizeof(uint32_t), sizeof(uint32_t));
+
+        if (index > s_MaxUInt16Index)
+        {
+            return false;
+        }
+    }
+
+    // Each 16 bits index is written over bytes that were already read
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t index;
+        memcpy(&index, pIndices + i * sizeof(uint32_t), sizeof(uint32_t));
+
+        uint16_t narrowIndex = static_cast<uint16_t>(index);
+        memcpy(pIndices + i * sizeof(uint16_t), &narrowIndex, sizeof(uint16_t));
+    }
+
+    memset(pIndices + indexCount * sizeof(uint16_t), 0, indexCount * sizeof(uint16_t));
+
+    return true;
+}
+
+bool meshes::ReadPrimitiveIndices(const MeshPrimitive &primitive, const uint8_t *pBufferData, size_t bufferByteSize, std::vector<uint32_t> &o_Indices)
+{
+    const AccessorView &indexView = primitive.m_Indices;
+
+    int64_t dataEnd = indexView.m_ByteOffset + indexView.ByteSpan();
+    for (const AccessorView &stream : primitive.m_VertexStreams)
+    {
+        dataEnd = std::max(dataEnd, stream.m_ByteOffset + stream.ByteSpan());
+    }
+
+    if (dataEnd > static_cast<int64_t>(bufferByteSize))
+    {
+        return false;
+    }
+
+    size_t indexCount = static_cast<size_t>(indexView.m_Count);
+    size_t vertexCount = static_cast<size_t>(primitive.m_Positions.m_Count);
+    const uint8_t *pIndexData = pBufferData + indexView.m_ByteOffset;
+
+    o_Indices.resize(indexCount);
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        switch (indexView.m_ElementByteSize)
+        {
+        case 1:
+            o_Indices[i] = pIndexData[i];
+            break;
+        case 2:
+        {
+            uint16_t index;
+            memcpy(&index, pIndexData + i * sizeof(uint16_t), sizeof(index));
+            o_Indices[i] = index;
+            break;
+        }
+        default:
+            memcpy(&o_Indices[i], pIndexData + i * sizeof(uint32_t), sizeof(uint32_t));
+            break;
+        }
+
+        if (o_Indices[i] >= vertexCount)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool meshes::OptimizeMeshPrimitive(
+    const MeshPrimitive &primitive, uint8_t *pBufferData, size_t bufferByteSize, uint32_t cacheSize, float overdrawThreshold,
+    VertexCacheStats &o_StatsBefore, VertexCacheStats &o_StatsAfter)
+{
+    const AccessorView &indexView = primitive.m_Indices;
+    const AccessorView &positionView = primitive.m_Positions;
+
+    std::vector<uint32_t> indices;
+    if (!ReadPrimitiveIndices(primitive, pBufferData, bufferByteSize, indices))
+    {
+        return false;
+    }
+
+    size_t indexCount = indices.size();
+    size_t vertexCount = static_cast<size_t>(positionView.m_Count);
+    uint8_t *pIndexData = pBufferData + indexView.m_ByteOffset;
+
+    o_StatsBefore = AnalyzeVertexCache(indices.data(), indexCount, vertexCount, cacheSize);
+
+    std::vector<uint32_t> clusterStarts;
+    OptimizeVertexCache(indices.data(), indexCount, vertexCount, cacheSize, clusterStarts);
+
+    if (positionView.m_ComponentType == gltf::s_FloatCode && positionView.m_ComponentCount == 3)
+    {
+        OptimizeOverdraw(
+            indices.data(), indexCount, clusterStarts,
+            pBufferData + positionView.m_ByteOffset, static_cast<size_t>(positionView.m_ByteStride), vertexCount,
+            cacheSize, overdrawThreshold);
+    }
+
+    if (primitive.m_CanReorderVertices)
+    {
+        std::vector<uint32_t> remap;
+        OptimizeVertexFetch(indices.data(), indexCount, vertexCount, remap);
+
+        for (const AccessorView &stream : primitive.m_VertexStreams)
+        {
+            RemapVertexStream(
+                pBufferData + stream.m_ByteOffset, vertexCount,
+                static_cast<size_t>(stream.m_ElementByteSize), static_cast<size_t>(stream.m_ByteStride), remap);
+        }
+    }
+
+    o_StatsAfter = AnalyzeVertexCache(indices.data(), indexCount, vertexCount, cacheSize);
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        switch (indexView.m_ElementByteSize)
+        {
+        case 1:
+            pIndexData[i] = static_cast<uint8_t>(indices[i]);
+            break;
+        case 2:
+        {
+            uint16_t index = static_cast<uint16_t>(indices[i]);
+            memcpy(pIndexData + i * sizeof(uint16_t), &index, sizeof(index));
+            break;
+        }
+        default:
+            memcpy(pIndexData + i * sizeof(uint32_t), &indices[i], sizeof(uint32_t));
+            break;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "asset_assembler/gltf/GltfScene.h"
+#include "MeshOptimizer.h"
+
+namespace asset_assembler
+{
+    namespace meshes
+    {
+        // Location of the elements of a glTF accessor inside its buffer
+        struct AccessorView
+        {
+            int32_t     m_AccessorIndex { -1 };
+            int32_t     m_BufferIndex { -1 };
+            int64_t     m_ByteOffset { 0 };         // From the start of the buffer
+            int64_t     m_Count { 0 };
+            int32_t     m_ComponentType { 0 };      // glTF componentType code
+            int32_t     m_ComponentCount { 0 };
+            int32_t     m_ElementByteSize { 0 };
+            int32_t     m_ByteStride { 0 };         // Distance between two elements, larger than the element when interleaved
+
+            int64_t ByteSpan() const { return m_Count > 0 ? (m_Count - 1) * m_ByteStride + m_ElementByteSize : 0; }
+        };
+
+        // Fails for accessors without a bufferView, sparse accessors and inconsistent layouts
+        bool ReadAccessorView(const gltf::Scene &scene, int accessorIndex, AccessorView &o_View);
+
+        // Triangle list primitive whose streams all live in a single buffer and can be rewritten in place
+        struct MeshPrimitive
+        {
+            int32_t                     m_MeshIndex { -1 };
+            int32_t                     m_PrimitiveIndex { -1 };        // Within the mesh
+            int32_t                     m_SceneIndex { -1 };            // In gltf::Scene::m_Primitives, identifies the primitive in traces
+            int32_t                     m_BufferIndex { -1 };
+            AccessorView                m_Indices {};
+            AccessorView                m_Positions {};
+            std::vector<AccessorView>   m_VertexStreams {};             // Every attribute, POSITION included
+            bool                        m_CanReorderVertices { true };  // No other primitive reads the vertex streams
+        };
+
+        using VertexSemantic = gltf::AttributeSemantic;
+
+        // Vertex attribute accessor, referenced by one or more primitives
+        struct VertexStream
+        {
+            AccessorView        m_View {};
+            VertexSemantic      m_Semantic { VertexSemantic::Other };
+            bool                m_Normalized { false };     // Integer components are read as normalized values
+        };
+
+        // Collects the primitives that can be optimized in place. Primitives whose index data overlaps the data of
+        // another primitive are left out, and primitives sharing vertex data with others keep their vertex order,
+        // so that every primitive can be processed concurrently.
+        void CollectMeshPrimitives(const gltf::Scene &scene, std::vector<MeshPrimitive> &o_Primitives);
+
+        // Collects every tightly packed vertex attribute accessor whose bytes are not shared with any other
+        // accessor used by a primitive, so that it can be rewritten in place with a different element size.
+        void CollectVertexStreams(const gltf::Scene &scene, std::vector<VertexStream> &o_Streams);
+
+        // Collects the 32 bits index accessors that are only read as indices and share no bytes with other accessors
+        void CollectIndexStreams(const gltf::Scene &scene, std::vector<AccessorView> &o_Indices);
+
+        // Rewrites 32 bits indices in place as 16 bits when the largest index fits, the freed tail is zeroed.
+        // Returns false, leaving the buffer untouched, when an index is too large or the accessor doesn't fit in the buffer.
+        bool NarrowIndexStream(const AccessorView &indices, uint8_t *pBufferData, size_t bufferByteSize);
+
+        // Decodes the indices of a primitive to 32 bits. pBufferData is the content of the primitive's buffer.
+        // Fails when the primitive doesn't fit in the buffer or an index is out of range.
+        bool ReadPrimitiveIndices(const MeshPrimitive &primitive, const uint8_t *pBufferData, size_t bufferByteSize, std::vector<uint32_t> &o_Indices);
+
+        // Reorders the triangles of a primitive for the post-transform cache and overdraw, then its vertices
+        // for fetch locality when allowed. pBufferData is the content of the primitive's buffer.
+        // Returns false, leaving the buffer untouched, when the primitive doesn't fit in the buffer or has invalid indices.
+        bool OptimizeMeshPrimitive(
+            const MeshPrimitive &primitive, uint8_t *pBufferData, size_t bufferByteSize, uint32_t cacheSize, float overdrawThreshold,
+            VertexCacheStats &o_StatsBefore, VertexCacheStats &o_StatsAfter);
+    }
+}
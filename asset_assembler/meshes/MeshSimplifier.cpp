@@ -0,0 +1,484 @@
+#include <pch.h>
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace asset_assembler;
+
+namespace
+{
+    struct Float3
+    {
+        float x, y, z;
+    };
+
+    inline Float3 Sub(const Float3 &a, const Float3 &b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    inline Float3 Cross(const Float3 &a, const Float3 &b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    inline float Dot(const Float3 &a, const Float3 &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    inline Float3 Mad(const Float3 &a, const Float3 &b, float t) { return { a.x + b.x * t, a.y + b.y * t, a.z + b.z * t }; }
+
+    // Distance from p to the closest point of triangle abc (Ericson, Real-Time Collision Detection, 5.1.5)
+    float PointTriangleDistance(const Float3 &p, const Float3 &a, const Float3 &b, const Float3 &c)
+    {
+        Float3 ab = Sub(b, a);
+        Float3 ac = Sub(c, a);
+        Float3 ap = Sub(p, a);
+        Float3 closest;
+
+        float d1 = Dot(ab, ap);
+        float d2 = Dot(ac, ap);
+        Float3 bp = Sub(p, b);
+        float d3 = Dot(ab, bp);
+        float d4 = Dot(ac, bp);
+        Float3 cp = Sub(p, c);
+        float d5 = Dot(ab, cp);
+        float d6 = Dot(ac, cp);
+
+        float vc = d1 * d4 - d3 * d2;
+        float vb = d5 * d2 - d1 * d6;
+        float va = d3 * d6 - d5 * d4;
+
+        if (d1 <= 0.0f && d2 <= 0.0f)
+        {
+            closest = a;
+        }
+        else if (d3 >= 0.0f && d4 <= d3)
+        {
+            closest = b;
+        }
+        else if (d6 >= 0.0f && d5 <= d6)
+        {
+            closest = c;
+        }
+        else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        {
+            closest = Mad(a, ab, d1 / (d1 - d3));
+        }
+        else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        {
+            closest = Mad(a, ac, d2 / (d2 - d6));
+        }
+        else if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        {
+            closest = Mad(b, Sub(c, b), (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+        else
+        {
+            float denominator = 1.0f / (va + vb + vc);
+            closest = Mad(Mad(a, ab, vb * denominator), ac, vc * denominator);
+        }
+
+        Float3 delta = Sub(p, closest);
+        return sqrtf(Dot(delta, delta));
+    }
+
+    // Sum of squared distances to a set of planes, weighted by the area of the triangles they come from
+    struct Quadric
+    {
+        double a2, b2, c2, d2, ab, ac, ad, bc, bd, cd, w;
+
+        void AddPlane(const Float3 &normal, float d, float weight)
+        {
+            double a = normal.x, b = normal.y, c = normal.z;
+
+            a2 += a * a * weight; b2 += b * b * weight; c2 += c * c * weight; d2 += d * d * weight;
+            ab += a * b * weight; ac += a * c * weight; ad += a * d * weight;
+            bc += b * c * weight; bd += b * d * weight; cd += c * d * weight;
+            w += weight;
+        }
+
+        void Add(const Quadric &other)
+        {
+            a2 += other.a2; b2 += other.b2; c2 += other.c2; d2 += other.d2;
+            ab += other.ab; ac += other.ac; ad += other.ad;
+            bc += other.bc; bd += other.bd; cd += other.cd;
+            w += other.w;
+        }
+
+        // Mean squared distance of p to the planes
+        double Error(const Float3 &p) const
+        {
+            double x = p.x, y = p.y, z = p.z;
+            double error =
+                a2 * x * x + b2 * y * y + c2 * z * z +
+                2.0 * (ab * x * y + ac * x * z + bc * y * z) +
+                2.0 * (ad * x + bd * y + cd * z) +
+                d2;
+
+            return w > 0.0 ? std::max(error, 0.0) / w : 0.0;
+        }
+    };
+
+    struct Edge
+    {
+        uint32_t    m_A;
+        uint32_t    m_B;
+    };
+
+    struct Collapse
+    {
+        uint32_t    m_Source;
+        uint32_t    m_Target;
+        double      m_Error;
+    };
+
+    // Vertices whose position must not change: on open borders, seams between vertices sharing a position
+    // and non-manifold edges. All of those have an edge used by a number of triangles other than two.
+    void FindLockedVertices(const uint32_t *pIndices, size_t indexCount, size_t vertexCount, std::vector<uint8_t> &o_Locked)
+    {
+        std::vector<Edge> edges;
+        edges.reserve(indexCount);
+
+        for (size_t i = 0; i < indexCount; i += 3)
+        {
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                uint32_t a = pIndices[i + corner];
+                uint32_t b = pIndices[i + (corner + 1) % 3];
+                edges.push_back({ std::min(a, b), std::max(a, b) });
+            }
+        }
+
+        std::sort(edges.begin(), edges.end(), [](const Edge &x, const Edge &y)
+        {
+            return x.m_A != y.m_A ? x.m_A < y.m_A : x.m_B < y.m_B;
+        });
+
+        o_Locked.assign(vertexCount, 0);
+
+        for (size_t begin = 0; begin < edges.size();)
+        {
+            size_t end = begin + 1;
+            while (end < edges.size() && edges[end].m_A == edges[begin].m_A && edges[end].m_B == edges[begin].m_B)
+            {
+                ++end;
+            }
+
+            if (end - begin != 2)
+            {
+                o_Locked[edges[begin].m_A] = 1;
+                o_Locked[edges[begin].m_B] = 1;
+            }
+
+            begin = end;
+        }
+    }
+
+    // Triangles around every vertex, in compressed rows
+    void BuildVertexTriangles(const std::vector<uint32_t> &indices, size_t vertexCount, std::vector<uint32_t> &o_Offsets, std::vector<uint32_t> &o_Triangles)
+    {
+        o_Offsets.assign(vertexCount + 1, 0);
+
+        for (uint32_t index : indices)
+        {
+            o_Offsets[index + 1]++;
+        }
+
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            o_Offsets[i + 1] += o_Offsets[i];
+        }
+
+        std::vector<uint32_t> cursors(o_Offsets.begin(), o_Offsets.end() - 1);
+        o_Triangles.resize(indices.size());
+
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            o_Triangles[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+}
+
+void meshes::SimplifyMesh(
+    const uint32_t *pIndices, size_t indexCount, const uint8_t *pPositions, size_t positionStride, size_t vertexCount,
+    size_t targetIndexCount, float maxError, std::vector<uint32_t> &o_Indices, float &o_Error)
+{
+    o_Indices.assign(pIndices, pIndices + indexCount);
+    o_Error = 0.0f;
+
+    if (indexCount <= targetIndexCount || vertexCount == 0)
+    {
+        return;
+    }
+
+    // Positions are scaled to the unit cube so errors are relative to the mesh extent
+    std::vector<Float3> positions(vertexCount);
+    Float3 minimum = { INFINITY, INFINITY, INFINITY };
+    Float3 maximum = { -INFINITY, -INFINITY, -INFINITY };
+
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        memcpy(&positions[i], pPositions + i * positionStride, sizeof(Float3));
+
+        minimum = { std::min(minimum.x, positions[i].x), std::min(minimum.y, positions[i].y), std::min(minimum.z, positions[i].z) };
+        maximum = { std::max(maximum.x, positions[i].x), std::max(maximum.y, positions[i].y), std::max(maximum.z, positions[i].z) };
+    }
+
+    float extent = std::max(maximum.x - minimum.x, std::max(maximum.y - minimum.y, maximum.z - minimum.z));
+    if (!(extent > 0.0f) || !std::isfinite(extent))
+    {
+        return;
+    }
+
+    for (Float3 &position : positions)
+    {
+        position = { (position.x - minimum.x) / extent, (position.y - minimum.y) / extent, (position.z - minimum.z) / extent };
+    }
+
+    std::vector<uint8_t> locked;
+    FindLockedVertices(pIndices, indexCount, vertexCount, locked);
+
+    std::vector<Quadric> quadrics(vertexCount, Quadric {});
+
+    for (size_t i = 0; i < indexCount; i += 3)
+    {
+        const Float3 &p0 = positions[pIndices[i + 0]];
+        const Float3 &p1 = positions[pIndices[i + 1]];
+        const Float3 &p2 = positions[pIndices[i + 2]];
+
+        Float3 normal = Cross(Sub(p1, p0), Sub(p2, p0));
+        float doubleArea = sqrtf(Dot(normal, normal));
+
+        if (doubleArea > 0.0f)
+        {
+            normal = { normal.x / doubleArea, normal.y / doubleArea, normal.z / doubleArea };
+            float d = -Dot(normal, p0);
+
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                quadrics[pIndices[i + corner]].AddPlane(normal, d, doubleArea);
+            }
+        }
+    }
+
+    double maxSquaredError = static_cast<double>(maxError) * maxError;
+
+    // Vertex every original vertex was collapsed onto, through every pass
+    std::vector<uint32_t> collapsedTo(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; ++i)
+    {
+        collapsedTo[i] = i;
+    }
+
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint8_t> touched(vertexCount);
+    std::vector<uint32_t> triangleOffsets;
+    std::vector<uint32_t> vertexTriangles;
+    std::vector<Edge> edges;
+    std::vector<Collapse> collapses;
+
+    // Would moving source onto target turn any of the triangles around source over?
+    auto flipsTriangles = [&](uint32_t source, uint32_t target)
+    {
+        for (uint32_t i = triangleOffsets[source]; i < triangleOffsets[source + 1]; ++i)
+        {
+            const uint32_t *pTriangle = o_Indices.data() + vertexTriangles[i] * 3;
+            uint32_t corners[3] = { remap[pTriangle[0]], remap[pTriangle[1]], remap[pTriangle[2]] };
+
+            if (corners[0] == target || corners[1] == target || corners[2] == target)
+            {
+                continue;
+            }
+
+            Float3 before = Cross(Sub(positions[corners[1]], positions[corners[0]]), Sub(positions[corners[2]], positions[corners[0]]));
+
+            for (uint32_t &corner : corners)
+            {
+                corner = corner == source ? target : corner;
+            }
+
+            Float3 after = Cross(Sub(positions[corners[1]], positions[corners[0]]), Sub(positions[corners[2]], positions[corners[0]]));
+
+            if (Dot(before, after) <= 0.0f)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    // Every pass collapses the cheapest edges whose vertices weren't touched by another collapse of the same pass
+    while (o_Indices.size() > targetIndexCount)
+    {
+        BuildVertexTriangles(o_Indices, vertexCount, triangleOffsets, vertexTriangles);
+
+        edges.clear();
+        for (size_t i = 0; i < o_Indices.size(); i += 3)
+        {
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                uint32_t a = o_Indices[i + corner];
+                uint32_t b = o_Indices[i + (corner + 1) % 3];
+
+                // Each interior edge is seen once per direction, keeping one of them is enough
+                if (a < b)
+                {
+                    edges.push_back({ a, b });
+                }
+            }
+        }
+
+        collapses.clear();
+        for (const Edge &edge : edges)
+        {
+            double errorAB = locked[edge.m_A] ? INFINITY : quadrics[edge.m_A].Error(positions[edge.m_B]);
+            double errorBA = locked[edge.m_B] ? INFINITY : quadrics[edge.m_B].Error(positions[edge.m_A]);
+
+            if (errorAB <= errorBA && errorAB <= maxSquaredError)
+            {
+                collapses.push_back({ edge.m_A, edge.m_B, errorAB });
+            }
+            else if (errorBA < errorAB && errorBA <= maxSquaredError)
+            {
+                collapses.push_back({ edge.m_B, edge.m_A, errorBA });
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b)
+        {
+            return a.m_Error < b.m_Error;
+        });
+
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            remap[i] = i;
+        }
+
+        std::fill(touched.begin(), touched.end(), 0);
+
+        // An interior edge collapse removes two triangles
+        size_t removableIndexCount = o_Indices.size() - targetIndexCount;
+        size_t removedIndexCount = 0;
+        size_t collapseCount = 0;
+
+        for (const Collapse &collapse : collapses)
+        {
+            if (removedIndexCount >= removableIndexCount)
+            {
+                break;
+            }
+
+            if (touched[collapse.m_Source] || touched[collapse.m_Target] || flipsTriangles(collapse.m_Source, collapse.m_Target))
+            {
+                continue;
+            }
+
+            remap[collapse.m_Source] = collapse.m_Target;
+            quadrics[collapse.m_Target].Add(quadrics[collapse.m_Source]);
+            touched[collapse.m_Source] = 1;
+            touched[collapse.m_Target] = 1;
+
+            removedIndexCount += 6;
+            collapseCount++;
+        }
+
+        if (collapseCount == 0)
+        {
+            break;
+        }
+
+        for (uint32_t &target : collapsedTo)
+        {
+            target = remap[target];
+        }
+
+        // Triangles that lost an edge are dropped
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < o_Indices.size(); i += 3)
+        {
+            uint32_t a = remap[o_Indices[i + 0]];
+            uint32_t b = remap[o_Indices[i + 1]];
+            uint32_t c = remap[o_Indices[i + 2]];
+
+            if (a != b && b != c && a != c)
+            {
+                o_Indices[writeIndex++] = a;
+                o_Indices[writeIndex++] = b;
+                o_Indices[writeIndex++] = c;
+            }
+        }
+
+        o_Indices.resize(writeIndex);
+    }
+
+    // The quadrics only give a mean distance to the original planes. The reported error is measured instead: the
+    // distance from every removed vertex to the closest simplified triangle around the vertex it was collapsed onto.
+    BuildVertexTriangles(o_Indices, vertexCount, triangleOffsets, vertexTriangles);
+    float reachedError = 0.0f;
+
+    for (uint32_t i = 0; i < vertexCount; ++i)
+    {
+        uint32_t target = collapsedTo[i];
+        if (target == i)
+        {
+            continue;
+        }
+
+        Float3 delta = Sub(positions[i], positions[target]);
+        float distance = sqrtf(Dot(delta, delta));
+
+        for (uint32_t triangle = triangleOffsets[target]; triangle < triangleOffsets[target + 1]; ++triangle)
+        {
+            const uint32_t *pTriangle = o_Indices.data() + vertexTriangles[triangle] * 3;
+            distance = std::min(distance, PointTriangleDistance(positions[i], positions[pTriangle[0]], positions[pTriangle[1]], positions[pTriangle[2]]));
+        }
+
+        reachedError = std::max(reachedError, distance);
+    }
+
+    o_Error = reachedError * extent;
+}
+
+bool meshes::BuildPrimitiveLods(
+    const MeshPrimitive &primitive, const uint8_t *pBufferData, size_t bufferByteSize,
+    const float *pTriangleRatios, const float *pMaxErrors, uint32_t levelCount, uint32_t cacheSize,
+    std::vector<LodLevel> &o_Levels)
+{
+    const AccessorView &positionView = primitive.m_Positions;
+
+    o_Levels.clear();
+
+    if (positionView.m_ComponentType != gltf::s_FloatCode || positionView.m_ComponentCount != 3)
+    {
+        return false;
+    }
+
+    std::vector<uint32_t> indices;
+    if (!ReadPrimitiveIndices(primitive, pBufferData, bufferByteSize, indices))
+    {
+        return false;
+    }
+
+    const uint8_t *pPositions = pBufferData + positionView.m_ByteOffset;
+    size_t positionStride = static_cast<size_t>(positionView.m_ByteStride);
+    size_t vertexCount = static_cast<size_t>(positionView.m_Count);
+    size_t previousIndexCount = indices.size();
+    std::vector<uint32_t> clusterStarts;
+
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        float ratio = std::clamp(pTriangleRatios[level], 0.0f, 1.0f);
+        size_t targetIndexCount = static_cast<size_t>(static_cast<double>(indices.size() / 3) * ratio) * 3;
+
+        LodLevel lod {};
+        lod.m_Level = level + 1;
+        SimplifyMesh(
+            indices.data(), indices.size(), pPositions, positionStride, vertexCount,
+            targetIndexCount, pMaxErrors[level], lod.m_Indices, lod.m_Error);
+
+        if (lod.m_Indices.empty() || lod.m_Indices.size() >= previousIndexCount)
+        {
+            continue;
+        }
+
+        OptimizeVertexCache(lod.m_Indices.data(), lod.m_Indices.size(), vertexCount, cacheSize, clusterStarts);
+
+        previousIndexCount = lod.m_Indices.size();
+        o_Levels.push_back(std::move(lod));
+    }
+
+    return true;
+}
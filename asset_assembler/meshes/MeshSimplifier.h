@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "MeshPrimitives.h"
+
+namespace asset_assembler
+{
+    namespace meshes
+    {
+        // Reduces a triangle list towards targetIndexCount indices with quadric error metrics (Garland and Heckbert 1997).
+        // Edges are collapsed onto one of their vertices, the simplified indices reference the original vertices so the
+        // vertex streams are shared by every level. Vertices on open borders, attribute seams and non-manifold edges stay
+        // in place. A collapse is only made while the root mean square distance of the moved vertex to the planes of its
+        // original triangles stays under maxError, relative to the largest extent of the mesh.
+        // pPositions points to vertexCount float3 positions, positionStride bytes apart.
+        // o_Error receives the largest distance from a removed vertex to the simplified surface, in position units,
+        // which can exceed maxError since the threshold bounds a mean.
+        void SimplifyMesh(
+            const uint32_t *pIndices, size_t indexCount, const uint8_t *pPositions, size_t positionStride, size_t vertexCount,
+            size_t targetIndexCount, float maxError, std::vector<uint32_t> &o_Indices, float &o_Error);
+
+        struct LodLevel
+        {
+            uint32_t                m_Level { 0 };          // 1 is the first level after the primitive's own indices
+            std::vector<uint32_t>   m_Indices {};
+            float                   m_Error { 0.0f };       // Largest distance from a removed vertex to the level, in position units
+        };
+
+        // Builds a level per target ratio of the primitive's triangle count, each simplified from the primitive
+        // with its own error threshold, and optimizes its triangle order for the vertex cache.
+        // Levels that don't have fewer triangles than the previous one are skipped, o_Levels can end up empty.
+        // Returns false when the primitive doesn't have float3 positions, doesn't fit in the buffer or has invalid indices.
+        bool BuildPrimitiveLods(
+            const MeshPrimitive &primitive, const uint8_t *pBufferData, size_t bufferByteSize,
+            const float *pTriangleRatios, const float *pMaxErrors, uint32_t levelCount, uint32_t cacheSize,
+            std::vector<LodLevel> &o_Levels);
+    }
+}
@@ -0,0 +1,262 @@
+#include <pch.h>
+#include "MeshletBuilder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace asset_assembler;
+using namespace asset_assembler::meshes;
+
+namespace
+{
+    static constexpr uint32_t s_UnusedVertex = ~0u;
+
+    // Cones wider than this are too wide to ever cull anything, cos(84 degrees)
+    static constexpr float s_MinConeDot = 0.1f;
+
+    struct Float3
+    {
+        float x, y, z;
+    };
+
+    inline Float3 ReadPosition(const uint8_t *pPositions, size_t stride, uint32_t vertex)
+    {
+        Float3 position;
+        memcpy(&position, pPositions + vertex * stride, sizeof(position));
+        return position;
+    }
+
+    inline Float3 Sub(const Float3 &a, const Float3 &b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    inline Float3 Cross(const Float3 &a, const Float3 &b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    inline float Dot(const Float3 &a, const Float3 &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    inline float Length(const Float3 &a) { return sqrtf(Dot(a, a)); }
+
+    // Ritter's bounding sphere, within a few percent of the minimal sphere
+    void ComputeBoundingSphere(const std::vector<Float3> &points, Float3 &o_Center, float &o_Radius)
+    {
+        auto furthestFrom = [&](const Float3 &origin)
+        {
+            size_t furthest = 0;
+            float maxDistance = -1.0f;
+
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                Float3 delta = Sub(points[i], origin);
+                float distance = Dot(delta, delta);
+
+                if (distance > maxDistance)
+                {
+                    maxDistance = distance;
+                    furthest = i;
+                }
+            }
+
+            return points[furthest];
+        };
+
+        Float3 a = furthestFrom(points[0]);
+        Float3 b = furthestFrom(a);
+
+        Float3 center = { (a.x + b.x) * 0.5f, (a.y + b.y) * 0.5f, (a.z + b.z) * 0.5f };
+        float radius = Length(Sub(b, a)) * 0.5f;
+
+        for (const Float3 &point : points)
+        {
+            float distance = Length(Sub(point, center));
+
+            if (distance > radius)
+            {
+                float grownRadius = (radius + distance) * 0.5f;
+                float shift = (grownRadius - radius) / distance;
+
+                center.x += (point.x - center.x) * shift;
+                center.y += (point.y - center.y) * shift;
+                center.z += (point.z - center.z) * shift;
+                radius = grownRadius;
+            }
+        }
+
+        o_Center = center;
+        o_Radius = radius;
+    }
+
+    void ComputeMeshletBounds(
+        const MeshletSet &set, const uint8_t *pPositions, size_t positionStride, Meshlet &io_Meshlet)
+    {
+        const uint32_t *pVertices = set.m_VertexIndices.data() + io_Meshlet.m_VertexOffset;
+        const uint8_t *pTriangles = set.m_Triangles.data() + io_Meshlet.m_TriangleOffset;
+
+        std::vector<Float3> points(io_Meshlet.m_VertexCount);
+        for (uint32_t i = 0; i < io_Meshlet.m_VertexCount; ++i)
+        {
+            points[i] = ReadPosition(pPositions, positionStride, pVertices[i]);
+        }
+
+        Float3 center;
+        float radius;
+        ComputeBoundingSphere(points, center, radius);
+
+        // Normal cone, degenerate triangles have no facing and are ignored
+        std::vector<Float3> normals;
+        std::vector<Float3> corners;
+        Float3 normalSum = { 0.0f, 0.0f, 0.0f };
+
+        for (uint32_t i = 0; i < io_Meshlet.m_TriangleCount; ++i)
+        {
+            const Float3 &p0 = points[pTriangles[i * 3 + 0]];
+            const Float3 &p1 = points[pTriangles[i * 3 + 1]];
+            const Float3 &p2 = points[pTriangles[i * 3 + 2]];
+
+            Float3 normal = Cross(Sub(p1, p0), Sub(p2, p0));
+            float area = Length(normal);
+
+            if (area > 0.0f)
+            {
+                normal = { normal.x / area, normal.y / area, normal.z / area };
+                normals.push_back(normal);
+                corners.push_back(p0);
+
+                normalSum = { normalSum.x + normal.x, normalSum.y + normal.y, normalSum.z + normal.z };
+            }
+        }
+
+        Float3 axis = { 0.0f, 0.0f, 0.0f };
+        Float3 apex = center;
+        float cutoff = 1.0f;
+        float axisLength = Length(normalSum);
+
+        if (axisLength > 0.0f)
+        {
+            Float3 candidateAxis = { normalSum.x / axisLength, normalSum.y / axisLength, normalSum.z / axisLength };
+
+            float minDot = 1.0f;
+            for (const Float3 &normal : normals)
+            {
+                minDot = std::min(minDot, Dot(candidateAxis, normal));
+            }
+
+            if (minDot > s_MinConeDot)
+            {
+                // Moves the apex back along the axis until it lies behind every triangle plane,
+                // so the test stays conservative for cameras close to the meshlet
+                float maxDistance = 0.0f;
+                for (size_t i = 0; i < normals.size(); ++i)
+                {
+                    float planeDistance = Dot(Sub(center, corners[i]), normals[i]);
+                    maxDistance = std::max(maxDistance, planeDistance / Dot(candidateAxis, normals[i]));
+                }
+
+                axis = candidateAxis;
+                apex = { center.x - axis.x * maxDistance, center.y - axis.y * maxDistance, center.z - axis.z * maxDistance };
+                cutoff = sqrtf(1.0f - minDot * minDot);
+            }
+        }
+
+        io_Meshlet.m_Center[0] = center.x;
+        io_Meshlet.m_Center[1] = center.y;
+        io_Meshlet.m_Center[2] = center.z;
+        io_Meshlet.m_Radius = radius;
+        io_Meshlet.m_ConeApex[0] = apex.x;
+        io_Meshlet.m_ConeApex[1] = apex.y;
+        io_Meshlet.m_ConeApex[2] = apex.z;
+        io_Meshlet.m_ConeCutoff = cutoff;
+        io_Meshlet.m_ConeAxis[0] = axis.x;
+        io_Meshlet.m_ConeAxis[1] = axis.y;
+        io_Meshlet.m_ConeAxis[2] = axis.z;
+        io_Meshlet.m_Padding = 0;
+    }
+}
+
+void meshes::BuildMeshlets(
+    const uint32_t *pIndices, size_t indexCount, const uint8_t *pPositions, size_t positionStride, size_t vertexCount,
+    uint32_t maxVertexCount, uint32_t maxTriangleCount, MeshletSet &o_Meshlets)
+{
+    maxVertexCount = std::clamp(maxVertexCount, 3u, s_MaxMeshletVertexCount);
+    maxTriangleCount = std::clamp(maxTriangleCount, 1u, s_MaxMeshletTriangleCount);
+
+    o_Meshlets = {};
+
+    // Position of every vertex in the current meshlet
+    std::vector<uint32_t> localIndices(vertexCount, s_UnusedVertex);
+    Meshlet meshlet {};
+
+    auto finishMeshlet = [&]()
+    {
+        if (meshlet.m_TriangleCount == 0)
+        {
+            return;
+        }
+
+        ComputeMeshletBounds(o_Meshlets, pPositions, positionStride, meshlet);
+        o_Meshlets.m_Meshlets.push_back(meshlet);
+
+        for (uint32_t i = 0; i < meshlet.m_VertexCount; ++i)
+        {
+            localIndices[o_Meshlets.m_VertexIndices[meshlet.m_VertexOffset + i]] = s_UnusedVertex;
+        }
+
+        // Triangles of every meshlet start on a 4 bytes boundary so shaders can load them as words
+        o_Meshlets.m_Triangles.resize((o_Meshlets.m_Triangles.size() + 3) & ~size_t(3), 0);
+
+        meshlet = {};
+        meshlet.m_VertexOffset = static_cast<uint32_t>(o_Meshlets.m_VertexIndices.size());
+        meshlet.m_TriangleOffset = static_cast<uint32_t>(o_Meshlets.m_Triangles.size());
+    };
+
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        const uint32_t *pTriangle = pIndices + i;
+
+        uint32_t newVertexCount =
+            (localIndices[pTriangle[0]] == s_UnusedVertex ? 1 : 0) +
+            (localIndices[pTriangle[1]] == s_UnusedVertex && pTriangle[1] != pTriangle[0] ? 1 : 0) +
+            (localIndices[pTriangle[2]] == s_UnusedVertex && pTriangle[2] != pTriangle[0] && pTriangle[2] != pTriangle[1] ? 1 : 0);
+
+        if (meshlet.m_VertexCount + newVertexCount > maxVertexCount || meshlet.m_TriangleCount >= maxTriangleCount)
+        {
+            finishMeshlet();
+        }
+
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            uint32_t vertex = pTriangle[corner];
+
+            if (localIndices[vertex] == s_UnusedVertex)
+            {
+                localIndices[vertex] = meshlet.m_VertexCount++;
+                o_Meshlets.m_VertexIndices.push_back(vertex);
+            }
+
+            o_Meshlets.m_Triangles.push_back(static_cast<uint8_t>(localIndices[vertex]));
+        }
+
+        meshlet.m_TriangleCount++;
+    }
+
+    finishMeshlet();
+}
+
+bool meshes::BuildPrimitiveMeshlets(
+    const MeshPrimitive &primitive, const uint8_t *pBufferData, size_t bufferByteSize,
+    uint32_t maxVertexCount, uint32_t maxTriangleCount, MeshletSet &o_Meshlets)
+{
+    const AccessorView &positionView = primitive.m_Positions;
+
+    if (positionView.m_ComponentType != gltf::s_FloatCode || positionView.m_ComponentCount != 3)
+    {
+        return false;
+    }
+
+    std::vector<uint32_t> indices;
+    if (!ReadPrimitiveIndices(primitive, pBufferData, bufferByteSize, indices))
+    {
+        return false;
+    }
+
+    BuildMeshlets(
+        indices.data(), indices.size(),
+        pBufferData + positionView.m_ByteOffset, static_cast<size_t>(positionView.m_ByteStride), static_cast<size_t>(positionView.m_Count),
+        maxVertexCount, maxTriangleCount, o_Meshlets);
+
+    return true;
+}
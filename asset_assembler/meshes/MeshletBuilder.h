@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "MeshPrimitives.h"
+
+namespace asset_assembler
+{
+    namespace meshes
+    {
+        // Local triangle indices are stored as bytes
+        static constexpr uint32_t s_MaxMeshletVertexCount = 256;
+        static constexpr uint32_t s_MaxMeshletTriangleCount = 512;
+
+        // GPU layout of a meshlet, as written to Buffers.bin
+        struct Meshlet
+        {
+            uint32_t    m_VertexOffset;         // First entry of the meshlet in the vertex index array
+            uint32_t    m_TriangleOffset;       // First byte of the meshlet in the triangle array, 4 bytes aligned
+            uint32_t    m_VertexCount;
+            uint32_t    m_TriangleCount;
+
+            // Bounding sphere
+            float       m_Center[3];
+            float       m_Radius;
+
+            // Normal cone, every triangle faces away from a camera at c when
+            // dot(normalize(m_ConeApex - c), m_ConeAxis) >= m_ConeCutoff. A cutoff of 1 never culls.
+            float       m_ConeApex[3];
+            float       m_ConeCutoff;
+            float       m_ConeAxis[3];
+            uint32_t    m_Padding;
+        };
+
+        static_assert(sizeof(Meshlet) == 64, "Meshlet is read as is by shaders");
+
+        // Meshlets of one primitive. Vertex indices point into the primitive's vertex streams,
+        // triangles are three byte indices into the meshlet's vertex indices.
+        struct MeshletSet
+        {
+            std::vector<Meshlet>    m_Meshlets {};
+            std::vector<uint32_t>   m_VertexIndices {};
+            std::vector<uint8_t>    m_Triangles {};
+        };
+
+        // Splits a triangle list into meshlets of at most maxVertexCount vertices and maxTriangleCount triangles,
+        // following the triangle order, which should already be optimized for the vertex cache.
+        // pPositions points to vertexCount float3 positions, positionStride bytes apart.
+        void BuildMeshlets(
+            const uint32_t *pIndices, size_t indexCount, const uint8_t *pPositions, size_t positionStride, size_t vertexCount,
+            uint32_t maxVertexCount, uint32_t maxTriangleCount, MeshletSet &o_Meshlets);
+
+        // Returns false when the primitive doesn't have float3 positions, doesn't fit in the buffer or has invalid indices
+        bool BuildPrimitiveMeshlets(
+            const MeshPrimitive &primitive, const uint8_t *pBufferData, size_t bufferByteSize,
+            uint32_t maxVertexCount, uint32_t maxTriangleCount, MeshletSet &o_Meshlets);
+    }
+}
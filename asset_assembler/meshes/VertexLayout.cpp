@@ -0,0 +1,73 @@
+#include <pch.h>
+#include "VertexLayout.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace asset_assembler;
+
+void meshes::CollectInterleavedStreams(const gltf::Scene &scene, std::vector<AccessorView> &o_Streams)
+{
+    o_Streams.clear();
+
+    std::vector<uint8_t> collected(scene.m_Accessors.size(), 0);
+
+    for (const gltf::Primitive &primitive : scene.m_Primitives)
+    {
+        for (const gltf::Attribute *pAttribute = scene.AttributesBegin(primitive); pAttribute != scene.AttributesEnd(primitive); ++pAttribute)
+        {
+            AccessorView view {};
+
+            if (
+                ReadAccessorView(scene, pAttribute->m_Accessor, view) && !collected[view.m_AccessorIndex] &&
+                view.m_Count > 0 && view.m_ByteStride > view.m_ElementByteSize)
+            {
+                collected[view.m_AccessorIndex] = 1;
+                o_Streams.push_back(view);
+            }
+        }
+    }
+}
+
+void meshes::DeinterleaveStream(const StreamSource &stream, const uint8_t *pBufferData, std::vector<uint8_t> &o_Data)
+{
+    size_t elementByteSize = static_cast<size_t>(stream.m_ElementByteSize);
+    o_Data.resize(static_cast<size_t>(stream.m_Count) * elementByteSize);
+
+    const uint8_t *pSrc = pBufferData + stream.m_ByteOffset;
+
+    for (int64_t i = 0; i < stream.m_Count; ++i)
+    {
+        memcpy(o_Data.data() + i * elementByteSize, pSrc + i * stream.m_ByteStride, elementByteSize);
+    }
+}
+
+int32_t meshes::InterleaveStreams(
+    const StreamSource *pStreams, size_t streamCount, const uint8_t *pBufferData,
+    std::vector<int32_t> &o_AttributeByteOffsets, std::vector<uint8_t> &o_Data)
+{
+    o_AttributeByteOffsets.resize(streamCount);
+
+    int32_t vertexByteSize = 0;
+    for (size_t i = 0; i < streamCount; ++i)
+    {
+        o_AttributeByteOffsets[i] = vertexByteSize;
+        vertexByteSize += (pStreams[i].m_ElementByteSize + 3) & ~3;
+    }
+
+    int64_t vertexCount = streamCount > 0 ? pStreams[0].m_Count : 0;
+    o_Data.assign(static_cast<size_t>(vertexCount * vertexByteSize), 0);
+
+    for (size_t i = 0; i < streamCount; ++i)
+    {
+        const StreamSource &stream = pStreams[i];
+        const uint8_t *pSrc = pBufferData + stream.m_ByteOffset;
+        uint8_t *pDst = o_Data.data() + o_AttributeByteOffsets[i];
+
+        for (int64_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            memcpy(pDst + vertex * vertexByteSize, pSrc + vertex * stream.m_ByteStride, static_cast<size_t>(stream.m_ElementByteSize));
+        }
+    }
+
+    return vertexByteSize;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "MeshPrimitives.h"
+
+namespace asset_assembler
+{
+    namespace meshes
+    {
+        // Elements of a vertex stream as they are in the buffer, after any in place rewrite
+        struct StreamSource
+        {
+            int32_t     m_AccessorIndex { -1 };
+            int64_t     m_ByteOffset { 0 };
+            int64_t     m_Count { 0 };
+            int32_t     m_ElementByteSize { 0 };
+            int32_t     m_ByteStride { 0 };
+        };
+
+        // Collects the vertex attribute accessors of every primitive whose elements are interleaved with other data
+        void CollectInterleavedStreams(const gltf::Scene &scene, std::vector<AccessorView> &o_Streams);
+
+        // Copies the elements of a stream into a tightly packed array
+        void DeinterleaveStream(const StreamSource &stream, const uint8_t *pBufferData, std::vector<uint8_t> &o_Data);
+
+        // Copies streams of the same count into a single array of vertices. Every attribute starts on a 4 bytes
+        // boundary within the vertex and the vertex size is rounded to 4 bytes, as vertex fetch requires.
+        // o_AttributeByteOffsets receives the offset of each stream within the vertex. Returns the vertex stride.
+        int32_t InterleaveStreams(
+            const StreamSource *pStreams, size_t streamCount, const uint8_t *pBufferData,
+            std::vector<int32_t> &o_AttributeByteOffsets, std::vector<uint8_t> &o_Data);
+    }
+}
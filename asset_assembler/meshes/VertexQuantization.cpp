@@ -0,0 +1,434 @@
+#include <pch.h>
+#include "VertexQuantization.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace asset_assembler;
+using namespace asset_assembler::meshes;
+
+namespace
+{
+    static constexpr float s_MaxHalfValue = 65504.0f;
+
+    inline float ReadFloat(const uint8_t *pElement, int32_t component)
+    {
+        float value;
+        memcpy(&value, pElement + component * sizeof(float), sizeof(float));
+        return value;
+    }
+
+    inline uint16_t ReadUInt16(const uint8_t *pElement, int32_t component)
+    {
+        uint16_t value;
+        memcpy(&value, pElement + component * sizeof(uint16_t), sizeof(uint16_t));
+        return value;
+    }
+
+    inline float Sign(float value)
+    {
+        return value >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    struct Float3
+    {
+        float x, y, z;
+    };
+
+    void OctahedralFold(const Float3 &n, float &o_U, float &o_V)
+    {
+        float l1Norm = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+        if (l1Norm <= 0.0f)
+        {
+            o_U = 0.0f;
+            o_V = 0.0f;
+            return;
+        }
+
+        float u = n.x / l1Norm;
+        float v = n.y / l1Norm;
+
+        if (n.z < 0.0f)
+        {
+            float foldedU = (1.0f - fabsf(v)) * Sign(u);
+            v = (1.0f - fabsf(u)) * Sign(v);
+            u = foldedU;
+        }
+
+        o_U = u;
+        o_V = v;
+    }
+
+    Float3 OctahedralUnfold(float u, float v)
+    {
+        Float3 n { u, v, 1.0f - fabsf(u) - fabsf(v) };
+
+        if (n.z < 0.0f)
+        {
+            n.x = (1.0f - fabsf(v)) * Sign(u);
+            n.y = (1.0f - fabsf(u)) * Sign(v);
+        }
+
+        float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+        return { n.x / length, n.y / length, n.z / length };
+    }
+
+    // Picks the rounding of both components that decodes closest to n, plain rounding
+    // can be off by up to a quantization step once the octahedron is unfolded.
+    void EncodeOctahedral(const Float3 &n, int32_t maxValue, int32_t &o_U, int32_t &o_V)
+    {
+        float u, v;
+        OctahedralFold(n, u, v);
+
+        float scaledU = u * maxValue;
+        float scaledV = v * maxValue;
+        float baseU = floorf(scaledU);
+        float baseV = floorf(scaledV);
+
+        float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+        Float3 unit = length > 0.0f ? Float3 { n.x / length, n.y / length, n.z / length } : Float3 { 0.0f, 0.0f, 1.0f };
+
+        float bestDot = -2.0f;
+        o_U = 0;
+        o_V = 0;
+
+        for (int32_t i = 0; i < 4; ++i)
+        {
+            int32_t candidateU = std::clamp(static_cast<int32_t>(baseU) + (i & 1), -maxValue, maxValue);
+            int32_t candidateV = std::clamp(static_cast<int32_t>(baseV) + (i >> 1), -maxValue, maxValue);
+
+            Float3 decoded = OctahedralUnfold(
+                static_cast<float>(candidateU) / maxValue, static_cast<float>(candidateV) / maxValue);
+
+            float dot = decoded.x * unit.x + decoded.y * unit.y + decoded.z * unit.z;
+            if (dot > bestDot)
+            {
+                bestDot = dot;
+                o_U = candidateU;
+                o_V = candidateV;
+            }
+        }
+    }
+
+    template<typename T>
+    inline void WriteComponent(uint8_t *pElement, int32_t component, T value)
+    {
+        memcpy(pElement + component * sizeof(T), &value, sizeof(T));
+    }
+
+    inline uint16_t UNorm16(float value)
+    {
+        return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+    }
+
+    inline uint8_t UNorm8(float value)
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    bool EncodePositions(const AccessorView &view, const uint8_t *pSource, std::vector<uint8_t> &o_Encoded, QuantizedStream &io_Result)
+    {
+        if (view.m_ComponentType != gltf::s_FloatCode || view.m_ComponentCount != 3)
+        {
+            return false;
+        }
+
+        float minimum[3] = { INFINITY, INFINITY, INFINITY };
+        float maximum[3] = { -INFINITY, -INFINITY, -INFINITY };
+
+        for (int64_t i = 0; i < view.m_Count; ++i)
+        {
+            const uint8_t *pElement = pSource + i * view.m_ByteStride;
+
+            for (int32_t axis = 0; axis < 3; ++axis)
+            {
+                float value = ReadFloat(pElement, axis);
+                if (!std::isfinite(value))
+                {
+                    return false;
+                }
+
+                minimum[axis] = std::min(minimum[axis], value);
+                maximum[axis] = std::max(maximum[axis], value);
+            }
+        }
+
+        // GPUs have no three component 16 bits format, w pads the element to 8 bytes
+        io_Result.m_Encoding = VertexEncoding::Position_UNorm16x4;
+        io_Result.m_ComponentType = EncodedComponentType::UNorm16;
+        io_Result.m_ComponentCount = 4;
+        io_Result.m_ElementByteSize = 4 * sizeof(uint16_t);
+
+        float inverseExtent[3];
+        for (int32_t axis = 0; axis < 3; ++axis)
+        {
+            float extent = maximum[axis] - minimum[axis];
+
+            io_Result.m_Scale[axis] = extent;
+            io_Result.m_Offset[axis] = minimum[axis];
+            inverseExtent[axis] = extent > 0.0f ? 1.0f / extent : 0.0f;
+        }
+
+        o_Encoded.assign(static_cast<size_t>(view.m_Count) * io_Result.m_ElementByteSize, 0);
+
+        for (int64_t i = 0; i < view.m_Count; ++i)
+        {
+            const uint8_t *pElement = pSource + i * view.m_ByteStride;
+            uint8_t *pEncoded = o_Encoded.data() + i * io_Result.m_ElementByteSize;
+
+            for (int32_t axis = 0; axis < 3; ++axis)
+            {
+                float normalized = (ReadFloat(pElement, axis) - minimum[axis]) * inverseExtent[axis];
+                WriteComponent(pEncoded, axis, UNorm16(normalized));
+            }
+        }
+
+        return true;
+    }
+
+    bool EncodeDirections(
+        const AccessorView &view, const uint8_t *pSource, bool isTangent, uint32_t octahedralBits,
+        std::vector<uint8_t> &o_Encoded, QuantizedStream &io_Result)
+    {
+        int32_t sourceComponentCount = isTangent ? 4 : 3;
+        if (view.m_ComponentType != gltf::s_FloatCode || view.m_ComponentCount != sourceComponentCount)
+        {
+            return false;
+        }
+
+        bool use8Bits = octahedralBits <= 8;
+        int32_t componentByteSize = use8Bits ? 1 : 2;
+        int32_t maxValue = use8Bits ? 127 : 32767;
+
+        if (isTangent)
+        {
+            io_Result.m_Encoding = use8Bits ? VertexEncoding::OctahedralTangent_SNorm8x4 : VertexEncoding::OctahedralTangent_SNorm16x4;
+            io_Result.m_ComponentCount = 4;
+        }
+        else
+        {
+            io_Result.m_Encoding = use8Bits ? VertexEncoding::Octahedral_SNorm8x2 : VertexEncoding::Octahedral_SNorm16x2;
+            io_Result.m_ComponentCount = 2;
+        }
+
+        io_Result.m_ComponentType = use8Bits ? EncodedComponentType::SNorm8 : EncodedComponentType::SNorm16;
+        io_Result.m_ElementByteSize = io_Result.m_ComponentCount * componentByteSize;
+
+        o_Encoded.assign(static_cast<size_t>(view.m_Count) * io_Result.m_ElementByteSize, 0);
+
+        for (int64_t i = 0; i < view.m_Count; ++i)
+        {
+            const uint8_t *pElement = pSource + i * view.m_ByteStride;
+            uint8_t *pEncoded = o_Encoded.data() + i * io_Result.m_ElementByteSize;
+
+            Float3 direction { ReadFloat(pElement, 0), ReadFloat(pElement, 1), ReadFloat(pElement, 2) };
+            if (!std::isfinite(direction.x) || !std::isfinite(direction.y) || !std::isfinite(direction.z))
+            {
+                return false;
+            }
+
+            int32_t components[3];
+            EncodeOctahedral(direction, maxValue, components[0], components[1]);
+            components[2] = isTangent && ReadFloat(pElement, 3) < 0.0f ? -maxValue : maxValue;
+
+            for (int32_t c = 0; c < (isTangent ? 3 : 2); ++c)
+            {
+                if (use8Bits)
+                {
+                    WriteComponent(pEncoded, c, static_cast<int8_t>(components[c]));
+                }
+                else
+                {
+                    WriteComponent(pEncoded, c, static_cast<int16_t>(components[c]));
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool EncodeTexCoords(const AccessorView &view, const uint8_t *pSource, std::vector<uint8_t> &o_Encoded, QuantizedStream &io_Result)
+    {
+        if (view.m_ComponentType != gltf::s_FloatCode || view.m_ComponentCount != 2)
+        {
+            return false;
+        }
+
+        io_Result.m_Encoding = VertexEncoding::Half2;
+        io_Result.m_ComponentType = EncodedComponentType::Half;
+        io_Result.m_ComponentCount = 2;
+        io_Result.m_ElementByteSize = 2 * sizeof(uint16_t);
+
+        o_Encoded.assign(static_cast<size_t>(view.m_Count) * io_Result.m_ElementByteSize, 0);
+
+        for (int64_t i = 0; i < view.m_Count; ++i)
+        {
+            const uint8_t *pElement = pSource + i * view.m_ByteStride;
+            uint8_t *pEncoded = o_Encoded.data() + i * io_Result.m_ElementByteSize;
+
+            for (int32_t c = 0; c < 2; ++c)
+            {
+                float value = ReadFloat(pElement, c);
+
+                // Heavily tiled coordinates would overflow, those keep their full precision
+                if (!(fabsf(value) <= s_MaxHalfValue))
+                {
+                    return false;
+                }
+
+                WriteComponent(pEncoded, c, FloatToHalf(value));
+            }
+        }
+
+        return true;
+    }
+
+    bool EncodeColors(
+        const AccessorView &view, const uint8_t *pSource, bool normalized, std::vector<uint8_t> &o_Encoded, QuantizedStream &io_Result)
+    {
+        bool isFloat = view.m_ComponentType == gltf::s_FloatCode;
+        bool isUNorm16 = view.m_ComponentType == gltf::s_UnsignedShortCode && normalized;
+
+        if ((!isFloat && !isUNorm16) || (view.m_ComponentCount != 3 && view.m_ComponentCount != 4))
+        {
+            return false;
+        }
+
+        io_Result.m_Encoding = VertexEncoding::Color_UNorm8x4;
+        io_Result.m_ComponentType = EncodedComponentType::UNorm8;
+        io_Result.m_ComponentCount = 4;
+        io_Result.m_ElementByteSize = 4;
+
+        o_Encoded.assign(static_cast<size_t>(view.m_Count) * io_Result.m_ElementByteSize, 0);
+
+        for (int64_t i = 0; i < view.m_Count; ++i)
+        {
+            const uint8_t *pElement = pSource + i * view.m_ByteStride;
+            uint8_t *pEncoded = o_Encoded.data() + i * io_Result.m_ElementByteSize;
+
+            pEncoded[3] = 255;
+
+            for (int32_t c = 0; c < view.m_ComponentCount; ++c)
+            {
+                float value = isFloat ? ReadFloat(pElement, c) : ReadUInt16(pElement, c) / 65535.0f;
+                if (std::isnan(value))
+                {
+                    return false;
+                }
+
+                pEncoded[c] = UNorm8(value);
+            }
+        }
+
+        return true;
+    }
+}
+
+uint16_t meshes::FloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t exponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (exponent == 0xff)
+    {
+        // Infinity keeps an empty mantissa, NaN stays quiet
+        return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    }
+
+    int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+
+    if (halfExponent >= 31)
+    {
+        return static_cast<uint16_t>(sign | 0x7c00);
+    }
+
+    if (halfExponent <= 0)
+    {
+        if (halfExponent < -10)
+        {
+            return static_cast<uint16_t>(sign);
+        }
+
+        // Denormal, the implicit leading bit becomes explicit
+        mantissa |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t midpoint = 1u << (shift - 1);
+
+        // Round to nearest even
+        if (remainder > midpoint || (remainder == midpoint && (half & 1)))
+        {
+            ++half;
+        }
+
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1fff;
+
+    // A carry out of the mantissa correctly bumps the exponent, up to infinity
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+    {
+        ++half;
+    }
+
+    return static_cast<uint16_t>(sign | half);
+}
+
+bool meshes::QuantizeVertexStream(
+    const VertexStream &stream, uint8_t *pBufferData, size_t bufferByteSize, uint32_t octahedralBits, QuantizedStream &o_Result)
+{
+    const AccessorView &view = stream.m_View;
+
+    if (
+        view.m_Count <= 0 || view.m_ByteStride != view.m_ElementByteSize ||
+        view.m_ByteOffset < 0 || static_cast<uint64_t>(view.m_ByteOffset + view.ByteSpan()) > bufferByteSize)
+    {
+        return false;
+    }
+
+    uint8_t *pSource = pBufferData + view.m_ByteOffset;
+    std::vector<uint8_t> encoded;
+    QuantizedStream result {};
+    bool success = false;
+
+    switch (stream.m_Semantic)
+    {
+    case VertexSemantic::Position:
+        success = EncodePositions(view, pSource, encoded, result);
+        break;
+    case VertexSemantic::Normal:
+        success = EncodeDirections(view, pSource, false, octahedralBits, encoded, result);
+        break;
+    case VertexSemantic::Tangent:
+        success = EncodeDirections(view, pSource, true, octahedralBits, encoded, result);
+        break;
+    case VertexSemantic::TexCoord:
+        success = EncodeTexCoords(view, pSource, encoded, result);
+        break;
+    case VertexSemantic::Color:
+        success = EncodeColors(view, pSource, stream.m_Normalized, encoded, result);
+        break;
+    default:
+        break;
+    }
+
+    if (!success || result.m_ElementByteSize >= view.m_ElementByteSize)
+    {
+        return false;
+    }
+
+    size_t sourceByteSize = static_cast<size_t>(view.ByteSpan());
+    memcpy(pSource, encoded.data(), encoded.size());
+    memset(pSource + encoded.size(), 0, sourceByteSize - encoded.size());
+
+    o_Result = result;
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "MeshPrimitives.h"
+
+namespace asset_assembler
+{
+    namespace meshes
+    {
+        // Layout of a vertex stream once quantized, stored in the BufferViewEncoding table.
+        // Every encoding decodes with value = offset + fetched * scale, where fetched is the value returned by
+        // the input assembler for the encoded component type (UNORM and SNORM components are fetched normalized).
+        enum class VertexEncoding : int32_t
+        {
+            Raw,                            // Source layout kept
+            Position_UNorm16x4,             // xyz normalized to the stream bounds, w unused
+            Octahedral_SNorm16x2,           // Unit vector folded on the octahedron
+            Octahedral_SNorm8x2,
+            OctahedralTangent_SNorm16x4,    // xy octahedral direction, z bitangent sign, w unused
+            OctahedralTangent_SNorm8x4,
+            Half2,                          // IEEE 754 half precision
+            Color_UNorm8x4                  // Alpha is 1 for RGB sources
+        };
+
+        // Format of the components of a quantized stream, stored in the BufferViewEncoding table.
+        // Normalized formats are fetched as floats in [0, 1] or [-1, 1].
+        enum class EncodedComponentType : int32_t
+        {
+            None,                           // Raw streams keep the component type of their accessor
+            UNorm8,
+            SNorm8,
+            UNorm16,
+            SNorm16,
+            Half                            // IEEE 754 half precision
+        };
+
+        struct QuantizedStream
+        {
+            VertexEncoding          m_Encoding { VertexEncoding::Raw };
+            EncodedComponentType    m_ComponentType { EncodedComponentType::None };
+            int32_t                 m_ComponentCount { 0 };
+            int32_t                 m_ElementByteSize { 0 };
+            float                   m_Scale[3] { 1.0f, 1.0f, 1.0f };
+            float                   m_Offset[3] { 0.0f, 0.0f, 0.0f };
+        };
+
+        uint16_t FloatToHalf(float value);
+
+        // Rewrites a tightly packed stream in place with a smaller encoding chosen from its semantic.
+        // The encoded elements are packed from the start of the stream and the freed tail is zeroed.
+        // octahedralBits selects 8 or 16 bits per component for normals and tangents.
+        // Returns false, leaving the buffer untouched, when the stream has no smaller encoding or doesn't fit in the buffer.
+        bool QuantizeVertexStream(
+            const VertexStream &stream, uint8_t *pBufferData, size_t bufferByteSize, uint32_t octahedralBits, QuantizedStream &o_Result);
+    }
+}
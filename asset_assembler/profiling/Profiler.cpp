@@ -0,0 +1,167 @@
+#include <pch.h>
+#include "Profiler.h"
+#include "rapidjson/filewritestream.h"
+#include "rapidjson/writer.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+using namespace asset_assembler::profiling;
+using namespace rapidjson;
+
+namespace
+{
+    struct ZoneEvent
+    {
+        const char*     m_pName;
+        int64_t         m_Index;
+        uint64_t        m_StartNs;
+        uint64_t        m_EndNs;
+        uint32_t        m_ThreadId;
+    };
+
+    std::atomic<bool>       s_Enabled { false };
+    std::atomic<uint32_t>   s_NextThreadId { 0 };
+    std::mutex              s_EventsMutex;
+    std::vector<ZoneEvent>  s_Events;
+    uint64_t                s_OriginNs = 0;
+
+    uint32_t CurrentThreadId()
+    {
+        // Small sequential ids read better in trace viewers than native thread ids
+        thread_local uint32_t s_ThreadId = s_NextThreadId.fetch_add(1);
+        return s_ThreadId;
+    }
+}
+
+void Profiler::SetEnabled(bool enabled)
+{
+    if (enabled && !s_Enabled)
+    {
+        Reset();
+    }
+
+    s_Enabled = enabled;
+}
+
+bool Profiler::IsEnabled()
+{
+    return s_Enabled;
+}
+
+void Profiler::Reset()
+{
+    std::lock_guard<std::mutex> lock(s_EventsMutex);
+    s_Events.clear();
+    s_OriginNs = NowNanoseconds();
+}
+
+uint64_t Profiler::NowNanoseconds()
+{
+    using namespace std::chrono;
+    return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+void Profiler::RecordZone(const char *pName, int64_t index, uint64_t startNs, uint64_t endNs)
+{
+    uint32_t threadId = CurrentThreadId();
+
+    std::lock_guard<std::mutex> lock(s_EventsMutex);
+    s_Events.push_back({ pName, index, startNs, endNs, threadId });
+}
+
+bool Profiler::WriteChromeTrace(const char *pFilePath)
+{
+    FILE *pFile = nullptr;
+    if (fopen_s(&pFile, pFilePath, "wb") != 0 || !pFile)
+    {
+        return false;
+    }
+
+    char writeBuffer[64 * 1024];
+    FileWriteStream stream(pFile, writeBuffer, sizeof(writeBuffer));
+    Writer<FileWriteStream> writer(stream);
+
+    {
+        std::lock_guard<std::mutex> lock(s_EventsMutex);
+
+        writer.StartObject();
+        writer.Key("displayTimeUnit");
+        writer.String("ms");
+        writer.Key("traceEvents");
+        writer.StartArray();
+
+        for (const ZoneEvent &zone : s_Events)
+        {
+            uint64_t startNs = zone.m_StartNs > s_OriginNs ? zone.m_StartNs - s_OriginNs : 0;
+
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(zone.m_pName);
+            writer.Key("cat");
+            writer.String("asset_assembler");
+            writer.Key("ph");
+            writer.String("X");
+            writer.Key("pid");
+            writer.Uint(0);
+            writer.Key("tid");
+            writer.Uint(zone.m_ThreadId);
+            writer.Key("ts");
+            writer.Double(startNs / 1000.0);
+            writer.Key("dur");
+            writer.Double((zone.m_EndNs - zone.m_StartNs) / 1000.0);
+
+            if (zone.m_Index >= 0)
+            {
+                writer.Key("args");
+                writer.StartObject();
+                writer.Key("index");
+                writer.Int64(zone.m_Index);
+                writer.EndObject();
+            }
+
+            writer.EndObject();
+        }
+
+        writer.EndArray();
+        writer.EndObject();
+    }
+
+    stream.Flush();
+    bool success = ferror(pFile) == 0;
+    fclose(pFile);
+
+    return success;
+}
+
+ScopedZone::ScopedZone(const char *pName, int64_t index, double *o_pSeconds)
+    : m_pName(pName)
+    , m_Index(index)
+    , m_pSeconds(o_pSeconds)
+    , m_StartNs(0)
+    , m_Active(o_pSeconds || Profiler::IsEnabled())
+{
+    if (m_Active)
+    {
+        m_StartNs = Profiler::NowNanoseconds();
+    }
+}
+
+ScopedZone::~ScopedZone()
+{
+    if (m_Active)
+    {
+        uint64_t endNs = Profiler::NowNanoseconds();
+
+        if (m_pSeconds)
+        {
+            *m_pSeconds += (endNs - m_StartNs) * 1e-9;
+        }
+
+        if (Profiler::IsEnabled())
+        {
+            Profiler::RecordZone(m_pName, m_Index, m_StartNs, endNs);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+namespace asset_assembler
+{
+    namespace profiling
+    {
+        // Process-wide recorder of timed zones. Recording is off by default, in which case zones only
+        // cost a clock read when they accumulate into a stage duration and nothing otherwise.
+        class Profiler
+        {
+        public:
+
+            static void         SetEnabled(bool enabled);
+            static bool         IsEnabled();
+            static void         Reset();
+
+            static uint64_t     NowNanoseconds();
+            static void         RecordZone(const char *pName, int64_t index, uint64_t startNs, uint64_t endNs);
+
+            // Writes every recorded zone as a Chrome trace_event JSON file (chrome://tracing, Perfetto).
+            static bool         WriteChromeTrace(const char *pFilePath);
+        };
+
+        // Times the enclosing scope. pName must outlive the profiler (string literal).
+        // index identifies the unit of work (image, buffer, primitive...), -1 if not applicable.
+        // When o_pSeconds is provided, the elapsed time is added to it.
+        class ScopedZone
+        {
+        public:
+
+            explicit ScopedZone(const char *pName, int64_t index = -1, double *o_pSeconds = nullptr);
+            ~ScopedZone();
+
+            ScopedZone(const ScopedZone&) = delete;
+            ScopedZone& operator=(const ScopedZone&) = delete;
+
+        private:
+
+            const char*         m_pName;
+            int64_t             m_Index;
+            double*             m_pSeconds;
+            uint64_t            m_StartNs;
+            bool                m_Active;
+        };
+    }
+}
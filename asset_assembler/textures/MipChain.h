@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+namespace asset_assembler
+{
+    namespace textures
+    {
+        static constexpr int32_t s_MaxMipCount = 20;
+
+        struct MipData
+        {
+            int32_t         m_Width { 0 };
+            int32_t         m_Height { 0 };
+            int64_t         m_ByteSize { 0 };
+            const uint8_t*  m_pData { nullptr };
+        };
+
+        // Non-owning description of a compressed texture, whatever produced it (Compressonator, build cache...).
+        struct MipChain
+        {
+            int32_t         m_MipCount { 0 };
+            int32_t         m_Format { 0 };         // salvation::asset::TextureFormat of every mip
+            MipData         m_Mips[s_MaxMipCount] {};
+
+            int64_t ByteSize() const
+            {
+                int64_t byteSize = 0;
+                for (int32_t i = 0; i < m_MipCount; ++i)
+                {
+                    byteSize += m_Mips[i].m_ByteSize;
+                }
+                return byteSize;
+            }
+        };
+    }
+}
@@ -0,0 +1,244 @@
+#include <pch.h>
+#include "TextureCache.h"
+#include <algorithm>
+#include <cinttypes>
+#include <filesystem>
+#include <thread>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace asset_assembler::textures;
+namespace fs = std::filesystem;
+
+namespace
+{
+    static constexpr uint32_t s_EntryMagic = 0x43544141; // 'AATC'
+    static constexpr uint32_t s_EntryVersion = 2;
+    static constexpr char s_EntryExtension[] = ".tex";
+
+    struct EntryHeader
+    {
+        uint32_t    m_Magic;
+        uint32_t    m_Version;
+        int32_t     m_MipCount;
+        int32_t     m_Format;
+    };
+
+    struct EntryMip
+    {
+        int32_t     m_Width;
+        int32_t     m_Height;
+        int64_t     m_ByteSize;
+    };
+}
+
+TextureCache::TextureCache(const char *pDirectory, uint64_t maxByteSize)
+    : m_MaxByteSize(maxByteSize)
+{
+    if (pDirectory && pDirectory[0])
+    {
+        std::error_code error;
+        fs::create_directories(pDirectory, error);
+
+        if (fs::is_directory(pDirectory, error))
+        {
+            m_Directory = pDirectory;
+        }
+    }
+}
+
+std::string TextureCache::EntryPath(const TextureCacheKey &key) const
+{
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "/%016" PRIx64 "%016" PRIx64 "%s", key.m_SourceHash, key.m_SettingsHash, s_EntryExtension);
+
+    return m_Directory + fileName;
+}
+
+bool TextureCache::Load(const TextureCacheKey &key, MipChain &o_Chain, std::vector<uint8_t> &o_Storage)
+{
+    std::string entryPath = EntryPath(key);
+    FILE *pFile = nullptr;
+
+    if (fopen_s(&pFile, entryPath.c_str(), "rb") != 0 || !pFile)
+    {
+        ++m_MissCount;
+        return false;
+    }
+
+    EntryHeader header {};
+    EntryMip mips[s_MaxMipCount] {};
+    bool valid =
+        fread(&header, sizeof(header), 1, pFile) == 1 &&
+        header.m_Magic == s_EntryMagic &&
+        header.m_Version == s_EntryVersion &&
+        header.m_MipCount > 0 && header.m_MipCount <= s_MaxMipCount &&
+        fread(mips, sizeof(EntryMip), header.m_MipCount, pFile) == static_cast<size_t>(header.m_MipCount);
+
+    int64_t dataByteSize = 0;
+    for (int32_t i = 0; valid && i < header.m_MipCount; ++i)
+    {
+        valid = mips[i].m_ByteSize > 0;
+        dataByteSize += mips[i].m_ByteSize;
+    }
+
+    if (valid)
+    {
+        o_Storage.resize(static_cast<size_t>(dataByteSize));
+        valid = fread(o_Storage.data(), sizeof(uint8_t), o_Storage.size(), pFile) == o_Storage.size();
+    }
+
+    fclose(pFile);
+
+    // Corrupted or outdated entries are treated as misses and overwritten by the next Store
+    if (!valid)
+    {
+        o_Storage.clear();
+        ++m_MissCount;
+        return false;
+    }
+
+    o_Chain = {};
+    o_Chain.m_MipCount = header.m_MipCount;
+    o_Chain.m_Format = header.m_Format;
+
+    const uint8_t *pData = o_Storage.data();
+    for (int32_t i = 0; i < header.m_MipCount; ++i)
+    {
+        MipData &mip = o_Chain.m_Mips[i];
+        mip.m_Width = mips[i].m_Width;
+        mip.m_Height = mips[i].m_Height;
+        mip.m_ByteSize = mips[i].m_ByteSize;
+        mip.m_pData = pData;
+
+        pData += mip.m_ByteSize;
+    }
+
+    // Mark the entry as recently used for eviction
+    std::error_code error;
+    fs::last_write_time(entryPath, fs::file_time_type::clock::now(), error);
+
+    ++m_HitCount;
+    return true;
+}
+
+bool TextureCache::Store(const TextureCacheKey &key, const MipChain &chain)
+{
+    if (chain.m_MipCount <= 0 || chain.m_MipCount > s_MaxMipCount)
+    {
+        return false;
+    }
+
+    // Written under a temporary name unique to the process and thread first so concurrent builds never read a
+    // partial entry. Thread ids alone are reused across processes.
+#if defined(_WIN32)
+    unsigned long long processId = static_cast<unsigned long long>(_getpid());
+#else
+    unsigned long long processId = static_cast<unsigned long long>(getpid());
+#endif
+
+    std::string entryPath = EntryPath(key);
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), ".%llx.%zx.tmp", processId, std::hash<std::thread::id>()(std::this_thread::get_id()));
+    std::string tempPath = entryPath + suffix;
+
+    FILE *pFile = nullptr;
+    if (fopen_s(&pFile, tempPath.c_str(), "wb") != 0 || !pFile)
+    {
+        return false;
+    }
+
+    EntryHeader header { s_EntryMagic, s_EntryVersion, chain.m_MipCount, chain.m_Format };
+    bool success = fwrite(&header, sizeof(header), 1, pFile) == 1;
+
+    for (int32_t i = 0; success && i < chain.m_MipCount; ++i)
+    {
+        EntryMip mip { chain.m_Mips[i].m_Width, chain.m_Mips[i].m_Height, chain.m_Mips[i].m_ByteSize };
+        success = fwrite(&mip, sizeof(mip), 1, pFile) == 1;
+    }
+
+    for (int32_t i = 0; success && i < chain.m_MipCount; ++i)
+    {
+        const MipData &mip = chain.m_Mips[i];
+        success = fwrite(mip.m_pData, sizeof(uint8_t), mip.m_ByteSize, pFile) == static_cast<size_t>(mip.m_ByteSize);
+    }
+
+    success = fclose(pFile) == 0 && success;
+
+    std::error_code error;
+    if (success)
+    {
+        fs::rename(tempPath, entryPath, error);
+        success = !error;
+    }
+
+    if (!success)
+    {
+        fs::remove(tempPath, error);
+    }
+
+    return success;
+}
+
+void TextureCache::Evict()
+{
+    if (!IsEnabled() || m_MaxByteSize == 0)
+    {
+        return;
+    }
+
+    struct Entry
+    {
+        fs::path                m_Path;
+        uint64_t                m_ByteSize;
+        fs::file_time_type      m_LastUse;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t totalByteSize = 0;
+    std::error_code error;
+
+    for (fs::directory_iterator it(m_Directory, error), end; !error && it != end; it.increment(error))
+    {
+        const fs::directory_entry &dirEntry = *it;
+        if (dirEntry.path().extension() != s_EntryExtension)
+        {
+            continue;
+        }
+
+        std::error_code entryError;
+        uint64_t byteSize = dirEntry.file_size(entryError);
+        fs::file_time_type lastUse = dirEntry.last_write_time(entryError);
+
+        if (!entryError)
+        {
+            entries.push_back({ dirEntry.path(), byteSize, lastUse });
+            totalByteSize += byteSize;
+        }
+    }
+
+    if (totalByteSize <= m_MaxByteSize)
+    {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.m_LastUse < b.m_LastUse; });
+
+    for (const Entry &entry : entries)
+    {
+        if (totalByteSize <= m_MaxByteSize)
+        {
+            break;
+        }
+
+        if (fs::remove(entry.m_Path, error))
+        {
+            totalByteSize -= entry.m_ByteSize;
+            ++m_EvictedCount;
+        }
+    }
+}
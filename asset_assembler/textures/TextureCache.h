@@ -0,0 +1,50 @@
+#pragma once
+
+#include "MipChain.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace asset_assembler
+{
+    namespace textures
+    {
+        struct TextureCacheKey
+        {
+            uint64_t    m_SourceHash { 0 };     // Hash of the source image bytes
+            uint64_t    m_SettingsHash { 0 };   // Hash of everything that influences compression (format, quality, mips)
+        };
+
+        // Local on-disk cache of compressed mip chains, addressed by content. Load and Store can be called
+        // concurrently from worker threads. Entries are touched on every hit so eviction drops the least
+        // recently used ones first once the cache grows past its maximum size.
+        class TextureCache
+        {
+        public:
+
+            TextureCache(const char *pDirectory, uint64_t maxByteSize);
+
+            bool            IsEnabled() const { return !m_Directory.empty(); }
+
+            // On success, o_Chain points into o_Storage
+            bool            Load(const TextureCacheKey &key, MipChain &o_Chain, std::vector<uint8_t> &o_Storage);
+            bool            Store(const TextureCacheKey &key, const MipChain &chain);
+            void            Evict();
+
+            uint32_t        HitCount() const { return m_HitCount; }
+            uint32_t        MissCount() const { return m_MissCount; }
+            uint32_t        EvictedCount() const { return m_EvictedCount; }
+
+        private:
+
+            std::string     EntryPath(const TextureCacheKey &key) const;
+
+            std::string             m_Directory;
+            uint64_t                m_MaxByteSize;
+            std::atomic<uint32_t>   m_HitCount { 0 };
+            std::atomic<uint32_t>   m_MissCount { 0 };
+            uint32_t                m_EvictedCount { 0 };
+        };
+    }
+}
@@ -0,0 +1,61 @@
+#include <pch.h>
+#include "TextureFormatSelection.h"
+#include "gltf/GltfScene.h"
+
+using namespace asset_assembler;
+
+void textures::CollectImageUsages(const gltf::Scene &scene, std::vector<uint32_t> &o_UsageMasks)
+{
+    o_UsageMasks.assign(scene.m_Images.size(), 0);
+
+    for (const gltf::Material &material : scene.m_Materials)
+    {
+        for (uint32_t usage = 0; usage < static_cast<uint32_t>(TextureUsage::Count); ++usage)
+        {
+            int32_t textureIndex = material.m_Textures[usage];
+            int32_t imageIndex = textureIndex != gltf::s_InvalidIndex ? scene.m_Textures[textureIndex].m_Image : gltf::s_InvalidIndex;
+
+            if (imageIndex != gltf::s_InvalidIndex)
+            {
+                o_UsageMasks[imageIndex] |= 1u << usage;
+            }
+        }
+    }
+}
+
+textures::BlockFormat textures::SelectBlockFormat(uint32_t usageMask, const BlockFormat *pFormats)
+{
+    static constexpr BlockFormat s_DefaultFormats[] =
+    {
+        BlockFormat::Auto,  // BaseColor
+        BlockFormat::BC5,   // Normal
+        BlockFormat::BC4,   // Occlusion
+        BlockFormat::BC7,   // MetallicRoughness
+        BlockFormat::Auto   // Emissive
+    };
+
+    static_assert(ARRAY_SIZE(s_DefaultFormats) == static_cast<size_t>(TextureUsage::Count), "Missing default format");
+
+    BlockFormat selectedFormat = BlockFormat::Auto;
+    bool selected = false;
+
+    for (uint32_t usage = 0; usage < static_cast<uint32_t>(TextureUsage::Count); ++usage)
+    {
+        if ((usageMask & (1u << usage)) == 0)
+        {
+            continue;
+        }
+
+        BlockFormat format = pFormats[usage] != BlockFormat::Auto ? pFormats[usage] : s_DefaultFormats[usage];
+
+        if (selected && format != selectedFormat)
+        {
+            return BlockFormat::BC7;
+        }
+
+        selectedFormat = format;
+        selected = true;
+    }
+
+    return selectedFormat;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace asset_assembler::gltf
+{
+    struct Scene;
+}
+
+namespace asset_assembler
+{
+    namespace textures
+    {
+        // Material slots an image can be sampled from
+        enum class TextureUsage : uint32_t
+        {
+            BaseColor,
+            Normal,
+            Occlusion,
+            MetallicRoughness,
+            Emissive,
+            Count
+        };
+
+        enum class BlockFormat : uint32_t
+        {
+            Auto,       // BC1 for opaque images, BC3 for images with translucent texels
+            BC1,
+            BC3,
+            BC4,        // Red channel only
+            BC5,        // Red and green channels, the blue channel of normal maps is reconstructed when sampling
+            BC7
+        };
+
+        // One mask per images[] entry, with a bit per TextureUsage of every material sampling it through textures[].source
+        void CollectImageUsages(const gltf::Scene &scene, std::vector<uint32_t> &o_UsageMasks);
+
+        // Format of an image used in every slot of usageMask. pFormats holds a format per TextureUsage, Auto entries
+        // pick the default of their slot: Auto for colors, BC5 for normal maps, BC4 for occlusion and BC7 for
+        // metallic-roughness. Images whose slots don't agree, such as packed occlusion-roughness-metallic, use BC7.
+        // Unused images are colors.
+        BlockFormat SelectBlockFormat(uint32_t usageMask, const BlockFormat *pFormats);
+
+        inline BlockFormat ResolveBlockFormat(BlockFormat format, bool hasTranslucentTexels)
+        {
+            return format != BlockFormat::Auto ? format : (hasTranslucentTexels ? BlockFormat::BC3 : BlockFormat::BC1);
+        }
+
+        // Whether a texture compressed to resolvedFormat could have been selected as format, whatever its alpha content
+        inline bool MatchesBlockFormat(BlockFormat format, BlockFormat resolvedFormat)
+        {
+            return format != BlockFormat::Auto ?
+                resolvedFormat == format :
+                resolvedFormat == BlockFormat::BC1 || resolvedFormat == BlockFormat::BC3;
+        }
+    }
+}
@@ -0,0 +1,15 @@
+#include <pch.h>
+#include "OrderedParallelFor.h"
+
+using namespace asset_assembler::threading;
+
+uint32_t asset_assembler::threading::ResolveWorkerThreadCount(uint32_t requestedCount)
+{
+    if (requestedCount > 0)
+    {
+        return requestedCount;
+    }
+
+    uint32_t coreCount = std::thread::hardware_concurrency();
+    return coreCount > 0 ? coreCount : 1;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace asset_assembler
+{
+    namespace threading
+    {
+        // Returns the number of worker threads to spawn for a requested count (0 means every available core).
+        uint32_t ResolveWorkerThreadCount(uint32_t requestedCount);
+
+        // Runs processFunc(i) for every i in [0, itemCount) on up to workerCount threads and calls
+        // commitFunc(i) on the calling thread in increasing index order as soon as item i is processed.
+        // At most maxInFlight items are processed ahead of the last committed one, which bounds the memory
+        // held by processed but not yet committed results. Processing stops as soon as commitFunc returns false.
+        // Items that were processed but never committed must be cleaned up by the caller.
+        template<typename ProcessFunc, typename CommitFunc>
+        bool OrderedParallelFor(uint32_t itemCount, uint32_t workerCount, uint32_t maxInFlight, ProcessFunc &&processFunc, CommitFunc &&commitFunc)
+        {
+            workerCount = workerCount < itemCount ? workerCount : itemCount;
+            maxInFlight = maxInFlight > 0 ? maxInFlight : 1;
+
+            if (workerCount <= 1)
+            {
+                for (uint32_t i = 0; i < itemCount; ++i)
+                {
+                    processFunc(i);
+                    if (!commitFunc(i))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::vector<uint8_t> processed(itemCount, 0);
+            uint32_t nextItem = 0;
+            uint32_t committedCount = 0;
+            bool aborted = false;
+
+            auto workerLoop = [&]()
+            {
+                for (;;)
+                {
+                    uint32_t item;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        condition.wait(lock, [&]()
+                        {
+                            return aborted || nextItem >= itemCount || nextItem < committedCount + maxInFlight;
+                        });
+
+                        if (aborted || nextItem >= itemCount)
+                        {
+                            return;
+                        }
+
+                        item = nextItem++;
+                    }
+
+                    processFunc(item);
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        processed[item] = 1;
+                    }
+                    condition.notify_all();
+                }
+            };
+
+            std::vector<std::thread> workers;
+            workers.reserve(workerCount);
+            for (uint32_t i = 0; i < workerCount; ++i)
+            {
+                workers.emplace_back(workerLoop);
+            }
+
+            bool success = true;
+
+            for (uint32_t i = 0; i < itemCount; ++i)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    condition.wait(lock, [&]() { return processed[i] != 0; });
+                }
+
+                success = commitFunc(i);
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    committedCount = i + 1;
+                    aborted = !success;
+                }
+                condition.notify_all();
+
+                if (!success)
+                {
+                    break;
+                }
+            }
+
+            for (std::thread &worker : workers)
+            {
+                worker.join();
+            }
+
+            return success;
+        }
+    }
+}
@@ -0,0 +1,538 @@
+#include "SceneGenerator.h"
+#include "Salvation_Common/Core/Defines.h"
+#include "asset_assembler/rapidjson/filewritestream.h"
+#include "asset_assembler/rapidjson/writer.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace asset_assembler_bench;
+using namespace rapidjson;
+
+namespace
+{
+    static constexpr size_t s_MaxPathLen = 1024;
+
+    static constexpr int s_glTFUnsignedIntCode = 5125;
+    static constexpr int s_glTFFloatCode = 5126;
+    static constexpr int s_glTFArrayBufferTarget = 34962;
+    static constexpr int s_glTFElementArrayBufferTarget = 34963;
+
+    struct Random
+    {
+        explicit Random(uint32_t seed) : m_State(seed * 2654435761u + 1u) {}
+
+        uint32_t Next()
+        {
+            // xorshift32
+            m_State ^= m_State << 13;
+            m_State ^= m_State >> 17;
+            m_State ^= m_State << 5;
+            return m_State;
+        }
+
+        uint32_t m_State;
+    };
+
+    uint32_t Crc32(uint32_t crc, const uint8_t *pData, size_t size)
+    {
+        static uint32_t s_Table[256] = {};
+        static bool s_TableInitialized = false;
+
+        if (!s_TableInitialized)
+        {
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k)
+                {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                s_Table[i] = c;
+            }
+            s_TableInitialized = true;
+        }
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc = s_Table[(crc ^ pData[i]) & 0xFF] ^ (crc >> 8);
+        }
+
+        return ~crc;
+    }
+
+    void AppendBigEndian32(std::vector<uint8_t> &o_Bytes, uint32_t value)
+    {
+        o_Bytes.push_back(static_cast<uint8_t>(value >> 24));
+        o_Bytes.push_back(static_cast<uint8_t>(value >> 16));
+        o_Bytes.push_back(static_cast<uint8_t>(value >> 8));
+        o_Bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    void AppendPngChunk(std::vector<uint8_t> &o_Png, const char *pType, const std::vector<uint8_t> &data)
+    {
+        AppendBigEndian32(o_Png, static_cast<uint32_t>(data.size()));
+
+        size_t typeOffset = o_Png.size();
+        o_Png.insert(o_Png.end(), pType, pType + 4);
+        o_Png.insert(o_Png.end(), data.begin(), data.end());
+
+        AppendBigEndian32(o_Png, Crc32(0, o_Png.data() + typeOffset, o_Png.size() - typeOffset));
+    }
+
+    // Encodes an RGBA8 image as a PNG made of stored (uncompressed) deflate blocks. Compression ratio is
+    // irrelevant here, only decoding has to go through the same path as real content.
+    bool WritePng(const char *pFilePath, const uint8_t *pTexels, uint32_t width, uint32_t height, uint64_t &o_ByteSize)
+    {
+        static constexpr uint8_t s_Signature[] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+        static constexpr size_t s_MaxStoredBlockSize = 65535;
+
+        size_t rowSize = static_cast<size_t>(width) * 4;
+        std::vector<uint8_t> raw;
+        raw.reserve((rowSize + 1) * height);
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            raw.push_back(0); // No filter
+            raw.insert(raw.end(), pTexels + y * rowSize, pTexels + (y + 1) * rowSize);
+        }
+
+        std::vector<uint8_t> zlib;
+        zlib.reserve(raw.size() + raw.size() / s_MaxStoredBlockSize * 5 + 16);
+        zlib.push_back(0x78);
+        zlib.push_back(0x01);
+
+        for (size_t offset = 0; offset < raw.size() || offset == 0; offset += s_MaxStoredBlockSize)
+        {
+            size_t blockSize = raw.size() - offset < s_MaxStoredBlockSize ? raw.size() - offset : s_MaxStoredBlockSize;
+            bool isFinal = offset + blockSize >= raw.size();
+
+            zlib.push_back(isFinal ? 1 : 0);
+            zlib.push_back(static_cast<uint8_t>(blockSize));
+            zlib.push_back(static_cast<uint8_t>(blockSize >> 8));
+            zlib.push_back(static_cast<uint8_t>(~blockSize));
+            zlib.push_back(static_cast<uint8_t>(~blockSize >> 8));
+            zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+
+            if (isFinal)
+            {
+                break;
+            }
+        }
+
+        uint32_t adlerA = 1;
+        uint32_t adlerB = 0;
+        for (uint8_t byte : raw)
+        {
+            adlerA = (adlerA + byte) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+        AppendBigEndian32(zlib, (adlerB << 16) | adlerA);
+
+        std::vector<uint8_t> header;
+        AppendBigEndian32(header, width);
+        AppendBigEndian32(header, height);
+        header.push_back(8); // Bit depth
+        header.push_back(6); // RGBA
+        header.push_back(0); // Deflate
+        header.push_back(0); // Adaptive filtering
+        header.push_back(0); // No interlace
+
+        std::vector<uint8_t> png(s_Signature, s_Signature + sizeof(s_Signature));
+        AppendPngChunk(png, "IHDR", header);
+        AppendPngChunk(png, "IDAT", zlib);
+        AppendPngChunk(png, "IEND", {});
+
+        FILE *pFile = nullptr;
+        if (fopen_s(&pFile, pFilePath, "wb") != 0 || !pFile)
+        {
+            return false;
+        }
+
+        bool success = fwrite(png.data(), sizeof(uint8_t), png.size(), pFile) == png.size();
+        fclose(pFile);
+
+        o_ByteSize = png.size();
+        return success;
+    }
+
+    bool GenerateImage(const SceneDesc &desc, uint32_t imageIndex, const char *pFilePath, uint64_t &o_ByteSize)
+    {
+        uint32_t size = desc.m_ImageSize;
+        std::vector<uint8_t> texels(static_cast<size_t>(size) * size * 4);
+        Random random(desc.m_Seed + imageIndex * 7919u);
+
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                // Smooth gradients with some noise, closer to real albedo than pure noise
+                uint8_t *pTexel = &texels[(static_cast<size_t>(y) * size + x) * 4];
+                uint32_t noise = random.Next() & 0x1F;
+
+                pTexel[0] = static_cast<uint8_t>((x * 255 / size + noise) & 0xFF);
+                pTexel[1] = static_cast<uint8_t>((y * 255 / size + noise) & 0xFF);
+                pTexel[2] = static_cast<uint8_t>(((x ^ y) + imageIndex * 37) & 0xFF);
+                pTexel[3] = 255;
+            }
+        }
+
+        return WritePng(pFilePath, texels.data(), size, size, o_ByteSize);
+    }
+
+    struct AccessorDesc
+    {
+        uint32_t        m_BufferIndex;
+        uint64_t        m_ByteOffset;
+        uint64_t        m_ByteSize;
+        uint32_t        m_Count;
+        int             m_ComponentType;
+        const char*     m_pType;
+        int             m_Target;
+        bool            m_HasBounds;
+        float           m_Min[3];
+        float           m_Max[3];
+    };
+
+    template<typename T>
+    bool WriteStream(FILE *pFile, const std::vector<T> &data, uint64_t &io_ByteOffset, uint64_t &o_ByteSize)
+    {
+        o_ByteSize = data.size() * sizeof(T);
+        bool success = fwrite(data.data(), sizeof(T), data.size(), pFile) == data.size();
+        io_ByteOffset += o_ByteSize;
+        return success;
+    }
+
+    bool GenerateMeshBuffer(
+        const SceneDesc &desc, uint32_t meshIndex, const char *pFilePath, uint32_t gridSize,
+        std::vector<AccessorDesc> &o_Accessors, uint64_t &o_ByteSize)
+    {
+        FILE *pFile = nullptr;
+        if (fopen_s(&pFile, pFilePath, "wb") != 0 || !pFile)
+        {
+            return false;
+        }
+
+        Random random(desc.m_Seed * 31u + meshIndex);
+        uint32_t vertexCount = gridSize * gridSize;
+        uint32_t quadCount = (gridSize - 1) * (gridSize - 1);
+
+        std::vector<float> positions(vertexCount * 3);
+        std::vector<float> normals(vertexCount * 3);
+        std::vector<float> texCoords(vertexCount * 2);
+        std::vector<uint32_t> indices(quadCount * 6);
+
+        uint64_t byteOffset = 0;
+        bool success = true;
+
+        for (uint32_t primIndex = 0; primIndex < desc.m_PrimitivesPerMesh && success; ++primIndex)
+        {
+            float originX = static_cast<float>(primIndex);
+            float minY = 0.0f;
+            float maxY = 0.0f;
+
+            for (uint32_t y = 0; y < gridSize; ++y)
+            {
+                for (uint32_t x = 0; x < gridSize; ++x)
+                {
+                    uint32_t v = y * gridSize + x;
+                    float u = x / static_cast<float>(gridSize - 1);
+                    float w = y / static_cast<float>(gridSize - 1);
+                    float height = 0.05f * std::sin(u * 12.0f) * std::cos(w * 9.0f);
+
+                    positions[v * 3 + 0] = originX + u;
+                    positions[v * 3 + 1] = height;
+                    positions[v * 3 + 2] = w;
+
+                    normals[v * 3 + 0] = 0.0f;
+                    normals[v * 3 + 1] = 1.0f;
+                    normals[v * 3 + 2] = 0.0f;
+
+                    texCoords[v * 2 + 0] = u;
+                    texCoords[v * 2 + 1] = w;
+
+                    minY = height < minY ? height : minY;
+                    maxY = height > maxY ? height : maxY;
+                }
+            }
+
+            // Quads are emitted in a shuffled order, like poorly ordered DCC exports
+            std::vector<uint32_t> quadOrder(quadCount);
+            for (uint32_t q = 0; q < quadCount; ++q)
+            {
+                quadOrder[q] = q;
+            }
+
+            for (uint32_t q = quadCount; q > 1; --q)
+            {
+                uint32_t swapIndex = random.Next() % q;
+                uint32_t tmp = quadOrder[q - 1];
+                quadOrder[q - 1] = quadOrder[swapIndex];
+                quadOrder[swapIndex] = tmp;
+            }
+
+            for (uint32_t q = 0; q < quadCount; ++q)
+            {
+                uint32_t x = quadOrder[q] % (gridSize - 1);
+                uint32_t y = quadOrder[q] / (gridSize - 1);
+                uint32_t v0 = y * gridSize + x;
+                uint32_t v1 = v0 + 1;
+                uint32_t v2 = v0 + gridSize;
+                uint32_t v3 = v2 + 1;
+
+                uint32_t *pQuad = &indices[q * 6];
+                pQuad[0] = v0; pQuad[1] = v2; pQuad[2] = v1;
+                pQuad[3] = v1; pQuad[4] = v2; pQuad[5] = v3;
+            }
+
+            uint32_t bufferIndex = meshIndex;
+            AccessorDesc position = { bufferIndex, byteOffset, 0, vertexCount, s_glTFFloatCode, "VEC3", s_glTFArrayBufferTarget, true,
+                { originX, minY, 0.0f }, { originX + 1.0f, maxY, 1.0f } };
+            success = success && WriteStream(pFile, positions, byteOffset, position.m_ByteSize);
+
+            AccessorDesc normal = { bufferIndex, byteOffset, 0, vertexCount, s_glTFFloatCode, "VEC3", s_glTFArrayBufferTarget, false, {}, {} };
+            success = success && WriteStream(pFile, normals, byteOffset, normal.m_ByteSize);
+
+            AccessorDesc texCoord = { bufferIndex, byteOffset, 0, vertexCount, s_glTFFloatCode, "VEC2", s_glTFArrayBufferTarget, false, {}, {} };
+            success = success && WriteStream(pFile, texCoords, byteOffset, texCoord.m_ByteSize);
+
+            AccessorDesc index = { bufferIndex, byteOffset, 0, quadCount * 6, s_glTFUnsignedIntCode, "SCALAR", s_glTFElementArrayBufferTarget, false, {}, {} };
+            success = success && WriteStream(pFile, indices, byteOffset, index.m_ByteSize);
+
+            o_Accessors.push_back(position);
+            o_Accessors.push_back(normal);
+            o_Accessors.push_back(texCoord);
+            o_Accessors.push_back(index);
+        }
+
+        fclose(pFile);
+        o_ByteSize = byteOffset;
+
+        return success;
+    }
+
+    void WriteGLTF(
+        Writer<FileWriteStream> &writer, const SceneDesc &desc, const std::vector<AccessorDesc> &accessors,
+        const std::vector<uint64_t> &bufferByteSizes)
+    {
+        char name[s_MaxPathLen];
+        uint32_t materialCount = desc.m_ImageCount > 0 ? desc.m_ImageCount : 1;
+
+        writer.StartObject();
+
+        writer.Key("asset");
+        writer.StartObject();
+        writer.Key("version");
+        writer.String("2.0");
+        writer.Key("generator");
+        writer.String("asset_assembler_bench");
+        writer.EndObject();
+
+        writer.Key("images");
+        writer.StartArray();
+        for (uint32_t i = 0; i < desc.m_ImageCount; ++i)
+        {
+            snprintf(name, sizeof(name), "image_%u.png", i);
+            writer.StartObject();
+            writer.Key("uri");
+            writer.String(name);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.Key("textures");
+        writer.StartArray();
+        for (uint32_t i = 0; i < desc.m_ImageCount; ++i)
+        {
+            writer.StartObject();
+            writer.Key("source");
+            writer.Uint(i);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.Key("materials");
+        writer.StartArray();
+        for (uint32_t i = 0; i < materialCount; ++i)
+        {
+            writer.StartObject();
+            writer.Key("pbrMetallicRoughness");
+            writer.StartObject();
+            if (desc.m_ImageCount > 0)
+            {
+                writer.Key("baseColorTexture");
+                writer.StartObject();
+                writer.Key("index");
+                writer.Uint(i);
+                writer.EndObject();
+            }
+            writer.EndObject();
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.Key("buffers");
+        writer.StartArray();
+        for (uint32_t i = 0; i < bufferByteSizes.size(); ++i)
+        {
+            snprintf(name, sizeof(name), "buffer_%u.bin", i);
+            writer.StartObject();
+            writer.Key("uri");
+            writer.String(name);
+            writer.Key("byteLength");
+            writer.Uint64(bufferByteSizes[i]);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        // One buffer view per accessor keeps the layout trivial
+        writer.Key("bufferViews");
+        writer.StartArray();
+        for (const AccessorDesc &accessor : accessors)
+        {
+            writer.StartObject();
+            writer.Key("buffer");
+            writer.Uint(accessor.m_BufferIndex);
+            writer.Key("byteOffset");
+            writer.Uint64(accessor.m_ByteOffset);
+            writer.Key("byteLength");
+            writer.Uint64(accessor.m_ByteSize);
+            writer.Key("target");
+            writer.Int(accessor.m_Target);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.Key("accessors");
+        writer.StartArray();
+        for (size_t i = 0; i < accessors.size(); ++i)
+        {
+            const AccessorDesc &accessor = accessors[i];
+
+            writer.StartObject();
+            writer.Key("bufferView");
+            writer.Uint(static_cast<uint32_t>(i));
+            writer.Key("componentType");
+            writer.Int(accessor.m_ComponentType);
+            writer.Key("count");
+            writer.Uint(accessor.m_Count);
+            writer.Key("type");
+            writer.String(accessor.m_pType);
+
+            if (accessor.m_HasBounds)
+            {
+                writer.Key("min");
+                writer.StartArray();
+                for (float value : accessor.m_Min) writer.Double(value);
+                writer.EndArray();
+                writer.Key("max");
+                writer.StartArray();
+                for (float value : accessor.m_Max) writer.Double(value);
+                writer.EndArray();
+            }
+
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.Key("meshes");
+        writer.StartArray();
+        uint32_t accessorIndex = 0;
+        uint32_t primitiveIndex = 0;
+        for (uint32_t meshIndex = 0; meshIndex < desc.m_MeshCount; ++meshIndex)
+        {
+            snprintf(name, sizeof(name), "mesh_%u", meshIndex);
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(name);
+            writer.Key("primitives");
+            writer.StartArray();
+            for (uint32_t p = 0; p < desc.m_PrimitivesPerMesh; ++p, ++primitiveIndex, accessorIndex += 4)
+            {
+                writer.StartObject();
+                writer.Key("attributes");
+                writer.StartObject();
+                writer.Key("POSITION");
+                writer.Uint(accessorIndex);
+                writer.Key("NORMAL");
+                writer.Uint(accessorIndex + 1);
+                writer.Key("TEXCOORD_0");
+                writer.Uint(accessorIndex + 2);
+                writer.EndObject();
+                writer.Key("indices");
+                writer.Uint(accessorIndex + 3);
+                writer.Key("material");
+                writer.Uint(primitiveIndex % materialCount);
+                writer.EndObject();
+            }
+            writer.EndArray();
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.EndObject();
+    }
+}
+
+bool asset_assembler_bench::GenerateScene(const SceneDesc &desc, const char *pDirectory, GeneratedScene &o_Scene)
+{
+    char filePath[s_MaxPathLen];
+    o_Scene = {};
+
+    for (uint32_t i = 0; i < desc.m_ImageCount; ++i)
+    {
+        uint64_t byteSize = 0;
+        snprintf(filePath, sizeof(filePath), "%s/image_%u.png", pDirectory, i);
+
+        if (!GenerateImage(desc, i, filePath, byteSize))
+        {
+            return false;
+        }
+
+        o_Scene.m_ImageByteSize += byteSize;
+    }
+
+    uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(desc.m_VerticesPerPrimitive))));
+    gridSize = gridSize < 2 ? 2 : gridSize;
+
+    std::vector<AccessorDesc> accessors;
+    std::vector<uint64_t> bufferByteSizes(desc.m_MeshCount);
+
+    for (uint32_t i = 0; i < desc.m_MeshCount; ++i)
+    {
+        snprintf(filePath, sizeof(filePath), "%s/buffer_%u.bin", pDirectory, i);
+
+        if (!GenerateMeshBuffer(desc, i, filePath, gridSize, accessors, bufferByteSizes[i]))
+        {
+            return false;
+        }
+
+        o_Scene.m_BufferByteSize += bufferByteSizes[i];
+    }
+
+    snprintf(filePath, sizeof(filePath), "%s/scene.gltf", pDirectory);
+
+    FILE *pFile = nullptr;
+    if (fopen_s(&pFile, filePath, "wb") != 0 || !pFile)
+    {
+        return false;
+    }
+
+    char writeBuffer[64 * 1024];
+    FileWriteStream stream(pFile, writeBuffer, sizeof(writeBuffer));
+    Writer<FileWriteStream> writer(stream);
+
+    WriteGLTF(writer, desc, accessors, bufferByteSizes);
+
+    stream.Flush();
+    bool success = ferror(pFile) == 0;
+    fclose(pFile);
+
+    o_Scene.m_AccessorCount = static_cast<uint32_t>(accessors.size());
+    o_Scene.m_PrimitiveCount = desc.m_MeshCount * desc.m_PrimitivesPerMesh;
+    o_Scene.m_VertexCount = o_Scene.m_PrimitiveCount * gridSize * gridSize;
+    o_Scene.m_TriangleCount = o_Scene.m_PrimitiveCount * (gridSize - 1) * (gridSize - 1) * 2;
+
+    return success;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+namespace asset_assembler_bench
+{
+    // Size of a synthetic glTF scene. Every primitive is a randomly triangulated grid with
+    // POSITION, NORMAL and TEXCOORD_0 float streams and 32-bit indices.
+    struct SceneDesc
+    {
+        uint32_t    m_ImageCount { 16 };
+        uint32_t    m_ImageSize { 1024 };               // Width and height of every image, in texels
+        uint32_t    m_MeshCount { 64 };
+        uint32_t    m_PrimitivesPerMesh { 4 };
+        uint32_t    m_VerticesPerPrimitive { 16384 };   // Rounded up to the next square grid
+        uint32_t    m_Seed { 1 };
+    };
+
+    struct GeneratedScene
+    {
+        uint64_t    m_ImageByteSize { 0 };
+        uint64_t    m_BufferByteSize { 0 };
+        uint32_t    m_AccessorCount { 0 };
+        uint32_t    m_PrimitiveCount { 0 };
+        uint32_t    m_VertexCount { 0 };
+        uint32_t    m_TriangleCount { 0 };
+    };
+
+    // Writes scene.gltf along with its PNG images and .bin buffers into pDirectory (which must exist).
+    // The output only depends on desc, so two runs with the same description produce identical files.
+    bool GenerateScene(const SceneDesc &desc, const char *pDirectory, GeneratedScene &o_Scene);
+}
@@ -0,0 +1,306 @@
+#include "SceneGenerator.h"
+#include "asset_assembler/database/AssetDatabaseBuilder.h"
+#include "asset_assembler/rapidjson/filewritestream.h"
+#include "asset_assembler/rapidjson/prettywriter.h"
+#include "Salvation_Common/Memory/ThreadHeapAllocator.h"
+#include "Salvation_Common/Core/Defines.h"
+#include "Salvation_Common/FileSystem/FileSystem.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace asset_assembler::database;
+using namespace asset_assembler_bench;
+using namespace salvation::memory;
+using namespace salvation;
+
+// Bump whenever the output layout changes so results from different versions are never diffed blindly
+static constexpr int s_ResultSchemaVersion = 1;
+
+struct BenchOptions
+{
+    SceneDesc       m_Scene {};
+    BuildSettings   m_Settings {};
+    uint32_t        m_IterationCount { 3 };
+    const char*     m_pWorkDirectory { "bench_scene" };
+    const char*     m_pOutputPath { nullptr };
+};
+
+static void PrintUsage()
+{
+    printf_s(
+        "Usage: asset_assembler_bench [options]\n"
+        "  --images <count>        Number of images (default: 16)\n"
+        "  --image-size <texels>   Width and height of each image (default: 1024)\n"
+        "  --meshes <count>        Number of meshes (default: 64)\n"
+        "  --primitives <count>    Primitives per mesh (default: 4)\n"
+        "  --vertices <count>      Vertices per primitive (default: 16384)\n"
+        "  --seed <value>          Scene generation seed (default: 1)\n"
+        "  --iterations <count>    Number of builds, the fastest of each stage is reported (default: 3)\n"
+        "  --threads <count>       Worker threads (default: all cores)\n"
+        "  --work-dir <path>       Directory receiving the scene and the database (default: bench_scene)\n"
+        "  --output <file.json>    Write results to a file instead of stdout\n");
+}
+
+static bool ParseUInt(const char *pStr, uint32_t &o_Value)
+{
+    char *pEnd = nullptr;
+    unsigned long value = strtoul(pStr, &pEnd, 10);
+
+    if (pEnd == pStr || *pEnd != 0)
+    {
+        return false;
+    }
+
+    o_Value = static_cast<uint32_t>(value);
+    return true;
+}
+
+static bool ParseOptions(int argc, char **argv, BenchOptions &o_Options)
+{
+    struct UIntOption
+    {
+        const char*     m_pName;
+        uint32_t*       m_pValue;
+    };
+
+    const UIntOption uintOptions[] =
+    {
+        { "--images", &o_Options.m_Scene.m_ImageCount },
+        { "--image-size", &o_Options.m_Scene.m_ImageSize },
+        { "--meshes", &o_Options.m_Scene.m_MeshCount },
+        { "--primitives", &o_Options.m_Scene.m_PrimitivesPerMesh },
+        { "--vertices", &o_Options.m_Scene.m_VerticesPerPrimitive },
+        { "--seed", &o_Options.m_Scene.m_Seed },
+        { "--iterations", &o_Options.m_IterationCount },
+        { "--threads", &o_Options.m_Settings.m_WorkerThreadCount },
+    };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *pArg = argv[i];
+        if (i + 1 >= argc)
+        {
+            return false;
+        }
+
+        const char *pValue = argv[++i];
+        bool parsed = false;
+
+        for (const UIntOption &option : uintOptions)
+        {
+            if (strcmp(pArg, option.m_pName) == 0)
+            {
+                parsed = ParseUInt(pValue, *option.m_pValue);
+                break;
+            }
+        }
+
+        if (strcmp(pArg, "--work-dir") == 0)
+        {
+            o_Options.m_pWorkDirectory = pValue;
+            parsed = true;
+        }
+        else if (strcmp(pArg, "--output") == 0)
+        {
+            o_Options.m_pOutputPath = pValue;
+            parsed = true;
+        }
+
+        if (!parsed)
+        {
+            return false;
+        }
+    }
+
+    return o_Options.m_IterationCount > 0 && o_Options.m_Scene.m_ImageSize > 0;
+}
+
+static double Throughput(double amount, double seconds)
+{
+    return seconds > 0.0 ? amount / seconds : 0.0;
+}
+
+template<typename TWriter>
+static void WriteResults(TWriter &writer, const BenchOptions &options, const GeneratedScene &scene, const BuildStats &best)
+{
+    static constexpr double s_MiB = 1024.0 * 1024.0;
+
+    writer.StartObject();
+
+    writer.Key("schemaVersion");
+    writer.Int(s_ResultSchemaVersion);
+
+    writer.Key("scene");
+    writer.StartObject();
+    writer.Key("images");
+    writer.Uint(options.m_Scene.m_ImageCount);
+    writer.Key("imageSize");
+    writer.Uint(options.m_Scene.m_ImageSize);
+    writer.Key("meshes");
+    writer.Uint(options.m_Scene.m_MeshCount);
+    writer.Key("primitivesPerMesh");
+    writer.Uint(options.m_Scene.m_PrimitivesPerMesh);
+    writer.Key("verticesPerPrimitive");
+    writer.Uint(options.m_Scene.m_VerticesPerPrimitive);
+    writer.Key("seed");
+    writer.Uint(options.m_Scene.m_Seed);
+    writer.Key("accessors");
+    writer.Uint(scene.m_AccessorCount);
+    writer.Key("vertices");
+    writer.Uint(scene.m_VertexCount);
+    writer.Key("triangles");
+    writer.Uint(scene.m_TriangleCount);
+    writer.Key("imageBytes");
+    writer.Uint64(scene.m_ImageByteSize);
+    writer.Key("bufferBytes");
+    writer.Uint64(scene.m_BufferByteSize);
+    writer.EndObject();
+
+    writer.Key("iterations");
+    writer.Uint(options.m_IterationCount);
+    writer.Key("threads");
+    writer.Uint(options.m_Settings.m_WorkerThreadCount);
+
+    writer.Key("stages");
+    writer.StartObject();
+
+    writer.Key("parseJson");
+    writer.StartObject();
+    writer.Key("seconds");
+    writer.Double(best.m_ParseJsonSeconds);
+    writer.Key("bytes");
+    writer.Uint64(best.m_JsonByteSize);
+    writer.Key("mibPerSecond");
+    writer.Double(Throughput(best.m_JsonByteSize / s_MiB, best.m_ParseJsonSeconds));
+    writer.EndObject();
+
+    writer.Key("buildTextures");
+    writer.StartObject();
+    writer.Key("seconds");
+    writer.Double(best.m_BuildTexturesSeconds);
+    writer.Key("textures");
+    writer.Uint(best.m_TextureCount);
+    writer.Key("texelBytes");
+    writer.Uint64(best.m_TextureTexelByteSize);
+    writer.Key("outputBytes");
+    writer.Uint64(best.m_TextureByteSize);
+    writer.Key("texelMibPerSecond");
+    writer.Double(Throughput(best.m_TextureTexelByteSize / s_MiB, best.m_BuildTexturesSeconds));
+    writer.EndObject();
+
+    writer.Key("buildMeshes");
+    writer.StartObject();
+    writer.Key("seconds");
+    writer.Double(best.m_BuildMeshesSeconds);
+    writer.Key("buffers");
+    writer.Uint(best.m_BufferCount);
+    writer.Key("outputBytes");
+    writer.Uint64(best.m_BufferByteSize);
+    writer.Key("mibPerSecond");
+    writer.Double(Throughput(best.m_BufferByteSize / s_MiB, best.m_BuildMeshesSeconds));
+    writer.EndObject();
+
+    writer.Key("insertMetadata");
+    writer.StartObject();
+    writer.Key("seconds");
+    writer.Double(best.m_InsertMetadataSeconds);
+    writer.Key("rows");
+    writer.Uint64(best.m_MetadataRowCount);
+    writer.Key("rowsPerSecond");
+    writer.Double(Throughput(static_cast<double>(best.m_MetadataRowCount), best.m_InsertMetadataSeconds));
+    writer.EndObject();
+
+    writer.Key("total");
+    writer.StartObject();
+    writer.Key("seconds");
+    writer.Double(best.m_TotalSeconds);
+    writer.EndObject();
+
+    writer.EndObject();
+    writer.EndObject();
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options {};
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    // All heavy memory allocations must go through salvation::memory::VirtualMemoryAllocator.
+    ThreadHeapAllocator::Init(GiB(1), MiB(100));
+
+    const char *pWorkDirectory = options.m_pWorkDirectory;
+    if (!filesystem::DirectoryExists(pWorkDirectory) && !filesystem::CreateDirectory(pWorkDirectory))
+    {
+        fprintf(stderr, "Failed to create work directory %s\n", pWorkDirectory);
+        return 1;
+    }
+
+    GeneratedScene scene {};
+    if (!GenerateScene(options.m_Scene, pWorkDirectory, scene))
+    {
+        fprintf(stderr, "Failed to generate the synthetic scene\n");
+        return 1;
+    }
+
+    char srcPath[1024];
+    char dstPath[1024];
+    snprintf(srcPath, sizeof(srcPath), "%s/scene.gltf", pWorkDirectory);
+    snprintf(dstPath, sizeof(dstPath), "%s/out/AssetsDB.db", pWorkDirectory);
+
+    // Keep the fastest time of each stage independently, which filters out most of the system noise
+    BuildStats best {};
+
+    for (uint32_t i = 0; i < options.m_IterationCount; ++i)
+    {
+        remove(dstPath);
+
+        AssetDatabaseBuilder builder(options.m_Settings);
+        if (!builder.BuildDatabase(srcPath, dstPath))
+        {
+            fprintf(stderr, "Build %u failed\n", i);
+            return 1;
+        }
+
+        const BuildStats &stats = builder.GetStats();
+        if (i == 0)
+        {
+            best = stats;
+        }
+        else
+        {
+            best.m_ParseJsonSeconds = std::min(best.m_ParseJsonSeconds, stats.m_ParseJsonSeconds);
+            best.m_BuildTexturesSeconds = std::min(best.m_BuildTexturesSeconds, stats.m_BuildTexturesSeconds);
+            best.m_BuildMeshesSeconds = std::min(best.m_BuildMeshesSeconds, stats.m_BuildMeshesSeconds);
+            best.m_InsertMetadataSeconds = std::min(best.m_InsertMetadataSeconds, stats.m_InsertMetadataSeconds);
+            best.m_TotalSeconds = std::min(best.m_TotalSeconds, stats.m_TotalSeconds);
+        }
+    }
+
+    FILE *pOutput = stdout;
+    if (options.m_pOutputPath && (fopen_s(&pOutput, options.m_pOutputPath, "wb") != 0 || !pOutput))
+    {
+        fprintf(stderr, "Failed to open %s\n", options.m_pOutputPath);
+        return 1;
+    }
+
+    char writeBuffer[16 * 1024];
+    rapidjson::FileWriteStream stream(pOutput, writeBuffer, sizeof(writeBuffer));
+    rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer(stream);
+
+    WriteResults(writer, options, scene, best);
+    stream.Put('\n');
+    stream.Flush();
+
+    if (pOutput != stdout)
+    {
+        fclose(pOutput);
+    }
+
+    return 0;
+}
@@ -1,28 +1,399 @@
 #include "asset_assembler/database/AssetDatabaseBuilder.h"
+#include "asset_assembler/profiling/Profiler.h"
 #include "Salvation_Common/Memory/ThreadHeapAllocator.h"
 #include "Salvation_Common/Core/Defines.h"
 #include "Salvation_Common/FileSystem/FileSystem.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 
 using namespace asset_assembler::database;
+using namespace asset_assembler::profiling;
+using namespace asset_assembler::textures;
 using namespace salvation::memory;
 using namespace salvation;
 
-int main()
+static void PrintUsage()
 {
+    printf_s(
+        "Usage: asset_assembler_cli <src.gltf|src.glb> <dst.db> [options]\n"
+        "  --threads <count>       Worker threads used to process assets (default: all cores)\n"
+        "  --batch-size <rows>     Rows per SQLite transaction (default: whole build in one transaction)\n"
+        "  --trace <file.json>     Write a Chrome trace_event file of the build\n"
+        "  --texture-cache <dir>   Reuse compressed textures from this cache directory\n"
+        "  --texture-cache-size <MiB>  Maximum texture cache size before eviction (default: 4096)\n"
+        "  --texture-format <slot>=<format>  Format of the images of a material slot (base-color, normal, occlusion,\n"
+        "                          metallic-roughness, emissive or all): auto, bc1, bc3, bc4, bc5 or bc7 (default: auto)\n"
+        "  --keep-duplicate-textures  Compress and pack images with identical content separately\n"
+        "  --alignment <bytes>     Align textures and buffers in the packed files, 4096 for unbuffered reads (default: 1)\n"
+        "  --compress <KiB>        Store the packed files as independently decodable LZ4 chunks of this size, below 4 GiB\n"
+        "                          (64 to 256 recommended)\n"
+        "  --write-queue <buffers> 4 MiB buffers queued to the packed file writer threads, 0 writes synchronously (default: 8)\n"
+        "  --stream-json           Read the glTF into the scene with a streaming reader, without building a JSON document\n"
+        "  --incremental           Only rebuild the images and buffers that changed since the last build of <dst.db>\n"
+        "  --optimize-meshes       Reorder triangles and vertices for the vertex cache, overdraw and vertex fetch\n"
+        "  --quantize-vertices     Store positions, normals, tangents, texture coordinates and colors with smaller encodings\n"
+        "  --octahedral-bits <8|16>  Bits per component of quantized normals and tangents (default: 16)\n"
+        "  --narrow-indices        Rewrite 32 bits index buffers as 16 bits when every index fits, the freed bytes\n"
+        "                          are zero-filled unless buffer data is stripped\n"
+        "  --vertex-layout <source|deinterleaved|interleaved>  Layout of the vertex streams (default: source)\n"
+        "  --strip-unreferenced-buffer-data  Only pack the bytes mesh primitives read, incremental builds then repack\n"
+        "                          every buffer when one changes\n"
+        "  --meshlets              Split primitives into meshlets with bounding spheres and normal cones\n"
+        "  --meshlet-max-vertices <count>   Vertices per meshlet, up to 256 (default: 64)\n"
+        "  --meshlet-max-triangles <count>  Triangles per meshlet, up to 512 (default: 124)\n"
+        "  --lod <ratio> <error>   Add a level of detail keeping this fraction of the triangles, stopping earlier once a\n"
+        "                          collapse's RMS plane distance exceeds this fraction of the mesh extent. Repeat for up to 8 levels.\n");
+}
+
+static bool ParseUInt(const char *pStr, uint32_t &o_Value)
+{
+    char *pEnd = nullptr;
+    unsigned long value = strtoul(pStr, &pEnd, 10);
+
+    if (pEnd == pStr || *pEnd != 0)
+    {
+        return false;
+    }
+
+    o_Value = static_cast<uint32_t>(value);
+    return true;
+}
+
+static bool ParseFloat(const char *pStr, float &o_Value)
+{
+    char *pEnd = nullptr;
+    float value = strtof(pStr, &pEnd);
+
+    if (pEnd == pStr || *pEnd != 0)
+    {
+        return false;
+    }
+
+    o_Value = value;
+    return true;
+}
+
+static bool ParseVertexLayout(const char *pStr, VertexLayout &o_Layout)
+{
+    static constexpr const char *s_pLayoutNames[] = { "source", "deinterleaved", "interleaved" };
+    static constexpr VertexLayout s_Layouts[] = { VertexLayout::Source, VertexLayout::Deinterleaved, VertexLayout::Interleaved };
+
+    for (size_t i = 0; i < ARRAY_SIZE(s_pLayoutNames); ++i)
+    {
+        if (strcmp(pStr, s_pLayoutNames[i]) == 0)
+        {
+            o_Layout = s_Layouts[i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// <slot>=<format>, "all" sets every slot
+static bool ParseTextureFormat(const char *pStr, BuildSettings &io_Settings)
+{
+    static constexpr const char *s_pUsageNames[] = { "base-color", "normal", "occlusion", "metallic-roughness", "emissive" };
+    static constexpr const char *s_pFormatNames[] = { "auto", "bc1", "bc3", "bc4", "bc5", "bc7" };
+    static constexpr BlockFormat s_Formats[] =
+    {
+        BlockFormat::Auto, BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC4, BlockFormat::BC5, BlockFormat::BC7
+    };
+
+    const char *pSeparator = strchr(pStr, '=');
+    if (!pSeparator)
+    {
+        return false;
+    }
+
+    size_t usageLength = static_cast<size_t>(pSeparator - pStr);
+    bool allUsages = usageLength == 3 && strncmp(pStr, "all", usageLength) == 0;
+    int32_t usageIndex = -1;
+
+    for (size_t i = 0; i < ARRAY_SIZE(s_pUsageNames); ++i)
+    {
+        if (strlen(s_pUsageNames[i]) == usageLength && strncmp(pStr, s_pUsageNames[i], usageLength) == 0)
+        {
+            usageIndex = static_cast<int32_t>(i);
+        }
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(s_pFormatNames) && (allUsages || usageIndex >= 0); ++i)
+    {
+        if (strcmp(pSeparator + 1, s_pFormatNames[i]) == 0)
+        {
+            for (uint32_t usage = 0; usage < static_cast<uint32_t>(TextureUsage::Count); ++usage)
+            {
+                if (allUsages || usage == static_cast<uint32_t>(usageIndex))
+                {
+                    io_Settings.m_TextureFormats[usage] = s_Formats[i];
+                }
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    const char *pSrcPath = nullptr;
+    const char *pDstPath = nullptr;
+    const char *pTracePath = nullptr;
+    BuildSettings settings {};
+    uint32_t textureCacheMiB = 0;
+    uint32_t compressionChunkKiB = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *pArg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (strcmp(pArg, "--threads") == 0 && hasValue && ParseUInt(argv[i + 1], settings.m_WorkerThreadCount))
+        {
+            ++i;
+        }
+        else if (strcmp(pArg, "--batch-size") == 0 && hasValue && ParseUInt(argv[i + 1], settings.m_TransactionBatchSize))
+        {
+            ++i;
+        }
+        else if (strcmp(pArg, "--trace") == 0 && hasValue)
+        {
+            pTracePath = argv[++i];
+        }
+        else if (strcmp(pArg, "--texture-cache") == 0 && hasValue)
+        {
+            settings.m_pTextureCacheDirectory = argv[++i];
+        }
+        else if (strcmp(pArg, "--texture-cache-size") == 0 && hasValue && ParseUInt(argv[i + 1], textureCacheMiB))
+        {
+            settings.m_TextureCacheMaxByteSize = static_cast<uint64_t>(textureCacheMiB) * 1024 * 1024;
+            ++i;
+        }
+        else if (strcmp(pArg, "--texture-format") == 0 && hasValue && ParseTextureFormat(argv[i + 1], settings))
+        {
+            ++i;
+        }
+        else if (strcmp(pArg, "--keep-duplicate-textures") == 0)
+        {
+            settings.m_DeduplicateTextures = false;
+        }
+        else if (
+            strcmp(pArg, "--alignment") == 0 && hasValue && ParseUInt(argv[i + 1], settings.m_PackedDataAlignment) &&
+            settings.m_PackedDataAlignment > 0 && (settings.m_PackedDataAlignment & (settings.m_PackedDataAlignment - 1)) == 0)
+        {
+            ++i;
+        }
+        else if (
+            strcmp(pArg, "--compress") == 0 && hasValue && ParseUInt(argv[i + 1], compressionChunkKiB) &&
+            compressionChunkKiB > 0 && compressionChunkKiB <= UINT32_MAX / 1024)
+        {
+            settings.m_CompressionChunkByteSize = compressionChunkKiB * 1024;
+            ++i;
+        }
+        else if (strcmp(pArg, "--write-queue") == 0 && hasValue && ParseUInt(argv[i + 1], settings.m_WriteQueueLength))
+        {
+            ++i;
+        }
+        else if (strcmp(pArg, "--stream-json") == 0)
+        {
+            settings.m_StreamJson = true;
+        }
+        else if (strcmp(pArg, "--incremental") == 0)
+        {
+            settings.m_Incremental = true;
+        }
+        else if (strcmp(pArg, "--optimize-meshes") == 0)
+        {
+            settings.m_OptimizeMeshes = true;
+        }
+        else if (strcmp(pArg, "--quantize-vertices") == 0)
+        {
+            settings.m_QuantizeVertices = true;
+        }
+        else if (strcmp(pArg, "--meshlets") == 0)
+        {
+            settings.m_BuildMeshlets = true;
+        }
+        else if (strcmp(pArg, "--meshlet-max-vertices") == 0 && hasValue && ParseUInt(argv[i + 1], settings.m_MeshletMaxVertexCount))
+        {
+            ++i;
+        }
+        else if (strcmp(pArg, "--meshlet-max-triangles") == 0 && hasValue && ParseUInt(argv[i + 1], settings.m_MeshletMaxTriangleCount))
+        {
+            ++i;
+        }
+        else if (
+            strcmp(pArg, "--lod") == 0 && i + 2 < argc && settings.m_LodLevelCount < s_MaxLodLevelCount &&
+            ParseFloat(argv[i + 1], settings.m_LodLevels[settings.m_LodLevelCount].m_TriangleRatio) &&
+            ParseFloat(argv[i + 2], settings.m_LodLevels[settings.m_LodLevelCount].m_MaxError))
+        {
+            settings.m_LodLevelCount++;
+            i += 2;
+        }
+        else if (strcmp(pArg, "--narrow-indices") == 0)
+        {
+            settings.m_NarrowIndices = true;
+        }
+        else if (strcmp(pArg, "--vertex-layout") == 0 && hasValue && ParseVertexLayout(argv[i + 1], settings.m_VertexLayout))
+        {
+            ++i;
+        }
+        else if (strcmp(pArg, "--strip-unreferenced-buffer-data") == 0)
+        {
+            settings.m_StripUnreferencedBufferData = true;
+        }
+        else if (
+            strcmp(pArg, "--octahedral-bits") == 0 && hasValue && ParseUInt(argv[i + 1], settings.m_OctahedralBits) &&
+            (settings.m_OctahedralBits == 8 || settings.m_OctahedralBits == 16))
+        {
+            ++i;
+        }
+        else if (pArg[0] != '-' && !pSrcPath)
+        {
+            pSrcPath = pArg;
+        }
+        else if (pArg[0] != '-' && !pDstPath)
+        {
+            pDstPath = pArg;
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (!pSrcPath || !pDstPath)
+    {
+        PrintUsage();
+        return 1;
+    }
+
     // All heavy memory allocations must go through salvation::memory::VirtualMemoryAllocator.
     ThreadHeapAllocator::Init(GiB(1), MiB(100));
-    AssetDatabaseBuilder builder;
-    bool success = builder.BuildDatabase("D:/Temp/bulbasaur/scene.gltf", "D:/Temp/Assets/AssetsDB.db");
+    Profiler::SetEnabled(pTracePath != nullptr);
+
+    AssetDatabaseBuilder builder(settings);
+    bool success = builder.BuildDatabase(pSrcPath, pDstPath);
 
     if (success)
     {
-        printf_s("Asset generation successful");
+        printf_s("Asset generation successful\n");
     }
     else
     {
-        printf_s("Asset generation FAILED!");
+        printf_s("Asset generation FAILED!\n");
     }
 
-    return 0;
-}
+    const BuildStats &stats = builder.GetStats();
 
+    if (stats.m_EmbeddedImageCount > 0)
+    {
+        printf_s("  %u images are embedded in a bufferView, only images stored in their own file are supported\n", stats.m_EmbeddedImageCount);
+    }
+
+    if (settings.m_StreamJson)
+    {
+        printf_s("  Parse JSON:      %8.3f s, streamed into the scene\n", stats.m_ParseJsonSeconds);
+    }
+    else
+    {
+        printf_s("  Parse JSON:      %8.3f s, %.2f MiB document, %.2f MiB peak\n", stats.m_ParseJsonSeconds,
+            stats.m_JsonDomByteSize / (1024.0 * 1024.0), stats.m_JsonPeakByteSize / (1024.0 * 1024.0));
+    }
+    printf_s("  Build textures:  %8.3f s\n", stats.m_BuildTexturesSeconds);
+    printf_s("  Build meshes:    %8.3f s\n", stats.m_BuildMeshesSeconds);
+    printf_s("  Write stalls:    %8.3f s\n", stats.m_WriteStallSeconds);
+    printf_s("  Insert metadata: %8.3f s\n", stats.m_InsertMetadataSeconds);
+    printf_s("  Total:           %8.3f s\n", stats.m_TotalSeconds);
+
+    if (settings.m_pTextureCacheDirectory)
+    {
+        printf_s("  Texture cache:   %u hits, %u misses, %u evicted\n",
+            stats.m_TextureCacheHitCount, stats.m_TextureCacheMissCount, stats.m_TextureCacheEvictedCount);
+    }
+
+    if (stats.m_DuplicateTextureCount > 0)
+    {
+        printf_s("  Deduplication:   %u textures, %.2f MiB and %.3f s of compression saved\n",
+            stats.m_DuplicateTextureCount, stats.m_DuplicateTextureByteSize / (1024.0 * 1024.0), stats.m_DuplicateTextureSeconds);
+    }
+
+    if (settings.m_OptimizeMeshes && stats.m_OptimizedTriangleCount > 0)
+    {
+        double triangleCount = static_cast<double>(stats.m_OptimizedTriangleCount);
+        double vertexCount = static_cast<double>(stats.m_OptimizedVertexCount);
+
+        printf_s("  Mesh optimization: %u primitives, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+            stats.m_OptimizedPrimitiveCount,
+            stats.m_VertexCacheMissCountBefore / triangleCount, stats.m_VertexCacheMissCountAfter / triangleCount,
+            stats.m_VertexCacheMissCountBefore / vertexCount, stats.m_VertexCacheMissCountAfter / vertexCount);
+    }
+
+    if (settings.m_QuantizeVertices && stats.m_QuantizedStreamCount > 0)
+    {
+        printf_s("  Quantization:    %u streams, %.2f MiB -> %.2f MiB\n",
+            stats.m_QuantizedStreamCount,
+            stats.m_QuantizedByteSizeBefore / (1024.0 * 1024.0), stats.m_QuantizedByteSizeAfter / (1024.0 * 1024.0));
+    }
+
+    if (stats.m_DeinterleavedStreamCount > 0 || stats.m_InterleavedPrimitiveCount > 0)
+    {
+        printf_s("  Vertex layout:   %u streams deinterleaved, %u primitives interleaved\n",
+            stats.m_DeinterleavedStreamCount, stats.m_InterleavedPrimitiveCount);
+    }
+
+    if (stats.m_AlignmentPaddingByteSize > 0)
+    {
+        printf_s("  Alignment:       %.2f MiB of padding for %u bytes boundaries\n",
+            stats.m_AlignmentPaddingByteSize / (1024.0 * 1024.0), settings.m_PackedDataAlignment);
+    }
+
+    if (stats.m_ChunkCount > 0)
+    {
+        printf_s("  Compression:     %u chunks, %.2f MiB -> %.2f MiB\n",
+            stats.m_ChunkCount, stats.m_ChunkByteSize / (1024.0 * 1024.0), stats.m_ChunkFileByteSize / (1024.0 * 1024.0));
+    }
+
+    if (stats.m_StrippedBufferByteSize > 0)
+    {
+        printf_s("  Buffer stripping: %.2f MiB of unreferenced data left out\n", stats.m_StrippedBufferByteSize / (1024.0 * 1024.0));
+    }
+
+    if (stats.m_NarrowedIndexBufferCount > 0)
+    {
+        // Without stripping the narrowed streams keep their place and the freed half is zero-filled
+        printf_s(settings.m_StripUnreferencedBufferData ?
+            "  Index narrowing: %u index buffers, %.2f MiB saved\n" :
+            "  Index narrowing: %u index buffers, %.2f MiB zero-filled in place\n",
+            stats.m_NarrowedIndexBufferCount, stats.m_NarrowedIndexCount * sizeof(uint16_t) / (1024.0 * 1024.0));
+    }
+
+    if (settings.m_BuildMeshlets && stats.m_MeshletPrimitiveCount > 0)
+    {
+        printf_s("  Meshlets:        %u meshlets for %u primitives\n", stats.m_MeshletCount, stats.m_MeshletPrimitiveCount);
+    }
+
+    if (stats.m_LodPrimitiveCount > 0)
+    {
+        printf_s("  LODs:            %u levels for %u primitives, %llu triangles\n",
+            stats.m_LodLevelCount, stats.m_LodPrimitiveCount, static_cast<unsigned long long>(stats.m_LodTriangleCount));
+    }
+
+    if (settings.m_Incremental)
+    {
+        printf_s("  Incremental:     %s, %u textures and %u buffers reused\n",
+            stats.m_FullRebuild ? "full rebuild" : "partial rebuild", stats.m_ReusedTextureCount, stats.m_ReusedBufferCount);
+    }
+
+    if (pTracePath && !Profiler::WriteChromeTrace(pTracePath))
+    {
+        printf_s("Failed to write trace file %s\n", pTracePath);
+    }
+
+    return success ? 0 : 1;
+}